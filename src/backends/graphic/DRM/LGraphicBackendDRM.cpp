@@ -112,8 +112,21 @@ struct Backend
     std::vector<LDMAFormat>scanoutFormats;
     std::vector<LGPU*> devices;
     LWeak<LGPU> allocator;
+
+    /* SRM owns the GL textures and EGL images of each device, buffers destroyed while
+     * a frame snapshot is being replayed are kept here, see destroyPendingBuffers() */
+    std::vector<SRMBuffer*> buffersPendingDestruction;
 };
 
+static void destroyPendingBuffers(Backend *bknd)
+{
+    while (!bknd->buffersPendingDestruction.empty())
+    {
+        srmBufferDestroy(bknd->buffersPendingDestruction.back());
+        bknd->buffersPendingDestruction.pop_back();
+    }
+}
+
 struct Output
 {
     SRMConnector *conn;
@@ -518,6 +531,7 @@ void LGraphicBackend::backendUninitialize()
         }
     }
 
+    destroyPendingBuffers(bknd);
     srmCoreDestroy(bknd->core);
     delete bknd;
 }
@@ -590,6 +604,19 @@ EGLContext LGraphicBackend::backendGetAllocatorEGLContext()
     return srmDeviceGetEGLContext(srmCoreGetAllocatorDevice(bknd->core));
 }
 
+bool LGraphicBackend::backendCreateSharedContext()
+{
+    // SRM keeps a context per thread and binds it when its buffers are accessed
+    Backend *bknd = (Backend*)compositor()->imp()->graphicBackendData;
+    return srmDeviceCreateSharedContextForThread(srmCoreGetAllocatorDevice(bknd->core));
+}
+
+void LGraphicBackend::backendDestroySharedContext()
+{
+    Backend *bknd = (Backend*)compositor()->imp()->graphicBackendData;
+    srmDeviceDestroyThreadSharedContext(srmCoreGetAllocatorDevice(bknd->core), pthread_self());
+}
+
 LGPU *LGraphicBackend::backendGetAllocatorDevice()
 {
     Backend *bknd = (Backend*)compositor()->imp()->graphicBackendData;
@@ -720,12 +747,31 @@ void LGraphicBackend::textureSetFence(LTexture *texture)
 
 void LGraphicBackend::textureDestroy(LTexture *texture)
 {
+    Backend *bknd = (Backend*)compositor()->imp()->graphicBackendData;
     SRMBuffer *buffer = (SRMBuffer*)texture->m_graphicBackendData;
 
+    if (compositor()->imp()->frameSnapshotsInFlight.load() != 0)
+    {
+        if (buffer)
+            bknd->buffersPendingDestruction.push_back(buffer);
+
+        return;
+    }
+
+    destroyPendingBuffers(bknd);
+
     if (buffer)
         srmBufferDestroy(buffer);
 }
 
+void LGraphicBackend::textureDestroyPending()
+{
+    if (compositor()->imp()->frameSnapshotsInFlight.load() != 0)
+        return;
+
+    destroyPendingBuffers((Backend*)compositor()->imp()->graphicBackendData);
+}
+
 /* OUTPUT */
 
 bool LGraphicBackend::outputInitialize(LOutput *output)
@@ -1149,6 +1195,8 @@ extern "C" LGraphicBackendInterface *getAPI()
     API.backendGetScanoutDMAFormats     = &LGraphicBackend::backendGetScanoutDMAFormats;
     API.backendGetAllocatorEGLDisplay   = &LGraphicBackend::backendGetAllocatorEGLDisplay;
     API.backendGetAllocatorEGLContext   = &LGraphicBackend::backendGetAllocatorEGLContext;
+    API.backendCreateSharedContext      = &LGraphicBackend::backendCreateSharedContext;
+    API.backendDestroySharedContext     = &LGraphicBackend::backendDestroySharedContext;
     API.backendGetAllocatorDevice       = &LGraphicBackend::backendGetAllocatorDevice;
 
     /* TEXTURES */
@@ -1164,6 +1212,7 @@ extern "C" LGraphicBackendInterface *getAPI()
     API.textureGetTarget                = &LGraphicBackend::textureGetTarget;
     API.textureSetFence                 = &LGraphicBackend::textureSetFence;
     API.textureDestroy                  = &LGraphicBackend::textureDestroy;
+    API.textureDestroyPending           = &LGraphicBackend::textureDestroyPending;
 
     /* OUTPUT */
     API.outputInitialize                = &LGraphicBackend::outputInitialize;
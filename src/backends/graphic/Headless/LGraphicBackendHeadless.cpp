@@ -0,0 +1,1308 @@
+#include <private/LCompositorPrivate.h>
+#include <private/LOutputPrivate.h>
+#include <private/LFactory.h>
+
+#include <LGraphicBackend.h>
+#include <LOutputMode.h>
+#include <LGPU.h>
+#include <LTime.h>
+#include <LLog.h>
+
+#include <SRMFormat.h>
+#include <SRMEGL.h>
+
+#include <EGL/eglext.h>
+#include <sys/eventfd.h>
+#include <sys/poll.h>
+#include <drm_fourcc.h>
+#include <cstring>
+#include <sstream>
+#include <fcntl.h>
+#include <atomic>
+#include <thread>
+
+using namespace Louvre;
+
+#define BKND_NAME "HEADLESS BACKEND"
+#define LOUVRE_HEADLESS_BACKEND_MAX_BUFFERS 3
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+/*
+ * Graphic backend without displays nor a parent compositor.
+ *
+ * Each virtual output renders into its own set of offscreen GL framebuffers from a dedicated
+ * thread, and page flips are simulated with a vblank clock derived from the output refresh rate.
+ * It's meant for running Louvre on CI machines and benchmarking it using software rasterizers such
+ * as llvmpipe or softpipe.
+ *
+ * Outputs are configured with the LOUVRE_HEADLESS_OUTPUTS env, a comma-separated list of
+ * WIDTHxHEIGHT[@REFRESH_HZ][:SCALE] entries, e.g. "1920x1080@60,3840x2160@144:2".
+ */
+
+struct Texture
+{
+    GLuint id;
+    GLenum target;
+};
+
+struct CPUTexture
+{
+    Texture texture;
+    UInt32 pixelSize;
+    const SRMGLFormat *glFmt;
+    bool destroy;
+};
+
+struct DRMTexture
+{
+    Texture texture;
+    EGLImage image;
+};
+
+struct OutputBuffer
+{
+    CPUTexture texture;
+    GLuint framebuffer { 0 };
+
+    // Value of Output::frame when the buffer was last rendered, 0 if never
+    UInt64 renderedFrame { 0 };
+    LTexture *wrapper { nullptr };
+};
+
+struct Output
+{
+    UInt32 id;
+    std::string name;
+    std::string description;
+    LSize physicalSize;
+    Float32 scale;
+    std::vector<LOutputMode*> modes;
+
+    std::thread renderThread;
+    EGLContext eglContext { EGL_NO_CONTEXT };
+    Int32 eventFd { -1 };
+    std::atomic<bool> running { false };
+    std::atomic<bool> repaint { false };
+    std::atomic<Int8> initialized { 0 };
+
+    OutputBuffer buffers[LOUVRE_HEADLESS_BACKEND_MAX_BUFFERS];
+    UInt32 buffersCount { 2 };
+    UInt32 currentBuffer { 0 };
+    UInt64 frame { 0 };
+
+    // Simulated vblank clock
+    Int64 vblankBaseNs { 0 };
+    UInt64 vblankSeq { 0 };
+    Int64 lastFrameUsec { 0 };
+    std::atomic<bool> vSync { true };
+    std::atomic<Int32> refreshRateLimit { 0 };
+    LContentType contentType { LContentTypeNone };
+};
+
+struct Backend
+{
+    EGLDisplay eglDisplay { EGL_NO_DISPLAY };
+    EGLContext eglContext { EGL_NO_CONTEXT };
+    EGLConfig eglConfig { EGL_NO_CONFIG_KHR };
+    std::vector<LOutput*> connectedOutputs;
+    std::vector<LDMAFormat> dmaFormats;
+    std::vector<LGPU*> devices;
+    LGPU allocator;
+};
+
+static const EGLint eglContextAttribs[]
+{
+    EGL_CONTEXT_CLIENT_VERSION, 2,
+    EGL_NONE
+};
+
+static const EGLint eglConfigAttribs[]
+{
+    EGL_SURFACE_TYPE, 0,
+    EGL_RED_SIZE, 8,
+    EGL_GREEN_SIZE, 8,
+    EGL_BLUE_SIZE, 8,
+    EGL_ALPHA_SIZE, 0,
+    EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+    EGL_NONE
+};
+
+static Backend *backend() noexcept
+{
+    return static_cast<Backend*>(compositor()->imp()->graphicBackendData);
+}
+
+static Output *backendOutput(LOutput *output) noexcept
+{
+    return static_cast<Output*>(output->imp()->graphicBackendData);
+}
+
+static Int64 monotonicNs() noexcept
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return Int64(ts.tv_sec) * 1000000000 + Int64(ts.tv_nsec);
+}
+
+static bool initEGL(Backend *bknd)
+{
+    EGLint major, minor, n;
+    const char *clientExtensions { eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS) };
+    const char *extensions;
+
+    if (clientExtensions &&
+        srmEGLHasExtension(clientExtensions, "EGL_EXT_platform_base") &&
+        srmEGLHasExtension(clientExtensions, "EGL_MESA_platform_surfaceless"))
+    {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay {
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT") };
+
+        if (getPlatformDisplay)
+            bknd->eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    }
+
+    if (bknd->eglDisplay == EGL_NO_DISPLAY)
+    {
+        LLog::debug("[%s] EGL_MESA_platform_surfaceless not available, using the default EGL display.", BKND_NAME);
+        bknd->eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    if (bknd->eglDisplay == EGL_NO_DISPLAY)
+    {
+        LLog::fatal("[%s] Failed to get EGL display.", BKND_NAME);
+        return false;
+    }
+
+    if (!eglInitialize(bknd->eglDisplay, &major, &minor))
+    {
+        LLog::fatal("[%s] Failed to initialize EGL display.", BKND_NAME);
+        goto errDisplay;
+    }
+
+    extensions = eglQueryString(bknd->eglDisplay, EGL_EXTENSIONS);
+
+    // Both the main thread and the output threads bind their contexts without a surface
+    if (!extensions || !srmEGLHasExtension(extensions, "EGL_KHR_surfaceless_context"))
+    {
+        LLog::fatal("[%s] EGL_KHR_surfaceless_context not supported.", BKND_NAME);
+        goto errTerminate;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_ES_API))
+    {
+        LLog::fatal("[%s] Failed to bind OpenGL ES API.", BKND_NAME);
+        goto errTerminate;
+    }
+
+    if (!eglChooseConfig(bknd->eglDisplay, eglConfigAttribs, &bknd->eglConfig, 1, &n) || n != 1)
+    {
+        LLog::fatal("[%s] Failed to get EGL config.", BKND_NAME);
+        goto errTerminate;
+    }
+
+    bknd->eglContext = eglCreateContext(bknd->eglDisplay, bknd->eglConfig, EGL_NO_CONTEXT, eglContextAttribs);
+
+    if (bknd->eglContext == EGL_NO_CONTEXT)
+    {
+        LLog::fatal("[%s] Failed to create EGL context.", BKND_NAME);
+        goto errTerminate;
+    }
+
+    LLog::debug("[%s] EGL %d.%d - %s.", BKND_NAME, major, minor, eglQueryString(bknd->eglDisplay, EGL_VENDOR));
+    return true;
+
+errTerminate:
+    eglTerminate(bknd->eglDisplay);
+errDisplay:
+    bknd->eglDisplay = EGL_NO_DISPLAY;
+    return false;
+}
+
+static void unitEGL(Backend *bknd)
+{
+    eglMakeCurrent(bknd->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+    if (bknd->eglContext != EGL_NO_CONTEXT)
+    {
+        eglDestroyContext(bknd->eglDisplay, bknd->eglContext);
+        bknd->eglContext = EGL_NO_CONTEXT;
+    }
+
+    if (bknd->eglDisplay != EGL_NO_DISPLAY)
+    {
+        eglTerminate(bknd->eglDisplay);
+        bknd->eglDisplay = EGL_NO_DISPLAY;
+    }
+}
+
+static void createOutput(Backend *bknd, const LSize &sizeB, UInt32 refreshRate, Float32 scale)
+{
+    Output *bkndOutput { new Output() };
+    bkndOutput->id = bknd->connectedOutputs.size() + 1;
+    bkndOutput->name = std::string("HEADLESS-") + std::to_string(bkndOutput->id);
+    bkndOutput->scale = scale;
+
+    // Report a physical size matching ~96 DPI * scale
+    bkndOutput->physicalSize.setW(roundf(Float32(sizeB.w()) * 25.4f / (96.f * scale)));
+    bkndOutput->physicalSize.setH(roundf(Float32(sizeB.h()) * 25.4f / (96.f * scale)));
+
+    const char *buffersEnv { getenv("LOUVRE_HEADLESS_BUFFERS") };
+
+    if (buffersEnv)
+    {
+        const Int32 count { atoi(buffersEnv) };
+
+        if (count >= 1 && count <= LOUVRE_HEADLESS_BACKEND_MAX_BUFFERS)
+            bkndOutput->buffersCount = count;
+        else
+            LLog::warning("[%s] Invalid LOUVRE_HEADLESS_BUFFERS value %d, must be in the range [1, %d].",
+                          BKND_NAME, count, LOUVRE_HEADLESS_BACKEND_MAX_BUFFERS);
+    }
+
+    std::ostringstream desc;
+    desc << "[" << bkndOutput->name << "] Louvre virtual output "
+         << sizeB.w() << "x" << sizeB.h() << " @ " << (Float32(refreshRate) / 1000.f) << " Hz";
+    bkndOutput->description = desc.str();
+
+    LOutput::Params params
+    {
+        .callback = [=](LOutput *output)
+        {
+            bkndOutput->modes.push_back(new LOutputMode(output, sizeB, refreshRate, true, nullptr));
+            output->imp()->updateRect();
+            bknd->connectedOutputs.push_back(output);
+        },
+        .backendData = bkndOutput
+    };
+
+    LFactory::createObject<LOutput>(&params);
+}
+
+static bool parseOutputs(Backend *bknd)
+{
+    const char *env { getenv("LOUVRE_HEADLESS_OUTPUTS") };
+    const std::string outputs { env ? env : "1920x1080@60" };
+    std::size_t begin { 0 };
+
+    while (begin <= outputs.size())
+    {
+        std::size_t end { outputs.find(',', begin) };
+
+        if (end == std::string::npos)
+            end = outputs.size();
+
+        const std::string entry { outputs.substr(begin, end - begin) };
+        begin = end + 1;
+
+        if (entry.empty())
+            continue;
+
+        Int32 w { 0 }, h { 0 };
+        Float32 hz { 60.f }, scale { 1.f };
+
+        if (sscanf(entry.c_str(), "%dx%d", &w, &h) != 2 || w <= 0 || h <= 0)
+        {
+            LLog::error("[%s] Invalid output entry \"%s\" in LOUVRE_HEADLESS_OUTPUTS. Expected WIDTHxHEIGHT[@REFRESH_HZ][:SCALE].", BKND_NAME, entry.c_str());
+            continue;
+        }
+
+        const std::size_t refreshPos { entry.find('@') };
+        const std::size_t scalePos { entry.find(':') };
+
+        if (refreshPos != std::string::npos)
+            hz = strtof(entry.c_str() + refreshPos + 1, nullptr);
+
+        if (scalePos != std::string::npos)
+            scale = strtof(entry.c_str() + scalePos + 1, nullptr);
+
+        if (hz <= 0.f)
+            hz = 60.f;
+
+        if (scale < 0.25f)
+            scale = 1.f;
+
+        createOutput(bknd, LSize(w, h), UInt32(hz * 1000.f), scale);
+    }
+
+    return !bknd->connectedOutputs.empty();
+}
+
+static void destroyOutputs(Backend *bknd)
+{
+    while (!bknd->connectedOutputs.empty())
+    {
+        LOutput *output { bknd->connectedOutputs.back() };
+        Output *bkndOutput { backendOutput(output) };
+        bknd->connectedOutputs.pop_back();
+
+        while (!bkndOutput->modes.empty())
+        {
+            delete bkndOutput->modes.back();
+            bkndOutput->modes.pop_back();
+        }
+
+        compositor()->onAnticipatedObjectDestruction(output);
+        delete output;
+        delete bkndOutput;
+    }
+}
+
+static bool initOutputGL(Backend *bknd, LOutput *output, Output *bkndOutput)
+{
+    bkndOutput->eglContext = eglCreateContext(bknd->eglDisplay, bknd->eglConfig, bknd->eglContext, eglContextAttribs);
+
+    if (bkndOutput->eglContext == EGL_NO_CONTEXT)
+    {
+        LLog::error("[%s] Failed to create EGL context for output %s.", BKND_NAME, output->name());
+        return false;
+    }
+
+    eglMakeCurrent(bknd->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, bkndOutput->eglContext);
+
+    const LSize &sizeB { bkndOutput->modes.front()->sizeB() };
+
+    for (UInt32 i = 0; i < bkndOutput->buffersCount; i++)
+    {
+        OutputBuffer &buffer { bkndOutput->buffers[i] };
+        buffer.renderedFrame = 0;
+        buffer.texture.texture.target = GL_TEXTURE_2D;
+        buffer.texture.glFmt = srmFormatDRMToGL(DRM_FORMAT_ABGR8888);
+        buffer.texture.pixelSize = 4;
+        buffer.texture.destroy = false;
+
+        glGenTextures(1, &buffer.texture.texture.id);
+        glBindTexture(GL_TEXTURE_2D, buffer.texture.texture.id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, sizeB.w(), sizeB.h(), 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+        glGenFramebuffers(1, &buffer.framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, buffer.framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, buffer.texture.texture.id, 0);
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            LLog::error("[%s] Incomplete framebuffer for output %s.", BKND_NAME, output->name());
+            return false;
+        }
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    bkndOutput->currentBuffer = 0;
+    bkndOutput->frame = 0;
+    bkndOutput->vblankBaseNs = monotonicNs();
+    bkndOutput->vblankSeq = 0;
+    return true;
+}
+
+static void unitOutputGL(Backend *bknd, Output *bkndOutput)
+{
+    for (UInt32 i = 0; i < bkndOutput->buffersCount; i++)
+    {
+        OutputBuffer &buffer { bkndOutput->buffers[i] };
+
+        if (buffer.wrapper)
+        {
+            // The texture is owned by the output
+            buffer.wrapper->m_graphicBackendData = nullptr;
+            delete buffer.wrapper;
+            buffer.wrapper = nullptr;
+        }
+
+        if (buffer.framebuffer)
+        {
+            glDeleteFramebuffers(1, &buffer.framebuffer);
+            buffer.framebuffer = 0;
+        }
+
+        if (buffer.texture.texture.id)
+        {
+            glDeleteTextures(1, &buffer.texture.texture.id);
+            buffer.texture.texture.id = 0;
+        }
+    }
+
+    eglMakeCurrent(bknd->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+    if (bkndOutput->eglContext != EGL_NO_CONTEXT)
+    {
+        eglDestroyContext(bknd->eglDisplay, bkndOutput->eglContext);
+        bkndOutput->eglContext = EGL_NO_CONTEXT;
+    }
+}
+
+/* Blocks until the next simulated vblank (or the refresh rate limit if v-sync is off)
+ * and fills the presentation time of the frame, mimicking a DRM page flip event */
+static void waitPageFlip(LOutput *output, Output *bkndOutput)
+{
+    const Int64 periodNs { Int64(1000000000000) / Int64(bkndOutput->modes.front()->refreshRate()) };
+    auto &presentationTime { output->imp()->presentationTime };
+    Int64 nowNs { monotonicNs() };
+
+    if (bkndOutput->vSync)
+    {
+        UInt64 seq { UInt64((nowNs - bkndOutput->vblankBaseNs) / periodNs) + 1 };
+
+        // At most one flip per vblank
+        if (seq <= bkndOutput->vblankSeq)
+            seq = bkndOutput->vblankSeq + 1;
+
+        bkndOutput->vblankSeq = seq;
+        const Int64 targetNs { bkndOutput->vblankBaseNs + Int64(seq) * periodNs };
+        presentationTime.time.tv_sec = targetNs / 1000000000;
+        presentationTime.time.tv_nsec = targetNs % 1000000000;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &presentationTime.time, NULL);
+        presentationTime.flags = SRM_PRESENTATION_TIME_FLAGS_VSYNC;
+        presentationTime.period = periodNs;
+        presentationTime.frame = seq;
+        return;
+    }
+
+    const Int32 refreshRateLimit { bkndOutput->refreshRateLimit };
+
+    if (refreshRateLimit >= 0)
+    {
+        const Int64 diff { LTime::us() - bkndOutput->lastFrameUsec };
+        Int64 target;
+
+        if (refreshRateLimit == 0)
+            target = (1000000/((2 * bkndOutput->modes.front()->refreshRate())/1000));
+        else
+            target = (1000000/refreshRateLimit);
+
+        target -= diff;
+
+        if (target > 0)
+            usleep(target);
+
+        bkndOutput->lastFrameUsec = LTime::us();
+        nowNs = monotonicNs();
+    }
+
+    bkndOutput->vblankSeq = UInt64((nowNs - bkndOutput->vblankBaseNs) / periodNs);
+    presentationTime.time.tv_sec = nowNs / 1000000000;
+    presentationTime.time.tv_nsec = nowNs % 1000000000;
+    presentationTime.flags = 0;
+    presentationTime.period = periodNs;
+    presentationTime.frame = bkndOutput->vblankSeq;
+}
+
+static void renderLoop(LOutput *output)
+{
+    Backend *bknd { backend() };
+    Output *bkndOutput { backendOutput(output) };
+
+    if (!initOutputGL(bknd, output, bkndOutput))
+    {
+        unitOutputGL(bknd, bkndOutput);
+        bkndOutput->initialized = -1;
+        return;
+    }
+
+    output->imp()->backendInitializeGL();
+    bkndOutput->initialized = 1;
+
+    pollfd fd { bkndOutput->eventFd, POLLIN, 0 };
+    eventfd_t value;
+
+    while (bkndOutput->running)
+    {
+        poll(&fd, 1, -1);
+
+        if (fd.revents & POLLIN)
+            eventfd_read(bkndOutput->eventFd, &value);
+
+        if (output->state() == LOutput::PendingUninitialize)
+        {
+            output->imp()->backendUninitializeGL();
+            continue;
+        }
+
+        if (output->state() != LOutput::Initialized || !bkndOutput->repaint.exchange(false))
+            continue;
+
+        OutputBuffer &buffer { bkndOutput->buffers[bkndOutput->currentBuffer] };
+        output->imp()->backendPaintGL();
+        buffer.renderedFrame = ++bkndOutput->frame;
+
+        // Wait for the GPU, just like a real page flip waits for the rendering fence
+        glFinish();
+
+        waitPageFlip(output, bkndOutput);
+        output->imp()->backendPageFlipped();
+        bkndOutput->currentBuffer = (bkndOutput->currentBuffer + 1) % bkndOutput->buffersCount;
+    }
+
+    if (output->state() == LOutput::PendingUninitialize)
+        output->imp()->backendUninitializeGL();
+
+    unitOutputGL(bknd, bkndOutput);
+}
+
+/* BACKEND API */
+
+UInt32 LGraphicBackend::backendGetId()
+{
+    return LGraphicBackendHeadless;
+}
+
+void *LGraphicBackend::backendGetContextHandle()
+{
+    return backend()->eglDisplay;
+}
+
+bool LGraphicBackend::backendInitialize()
+{
+    Backend *bknd { new Backend() };
+    compositor()->imp()->graphicBackendData = bknd;
+    bknd->allocator.m_name = "headless";
+    bknd->devices.push_back(&bknd->allocator);
+
+    if (!initEGL(bknd))
+        goto fail;
+
+    if (!parseOutputs(bknd))
+    {
+        LLog::fatal("[%s] No valid outputs in LOUVRE_HEADLESS_OUTPUTS.", BKND_NAME);
+        unitEGL(bknd);
+        goto fail;
+    }
+
+    return true;
+
+fail:
+    compositor()->imp()->graphicBackendData = nullptr;
+    delete bknd;
+    return false;
+}
+
+void LGraphicBackend::backendUninitialize()
+{
+    Backend *bknd { backend() };
+    destroyOutputs(bknd);
+    unitEGL(bknd);
+    compositor()->imp()->graphicBackendData = nullptr;
+    delete bknd;
+}
+
+void LGraphicBackend::backendSuspend()
+{
+    /* No TTY switching so no required */
+}
+
+void LGraphicBackend::backendResume()
+{
+    /* No TTY switching so no required */
+}
+
+const std::vector<LOutput*> *LGraphicBackend::backendGetConnectedOutputs()
+{
+    return &backend()->connectedOutputs;
+}
+
+const std::vector<LGPU*> *LGraphicBackend::backendGetDevices()
+{
+    return &backend()->devices;
+}
+
+const std::vector<LDMAFormat> *LGraphicBackend::backendGetDMAFormats()
+{
+    return &backend()->dmaFormats;
+}
+
+const std::vector<LDMAFormat> *LGraphicBackend::backendGetScanoutDMAFormats()
+{
+    return &backend()->dmaFormats;
+}
+
+EGLDisplay LGraphicBackend::backendGetAllocatorEGLDisplay()
+{
+    return backend()->eglDisplay;
+}
+
+EGLContext LGraphicBackend::backendGetAllocatorEGLContext()
+{
+    return backend()->eglContext;
+}
+
+// Context of the thread calling backendCreateSharedContext(), if any
+static thread_local EGLContext sharedContext { EGL_NO_CONTEXT };
+
+bool LGraphicBackend::backendCreateSharedContext()
+{
+    Backend *bknd { backend() };
+
+    if (sharedContext != EGL_NO_CONTEXT)
+        return true;
+
+    sharedContext = eglCreateContext(bknd->eglDisplay, bknd->eglConfig, bknd->eglContext, eglContextAttribs);
+
+    if (sharedContext == EGL_NO_CONTEXT)
+    {
+        LLog::error("[%s] Failed to create shared EGL context.", BKND_NAME);
+        return false;
+    }
+
+    eglMakeCurrent(bknd->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, sharedContext);
+    return true;
+}
+
+void LGraphicBackend::backendDestroySharedContext()
+{
+    Backend *bknd { backend() };
+
+    if (sharedContext == EGL_NO_CONTEXT)
+        return;
+
+    eglMakeCurrent(bknd->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(bknd->eglDisplay, sharedContext);
+    sharedContext = EGL_NO_CONTEXT;
+}
+
+LGPU *LGraphicBackend::backendGetAllocatorDevice()
+{
+    return &backend()->allocator;
+}
+
+/* TEXTURES */
+
+bool LGraphicBackend::textureCreateFromCPUBuffer(LTexture *texture, const LSize &size, UInt32 stride, UInt32 format, const void *pixels)
+{
+    const SRMGLFormat *glFmt { srmFormatDRMToGL(format) };
+
+    if (!glFmt)
+        return false;
+
+    UInt32 depth, bpp, pixelSize;
+
+    if (!srmFormatGetDepthBpp(format, &depth, &bpp))
+        return false;
+
+    if (bpp % 8 != 0)
+        return false;
+
+    pixelSize = bpp/8;
+
+    GLuint textureId { 0 };
+    glGenTextures(1, &textureId);
+
+    if (!textureId)
+        return false;
+
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    if (pixels)
+        glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, stride / pixelSize);
+
+    glTexImage2D(GL_TEXTURE_2D,
+                 0,
+                 glFmt->glInternalFormat,
+                 size.w(),
+                 size.h(),
+                 0,
+                 glFmt->glFormat,
+                 glFmt->glType,
+                 pixels);
+
+    if (pixels)
+        glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, 0);
+
+    glFlush();
+
+    CPUTexture *cpuTexture { new CPUTexture() };
+    cpuTexture->texture.id = textureId;
+    cpuTexture->texture.target = GL_TEXTURE_2D;
+    cpuTexture->glFmt = glFmt;
+    cpuTexture->pixelSize = pixelSize;
+    cpuTexture->destroy = true;
+    texture->m_graphicBackendData = cpuTexture;
+    return true;
+}
+
+bool LGraphicBackend::textureCreateFromWaylandDRM(LTexture *texture, void *wlBuffer)
+{
+    EGLint format, width, height;
+    GLenum target { GL_TEXTURE_2D };
+    EGLImage image;
+    GLuint id;
+
+    if (!compositor()->imp()->WL_bind_wayland_display ||
+        !compositor()->imp()->eglQueryWaylandBufferWL(LCompositor::eglDisplay(), (wl_resource*)wlBuffer, EGL_TEXTURE_FORMAT, &format))
+        return false;
+
+    compositor()->imp()->eglQueryWaylandBufferWL(LCompositor::eglDisplay(), (wl_resource*)wlBuffer, EGL_WIDTH, &width);
+    compositor()->imp()->eglQueryWaylandBufferWL(LCompositor::eglDisplay(), (wl_resource*)wlBuffer, EGL_HEIGHT, &height);
+    texture->m_sizeB.setW(width);
+    texture->m_sizeB.setH(height);
+
+    if (format == EGL_TEXTURE_RGB)
+        texture->m_format = DRM_FORMAT_XRGB8888;
+    else if (format == EGL_TEXTURE_RGBA)
+        texture->m_format = DRM_FORMAT_ARGB8888;
+    else if (format == EGL_TEXTURE_EXTERNAL_WL)
+    {
+        texture->m_format = DRM_FORMAT_YUYV;
+        target = GL_TEXTURE_EXTERNAL_OES;
+    }
+    else
+        texture->m_format = DRM_FORMAT_YUYV;
+
+    const static EGLAttrib attribs[3] {
+        EGL_IMAGE_PRESERVED_KHR,
+        EGL_TRUE,
+        EGL_NONE
+    };
+
+    image = eglCreateImage(LCompositor::eglDisplay(), EGL_NO_CONTEXT, EGL_WAYLAND_BUFFER_WL, wlBuffer, attribs);
+
+    if (image == EGL_NO_IMAGE)
+        return false;
+
+    glGenTextures(1, &id);
+    glBindTexture(target, id);
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    compositor()->imp()->glEGLImageTargetTexture2DOES(target, image);
+
+    DRMTexture *drmTexture { new DRMTexture() };
+    drmTexture->texture.id = id;
+    drmTexture->texture.target = target;
+    drmTexture->image = image;
+    texture->m_graphicBackendData = drmTexture;
+    return true;
+}
+
+bool LGraphicBackend::textureCreateFromDMA(LTexture */*texture*/, const LDMAPlanes */*planes*/)
+{
+    /* No DMA formats are advertised */
+    return false;
+}
+
+bool LGraphicBackend::textureCreateFromGL(LTexture *texture, GLuint id, GLenum target, UInt32 format, const LSize &/*size*/, bool transferOwnership)
+{
+    const SRMGLFormat *glFmt { srmFormatDRMToGL(format) };
+
+    if (!glFmt)
+        return false;
+
+    UInt32 depth, bpp;
+
+    if (!srmFormatGetDepthBpp(format, &depth, &bpp))
+        return false;
+
+    if (bpp % 8 != 0)
+        return false;
+
+    CPUTexture *cpuTexture { new CPUTexture() };
+    cpuTexture->texture.id = id;
+    cpuTexture->texture.target = target;
+    cpuTexture->glFmt = glFmt;
+    cpuTexture->pixelSize = bpp/8;
+    cpuTexture->destroy = transferOwnership;
+    texture->m_graphicBackendData = cpuTexture;
+    return true;
+}
+
+bool LGraphicBackend::textureUpdateRect(LTexture *texture, UInt32 stride, const LRect &dst, const void *pixels)
+{
+    if (!textureWriteBegin(texture))
+        return false;
+
+    textureWriteUpdate(texture, stride, dst, pixels);
+    return textureWriteEnd(texture);
+}
+
+bool LGraphicBackend::textureWriteBegin(LTexture *texture)
+{
+    return texture->sourceType() == LTexture::CPU && texture->m_graphicBackendData;
+}
+
+bool LGraphicBackend::textureWriteUpdate(LTexture *texture, UInt32 stride, const LRect &dst, const void *pixels)
+{
+    CPUTexture *cpuTexture { static_cast<CPUTexture*>(texture->m_graphicBackendData) };
+    glBindTexture(GL_TEXTURE_2D, cpuTexture->texture.id);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, stride / cpuTexture->pixelSize);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, dst.x(), dst.y(), dst.w(), dst.h(),
+                    cpuTexture->glFmt->glFormat, cpuTexture->glFmt->glType, pixels);
+    return true;
+}
+
+bool LGraphicBackend::textureWriteEnd(LTexture */*texture*/)
+{
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glFinish();
+    return true;
+}
+
+UInt32 LGraphicBackend::textureGetID(LOutput */*output*/, LTexture *texture)
+{
+    // All contexts belong to the same share group
+    Texture *bkndTexture { static_cast<Texture*>(texture->m_graphicBackendData) };
+
+    if (bkndTexture)
+        return bkndTexture->id;
+
+    return 0;
+}
+
+GLenum LGraphicBackend::textureGetTarget(LTexture *texture)
+{
+    Texture *bkndTexture { static_cast<Texture*>(texture->m_graphicBackendData) };
+
+    if (bkndTexture)
+        return bkndTexture->target;
+
+    return GL_TEXTURE_2D;
+}
+
+void LGraphicBackend::textureSetFence(LTexture */*texture*/)
+{
+    glFlush();
+}
+
+void LGraphicBackend::textureDestroy(LTexture *texture)
+{
+    switch (texture->sourceType())
+    {
+    case LTexture::CPU:
+    case LTexture::Framebuffer:
+    case LTexture::GL:
+        {
+            CPUTexture *cpuTexture { static_cast<CPUTexture*>(texture->m_graphicBackendData) };
+
+            if (cpuTexture)
+            {
+                if (cpuTexture->destroy)
+                    compositor()->imp()->destroyGLTexture(cpuTexture->texture.id);
+                delete cpuTexture;
+            }
+        }
+        break;
+    case LTexture::WL_DRM:
+        {
+            DRMTexture *drmTexture { static_cast<DRMTexture*>(texture->m_graphicBackendData) };
+
+            if (drmTexture)
+            {
+                compositor()->imp()->destroyGLTexture(drmTexture->texture.id);
+                compositor()->imp()->destroyEGLImage(drmTexture->image);
+                delete drmTexture;
+            }
+        }
+        break;
+    case LTexture::DMA:
+        break;
+    }
+}
+
+void LGraphicBackend::textureDestroyPending()
+{
+    /* Textures are released through LCompositorPrivate::destroyGLTexture() and destroyEGLImage() */
+}
+
+/* OUTPUT */
+
+bool LGraphicBackend::outputInitialize(LOutput *output)
+{
+    Output *bkndOutput { backendOutput(output) };
+
+    if (bkndOutput->renderThread.joinable())
+        return false;
+
+    // Called from the main thread, which is allowed to notify globals and surfaces
+    output->setScale(bkndOutput->scale);
+
+    bkndOutput->eventFd = eventfd(0, O_CLOEXEC | O_NONBLOCK);
+
+    if (bkndOutput->eventFd < 0)
+    {
+        LLog::error("[%s] Failed to create eventfd for output %s.", BKND_NAME, output->name());
+        return false;
+    }
+
+    bkndOutput->initialized = 0;
+    bkndOutput->running = true;
+    bkndOutput->repaint = true;
+    eventfd_write(bkndOutput->eventFd, 1);
+    bkndOutput->renderThread = std::thread(renderLoop, output);
+
+    while (bkndOutput->initialized == 0)
+        usleep(1000);
+
+    if (bkndOutput->initialized == 1)
+        return true;
+
+    bkndOutput->running = false;
+    bkndOutput->renderThread.join();
+    close(bkndOutput->eventFd);
+    bkndOutput->eventFd = -1;
+    return false;
+}
+
+bool LGraphicBackend::outputRepaint(LOutput *output)
+{
+    Output *bkndOutput { backendOutput(output) };
+
+    if (bkndOutput->eventFd < 0)
+        return false;
+
+    bkndOutput->repaint = true;
+    eventfd_write(bkndOutput->eventFd, 1);
+    return true;
+}
+
+void LGraphicBackend::outputUninitialize(LOutput *output)
+{
+    Output *bkndOutput { backendOutput(output) };
+
+    if (!bkndOutput->renderThread.joinable())
+        return;
+
+    bkndOutput->running = false;
+    eventfd_write(bkndOutput->eventFd, 1);
+    bkndOutput->renderThread.join();
+    close(bkndOutput->eventFd);
+    bkndOutput->eventFd = -1;
+    bkndOutput->initialized = 0;
+}
+
+// Reported so the damage is converted to buffer coordinates as with a real display, the buffers are never presented
+bool LGraphicBackend::outputHasBufferDamageSupport(LOutput */*output*/)
+{
+    // Nothing consumes the damage, reporting support would only make LOutput transform it each frame
+    return false;
+}
+
+void LGraphicBackend::outputSetBufferDamage(LOutput */*output*/, LRegion &/*region*/) {}
+
+/* OUTPUT PROPS */
+
+const char *LGraphicBackend::outputGetName(LOutput *output)
+{
+    return backendOutput(output)->name.c_str();
+}
+
+const char *LGraphicBackend::outputGetManufacturerName(LOutput */*output*/)
+{
+    return "Cuarzo Software";
+}
+
+const char *LGraphicBackend::outputGetModelName(LOutput */*output*/)
+{
+    return "Headless Output";
+}
+
+const char *LGraphicBackend::outputGetDescription(LOutput *output)
+{
+    return backendOutput(output)->description.c_str();
+}
+
+const char *LGraphicBackend::outputGetSerial(LOutput */*output*/)
+{
+    return nullptr;
+}
+
+const LSize *LGraphicBackend::outputGetPhysicalSize(LOutput *output)
+{
+    return &backendOutput(output)->physicalSize;
+}
+
+Int32 LGraphicBackend::outputGetSubPixel(LOutput */*output*/)
+{
+    return LOutput::SubPixel::Unknown;
+}
+
+LGPU *LGraphicBackend::outputGetDevice(LOutput */*output*/)
+{
+    return &backend()->allocator;
+}
+
+UInt32 LGraphicBackend::outputGetID(LOutput *output)
+{
+    return backendOutput(output)->id;
+}
+
+bool LGraphicBackend::outputIsNonDesktop(LOutput */*output*/)
+{
+    return false;
+}
+
+/* OUTPUT BUFFERING */
+
+UInt32 LGraphicBackend::outputGetFramebufferID(LOutput *output)
+{
+    Output *bkndOutput { backendOutput(output) };
+    return bkndOutput->buffers[bkndOutput->currentBuffer].framebuffer;
+}
+
+Int32 LGraphicBackend::outputGetCurrentBufferIndex(LOutput *output)
+{
+    return backendOutput(output)->currentBuffer;
+}
+
+UInt32 LGraphicBackend::outputGetBuffersCount(LOutput *output)
+{
+    return backendOutput(output)->buffersCount;
+}
+
+UInt32 LGraphicBackend::outputGetCurrentBufferAge(LOutput *output)
+{
+    // Same semantics as EGL_EXT_buffer_age
+    const Output *bkndOutput { backendOutput(output) };
+    const OutputBuffer &buffer { bkndOutput->buffers[bkndOutput->currentBuffer] };
+
+    if (buffer.renderedFrame == 0)
+        return 0;
+
+    return bkndOutput->frame - buffer.renderedFrame + 1;
+}
+
+LTexture *LGraphicBackend::outputGetBuffer(LOutput *output, UInt32 bufferIndex)
+{
+    Output *bkndOutput { backendOutput(output) };
+
+    if (bufferIndex >= bkndOutput->buffersCount || !bkndOutput->buffers[bufferIndex].texture.texture.id)
+        return nullptr;
+
+    OutputBuffer &buffer { bkndOutput->buffers[bufferIndex] };
+
+    if (buffer.wrapper)
+        return buffer.wrapper;
+
+    buffer.wrapper = new LTexture(true);
+    buffer.wrapper->m_graphicBackendData = &buffer.texture;
+    buffer.wrapper->m_sourceType = LTexture::Framebuffer;
+    buffer.wrapper->m_format = DRM_FORMAT_ABGR8888;
+    buffer.wrapper->m_sizeB = bkndOutput->modes.front()->sizeB();
+    return buffer.wrapper;
+}
+
+/* OUTPUT GAMMA */
+
+UInt32 LGraphicBackend::outputGetGammaSize(LOutput */*output*/)
+{
+    return 0;
+}
+
+bool LGraphicBackend::outputSetGamma(LOutput */*output*/, const LGammaTable &/*table*/)
+{
+    return false;
+}
+
+/* OUTPUT V-SYNC */
+
+bool LGraphicBackend::outputHasVSyncControlSupport(LOutput */*output*/)
+{
+    return true;
+}
+
+bool LGraphicBackend::outputIsVSyncEnabled(LOutput *output)
+{
+    return backendOutput(output)->vSync;
+}
+
+bool LGraphicBackend::outputEnableVSync(LOutput *output, bool enabled)
+{
+    backendOutput(output)->vSync = enabled;
+    return true;
+}
+
+void LGraphicBackend::outputSetRefreshRateLimit(LOutput *output, Int32 hz)
+{
+    backendOutput(output)->refreshRateLimit = hz;
+}
+
+Int32 LGraphicBackend::outputGetRefreshRateLimit(LOutput *output)
+{
+    return backendOutput(output)->refreshRateLimit;
+}
+
+/* OUTPUT TIME */
+
+clockid_t LGraphicBackend::outputGetClock(LOutput */*output*/)
+{
+    return CLOCK_MONOTONIC;
+}
+
+/* OUTPUT CURSOR */
+
+bool LGraphicBackend::outputHasHardwareCursorSupport(LOutput */*output*/)
+{
+    /* The cursor is always composited, which is what benchmarks should measure */
+    return false;
+}
+
+void LGraphicBackend::outputSetCursorTexture(LOutput */*output*/, UChar8 */*buffer*/) {}
+
+void LGraphicBackend::outputSetCursorPosition(LOutput */*output*/, const LPoint &/*position*/) {}
+
+/* OUTPUT MODES */
+
+const LOutputMode *LGraphicBackend::outputGetPreferredMode(LOutput *output)
+{
+    return backendOutput(output)->modes.front();
+}
+
+const LOutputMode *LGraphicBackend::outputGetCurrentMode(LOutput *output)
+{
+    return backendOutput(output)->modes.front();
+}
+
+const std::vector<LOutputMode*> *LGraphicBackend::outputGetModes(LOutput *output)
+{
+    return &backendOutput(output)->modes;
+}
+
+bool LGraphicBackend::outputSetMode(LOutput *output, LOutputMode *mode)
+{
+    return mode == backendOutput(output)->modes.front();
+}
+
+/* OUTPUT CONTENT TYPE */
+
+LContentType LGraphicBackend::outputGetContentType(LOutput *output)
+{
+    return backendOutput(output)->contentType;
+}
+
+void LGraphicBackend::outputSetContentType(LOutput *output, LContentType type)
+{
+    backendOutput(output)->contentType = type;
+}
+
+/* DIRECT SCANOUT */
+
+bool LGraphicBackend::outputSetScanoutBuffer(LOutput */*output*/, LTexture */*texture*/)
+{
+    return false;
+}
+
+/* DRM LEASE */
+
+int LGraphicBackend::backendCreateLease(const std::vector<LOutput*> &/*outputs*/)
+{
+    return -1;
+}
+
+void LGraphicBackend::backendRevokeLease(int /*fd*/) {}
+
+/* Only used by the DRM backend */
+
+int LGraphicBackend::openRestricted(const char */*path*/, int /*flags*/, void */*userData*/)
+{
+    return -1;
+}
+
+void LGraphicBackend::closeRestricted(int /*fd*/, void */*userData*/) {}
+
+static LGraphicBackendInterface API;
+
+extern "C" LGraphicBackendInterface *getAPI()
+{
+    API.backendGetId                    = &LGraphicBackend::backendGetId;
+    API.backendGetContextHandle         = &LGraphicBackend::backendGetContextHandle;
+    API.backendInitialize               = &LGraphicBackend::backendInitialize;
+    API.backendUninitialize             = &LGraphicBackend::backendUninitialize;
+    API.backendSuspend                  = &LGraphicBackend::backendSuspend;
+    API.backendResume                   = &LGraphicBackend::backendResume;
+    API.backendGetConnectedOutputs      = &LGraphicBackend::backendGetConnectedOutputs;
+    API.backendGetDevices               = &LGraphicBackend::backendGetDevices;
+    API.backendGetDMAFormats            = &LGraphicBackend::backendGetDMAFormats;
+    API.backendGetScanoutDMAFormats     = &LGraphicBackend::backendGetScanoutDMAFormats;
+    API.backendGetAllocatorEGLDisplay   = &LGraphicBackend::backendGetAllocatorEGLDisplay;
+    API.backendGetAllocatorEGLContext   = &LGraphicBackend::backendGetAllocatorEGLContext;
+    API.backendCreateSharedContext      = &LGraphicBackend::backendCreateSharedContext;
+    API.backendDestroySharedContext     = &LGraphicBackend::backendDestroySharedContext;
+    API.backendGetAllocatorDevice       = &LGraphicBackend::backendGetAllocatorDevice;
+
+    /* TEXTURES */
+    API.textureCreateFromCPUBuffer      = &LGraphicBackend::textureCreateFromCPUBuffer;
+    API.textureCreateFromWaylandDRM     = &LGraphicBackend::textureCreateFromWaylandDRM;
+    API.textureCreateFromDMA            = &LGraphicBackend::textureCreateFromDMA;
+    API.textureCreateFromGL             = &LGraphicBackend::textureCreateFromGL;
+    API.textureUpdateRect               = &LGraphicBackend::textureUpdateRect;
+    API.textureWriteBegin               = &LGraphicBackend::textureWriteBegin;
+    API.textureWriteUpdate              = &LGraphicBackend::textureWriteUpdate;
+    API.textureWriteEnd                 = &LGraphicBackend::textureWriteEnd;
+    API.textureGetID                    = &LGraphicBackend::textureGetID;
+    API.textureGetTarget                = &LGraphicBackend::textureGetTarget;
+    API.textureSetFence                 = &LGraphicBackend::textureSetFence;
+    API.textureDestroy                  = &LGraphicBackend::textureDestroy;
+    API.textureDestroyPending           = &LGraphicBackend::textureDestroyPending;
+
+    /* OUTPUT */
+    API.outputInitialize                = &LGraphicBackend::outputInitialize;
+    API.outputRepaint                   = &LGraphicBackend::outputRepaint;
+    API.outputUninitialize              = &LGraphicBackend::outputUninitialize;
+    API.outputHasBufferDamageSupport    = &LGraphicBackend::outputHasBufferDamageSupport;
+    API.outputSetBufferDamage           = &LGraphicBackend::outputSetBufferDamage;
+
+    /* OUTPUT PROPS */
+    API.outputGetName                   = &LGraphicBackend::outputGetName;
+    API.outputGetManufacturerName       = &LGraphicBackend::outputGetManufacturerName;
+    API.outputGetModelName              = &LGraphicBackend::outputGetModelName;
+    API.outputGetDescription            = &LGraphicBackend::outputGetDescription;
+    API.outputGetSerial                 = &LGraphicBackend::outputGetSerial;
+    API.outputGetPhysicalSize           = &LGraphicBackend::outputGetPhysicalSize;
+    API.outputGetSubPixel               = &LGraphicBackend::outputGetSubPixel;
+    API.outputGetDevice                 = &LGraphicBackend::outputGetDevice;
+    API.outputGetID                     = &LGraphicBackend::outputGetID;
+    API.outputIsNonDesktop              = &LGraphicBackend::outputIsNonDesktop;
+
+    /* OUTPUT BUFFERING */
+    API.outputGetFramebufferID          = &LGraphicBackend::outputGetFramebufferID;
+    API.outputGetCurrentBufferIndex     = &LGraphicBackend::outputGetCurrentBufferIndex;
+    API.outputGetBuffersCount           = &LGraphicBackend::outputGetBuffersCount;
+    API.outputGetCurrentBufferAge       = &LGraphicBackend::outputGetCurrentBufferAge;
+    API.outputGetBuffer                 = &LGraphicBackend::outputGetBuffer;
+
+    /* OUTPUT GAMMA */
+    API.outputGetGammaSize              = &LGraphicBackend::outputGetGammaSize;
+    API.outputSetGamma                  = &LGraphicBackend::outputSetGamma;
+
+    /* OUTPUT V-SYNC */
+    API.outputHasVSyncControlSupport    = &LGraphicBackend::outputHasVSyncControlSupport;
+    API.outputIsVSyncEnabled            = &LGraphicBackend::outputIsVSyncEnabled;
+    API.outputEnableVSync               = &LGraphicBackend::outputEnableVSync;
+    API.outputSetRefreshRateLimit       = &LGraphicBackend::outputSetRefreshRateLimit;
+    API.outputGetRefreshRateLimit       = &LGraphicBackend::outputGetRefreshRateLimit;
+
+    /* OUTPUT TIME */
+    API.outputGetClock                  = &LGraphicBackend::outputGetClock;
+
+    /* OUTPUT CURSOR */
+    API.outputHasHardwareCursorSupport  = &LGraphicBackend::outputHasHardwareCursorSupport;
+    API.outputSetCursorTexture          = &LGraphicBackend::outputSetCursorTexture;
+    API.outputSetCursorPosition         = &LGraphicBackend::outputSetCursorPosition;
+
+    /* OUTPUT MODES */
+    API.outputGetPreferredMode          = &LGraphicBackend::outputGetPreferredMode;
+    API.outputGetCurrentMode            = &LGraphicBackend::outputGetCurrentMode;
+    API.outputGetModes                  = &LGraphicBackend::outputGetModes;
+    API.outputSetMode                   = &LGraphicBackend::outputSetMode;
+
+    /* CONTENT TYPE */
+    API.outputGetContentType            = &LGraphicBackend::outputGetContentType;
+    API.outputSetContentType            = &LGraphicBackend::outputSetContentType;
+
+    /* DIRECT SCANOUT */
+    API.outputSetScanoutBuffer          = &LGraphicBackend::outputSetScanoutBuffer;
+
+    /* DRM LEASE */
+    API.backendCreateLease              = &LGraphicBackend::backendCreateLease;
+    API.backendRevokeLease              = &LGraphicBackend::backendRevokeLease;
+    return &API;
+}
@@ -21,6 +21,8 @@ public:
     static const std::vector<LDMAFormat>*   backendGetScanoutDMAFormats();
     static EGLDisplay                       backendGetAllocatorEGLDisplay();
     static EGLContext                       backendGetAllocatorEGLContext();
+    static bool                             backendCreateSharedContext();
+    static void                             backendDestroySharedContext();
     static LGPU*                            backendGetAllocatorDevice();
     static const std::vector<LGPU*> *       backendGetDevices();
 
@@ -37,6 +39,7 @@ public:
     static GLenum                           textureGetTarget(LTexture *texture);
     static void                             textureSetFence(LTexture *texture);
     static void                             textureDestroy(LTexture *texture);
+    static void                             textureDestroyPending();
 
     /* OUTPUT */
     static bool                             outputInitialize(LOutput *output);
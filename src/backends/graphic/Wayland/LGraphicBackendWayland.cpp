@@ -688,6 +688,36 @@ public:
         return eglContext;
     }
 
+    // Context of the thread calling backendCreateSharedContext(), if any
+    inline static thread_local EGLContext sharedContext { EGL_NO_CONTEXT };
+
+    static bool backendCreateSharedContext()
+    {
+        if (sharedContext != EGL_NO_CONTEXT)
+            return true;
+
+        sharedContext = eglCreateContext(eglDisplay, eglConfig, eglContext, eglContextAttribs);
+
+        if (sharedContext == EGL_NO_CONTEXT)
+        {
+            LLog::error("[%s] Failed to create shared EGL context.", BKND_NAME);
+            return false;
+        }
+
+        eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, sharedContext);
+        return true;
+    }
+
+    static void backendDestroySharedContext()
+    {
+        if (sharedContext == EGL_NO_CONTEXT)
+            return;
+
+        eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(eglDisplay, sharedContext);
+        sharedContext = EGL_NO_CONTEXT;
+    }
+
     static LGPU *backendGetAllocatorDevice()
     {
         return &allocator;
@@ -940,7 +970,7 @@ public:
                 if (cpuTexture)
                 {
                     if (cpuTexture->destroy)
-                        glDeleteTextures(1, &cpuTexture->texture.id);
+                        compositor()->imp()->destroyGLTexture(cpuTexture->texture.id);
                     delete cpuTexture;
                 }
             }
@@ -951,8 +981,8 @@ public:
 
                 if (drmTexture)
                 {
-                    glDeleteTextures(1, &drmTexture->texture.id);
-                    eglDestroyImage(LCompositor::eglDisplay(), drmTexture->image);
+                    compositor()->imp()->destroyGLTexture(drmTexture->texture.id);
+                    compositor()->imp()->destroyEGLImage(drmTexture->image);
                     delete drmTexture;
                 }
             }
@@ -962,6 +992,11 @@ public:
         }
     }
 
+    static void textureDestroyPending()
+    {
+        /* Textures are released through LCompositorPrivate::destroyGLTexture() and destroyEGLImage() */
+    }
+
     /* OUTPUT */
     static bool outputInitialize(LOutput */*output*/)
     {
@@ -1344,6 +1379,8 @@ extern "C" LGraphicBackendInterface *getAPI()
     API.backendGetScanoutDMAFormats     = &LGraphicBackend::backendGetScanoutDMAFormats;
     API.backendGetAllocatorEGLDisplay   = &LGraphicBackend::backendGetAllocatorEGLDisplay;
     API.backendGetAllocatorEGLContext   = &LGraphicBackend::backendGetAllocatorEGLContext;
+    API.backendCreateSharedContext      = &LGraphicBackend::backendCreateSharedContext;
+    API.backendDestroySharedContext     = &LGraphicBackend::backendDestroySharedContext;
     API.backendGetAllocatorDevice       = &LGraphicBackend::backendGetAllocatorDevice;
 
     /* TEXTURES */
@@ -1359,6 +1396,7 @@ extern "C" LGraphicBackendInterface *getAPI()
     API.textureGetTarget                = &LGraphicBackend::textureGetTarget;
     API.textureSetFence                 = &LGraphicBackend::textureSetFence;
     API.textureDestroy                  = &LGraphicBackend::textureDestroy;
+    API.textureDestroyPending           = &LGraphicBackend::textureDestroyPending;
 
     /* OUTPUT */
     API.outputInitialize                = &LGraphicBackend::outputInitialize;
@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <random>
+#include <vector>
+
+/* Compares the traversal of view children stored in a std::list (LView::children()), linked
+ * through intrusive sibling pointers only, and through the cached array of
+ * LView::childrenList() used by scenes. Nodes are padded to roughly the size
+ * of an LView and interleaved with unrelated heap allocations, as in a running compositor. */
+
+static constexpr std::size_t NodePadding { 1100 };
+
+struct ListNode
+{
+    std::list<ListNode*> children;
+    char pad[NodePadding];
+    int value;
+};
+
+struct IntrusiveNode
+{
+    IntrusiveNode *front { nullptr };
+    IntrusiveNode *back { nullptr };
+    IntrusiveNode *prevSibling { nullptr };
+    IntrusiveNode *nextSibling { nullptr };
+    char pad[NodePadding];
+    int value;
+    std::vector<IntrusiveNode*> array;
+    bool arrayChanged { true };
+};
+
+static const std::vector<IntrusiveNode*> &childrenArray(IntrusiveNode *node) noexcept
+{
+    if (node->arrayChanged)
+    {
+        node->array.clear();
+
+        for (IntrusiveNode *child { node->front }; child; child = child->nextSibling)
+            node->array.push_back(child);
+
+        node->arrayChanged = false;
+    }
+
+    return node->array;
+}
+
+// All traversals go from top to bottom, like LSceneView::drawOpaqueDamage()
+static long visitList(ListNode *node) noexcept
+{
+    long sum { node->value };
+
+    for (auto it = node->children.rbegin(); it != node->children.rend(); it++)
+        sum += visitList(*it);
+
+    return sum;
+}
+
+static long visitLinks(IntrusiveNode *node) noexcept
+{
+    long sum { node->value };
+
+    for (IntrusiveNode *child { node->back }; child; child = child->prevSibling)
+        sum += visitLinks(child);
+
+    return sum;
+}
+
+static long visitArray(IntrusiveNode *node) noexcept
+{
+    long sum { node->value };
+    const auto &children { childrenArray(node) };
+
+    for (auto it = children.rbegin(); it != children.rend(); it++)
+        sum += visitArray(*it);
+
+    return sum;
+}
+
+template<class Func>
+static double measure(int runs, Func func) noexcept
+{
+    volatile long result { 0 };
+    const auto start { std::chrono::steady_clock::now() };
+
+    for (int i = 0; i < runs; i++)
+        result = result + func();
+
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / runs;
+}
+
+static void printUsage() noexcept
+{
+    printf("Usage: louvre-bench-children [options]\n"
+           "  --nodes N        Number of nodes (default 20000)\n"
+           "  --runs N         Traversals averaged per result (default 200)\n"
+           "  --seed N         Seed for the tree shape and interleaved allocations (default 1)\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int nodes { 20000 };
+    int runs { 200 };
+    unsigned seed { 1 };
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--nodes") == 0 && i + 1 < argc)
+            nodes = std::max(2, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc)
+            runs = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    // Wide: all nodes are children of the root
+    // Deep: a chain of up to 1000 levels, remaining nodes attached to random parents
+    for (int shape = 0; shape < 2; shape++)
+    {
+        std::mt19937 rng(seed);
+        std::vector<ListNode*> listNodes;
+        std::vector<IntrusiveNode*> intrusiveNodes;
+        std::vector<void*> noise;
+
+        for (int i = 0; i < nodes; i++)
+        {
+            listNodes.push_back(new ListNode());
+            intrusiveNodes.push_back(new IntrusiveNode());
+            listNodes[i]->value = intrusiveNodes[i]->value = i;
+            noise.push_back(malloc(rng() % 256 + 16));
+        }
+
+        for (int i = 1; i < nodes; i++)
+        {
+            const int parent { shape == 0 ? 0 : (i <= 1000 ? i - 1 : static_cast<int>(rng() % i)) };
+
+            listNodes[parent]->children.push_back(listNodes[i]);
+            noise.push_back(malloc(rng() % 256 + 16));
+
+            IntrusiveNode *p { intrusiveNodes[parent] };
+            IntrusiveNode *child { intrusiveNodes[i] };
+            child->prevSibling = p->back;
+
+            if (p->back)
+                p->back->nextSibling = child;
+            else
+                p->front = child;
+
+            p->back = child;
+        }
+
+        const double listMs { measure(runs, [&]{ return visitList(listNodes[0]); }) };
+        const double linksMs { measure(runs, [&]{ return visitLinks(intrusiveNodes[0]); }) };
+        const double arrayMs { measure(runs, [&]{ return visitArray(intrusiveNodes[0]); }) };
+
+        printf("%s: std::list %.3f ms, links only %.3f ms, array %.3f ms\n",
+               shape == 0 ? "wide" : "deep", listMs, linksMs, arrayMs);
+
+        for (ListNode *node : listNodes)
+            delete node;
+
+        for (IntrusiveNode *node : intrusiveNodes)
+            delete node;
+
+        for (void *ptr : noise)
+            free(ptr);
+    }
+
+    return 0;
+}
@@ -0,0 +1,326 @@
+#include <LCompositor.h>
+#include <LOutput.h>
+#include <LPainter.h>
+#include <drm_fourcc.h>
+#include <GLES2/gl2.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include "Bench.h"
+
+// Every GROUP_SIZE views share a parent LLayerView
+#define GROUP_SIZE 64
+
+// Number of views raised on each frame by the Reorder pattern
+#define REORDER_COUNT 8
+
+static UInt64 nowNs() noexcept
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return UInt64(ts.tv_sec) * 1000000000 + UInt64(ts.tv_nsec);
+}
+
+static bool createTexture(LTexture *texture, UInt32 format, UInt8 alpha) noexcept
+{
+    const LSize size { 64, 64 };
+    std::vector<UInt8> pixels(size.area() * 4);
+
+    for (Int32 y = 0; y < size.h(); y++)
+    {
+        for (Int32 x = 0; x < size.w(); x++)
+        {
+            UInt8 *px { &pixels[(y * size.w() + x) * 4] };
+            px[0] = x * 4;
+            px[1] = y * 4;
+            px[2] = 255 - x * 2;
+            px[3] = alpha;
+        }
+    }
+
+    return texture->setDataFromMainMemory(size, size.w() * 4, format, pixels.data());
+}
+
+void Bench::build(const LSize &outputSize) noexcept
+{
+    m_outputSize = outputSize;
+    m_rand = config.seed;
+    m_samples.reserve(config.frames);
+
+    m_opaqueTexture = std::make_unique<LTexture>();
+    m_translucentTexture = std::make_unique<LTexture>();
+
+    if (!createTexture(m_opaqueTexture.get(), DRM_FORMAT_XRGB8888, 255))
+        fprintf(stderr, "[louvre-bench-scene] Failed to create opaque texture.\n");
+
+    if (!createTexture(m_translucentTexture.get(), DRM_FORMAT_ARGB8888, 128))
+        fprintf(stderr, "[louvre-bench-scene] Failed to create translucent texture.\n");
+
+    m_root = std::make_unique<LLayerView>(scene.mainView());
+    m_root->setSize(outputSize);
+
+    auto *background { new LSolidColorView(0.1f, 0.1f, 0.1f, 1.f, m_root.get()) };
+    background->setSize(outputSize);
+    m_ownedViews.emplace_back(background);
+
+    UInt32 nestedViews { 0 };
+
+    if (config.patterns & Nested)
+    {
+        const LSize nestedSize { outputSize.w() / 2, outputSize.h() / 2 };
+        m_nestedScene = std::make_unique<LSceneView>(nestedSize, 1.f, m_root.get());
+        m_nestedScene->setPos(outputSize.w() / 4, outputSize.h() / 4);
+        m_nestedScene->setClearColor({0.2f, 0.2f, 0.3f, 1.f});
+        m_nestedScene->enableScaling(true);
+
+        // An eighth of the views live inside the nested scene
+        nestedViews = config.views / 8;
+    }
+
+    LLayerView *group { nullptr };
+
+    for (UInt32 i = 0; i < config.views; i++)
+    {
+        const bool nested { i < nestedViews };
+
+        if (i % GROUP_SIZE == 0 || i == nestedViews)
+        {
+            LView *groupParent { nested ? static_cast<LView*>(m_nestedScene.get()) : static_cast<LView*>(m_root.get()) };
+            group = new LLayerView(groupParent);
+            group->setSize(nested ? m_nestedScene->size() : outputSize);
+            m_ownedViews.emplace_back(group);
+            m_groups.push_back(group);
+        }
+
+        createNode(i, group, group->size());
+    }
+
+    // The nested scene is drawn on top of the root groups
+    if (m_nestedScene)
+        m_nestedScene->insertAfter(m_root->children().back());
+}
+
+LView *Bench::createNode(UInt32 index, LView *parent, const LSize &bounds) noexcept
+{
+    const auto rand = [this](UInt32 max) -> UInt32
+    {
+        // Deterministic xorshift, runs are comparable across builds
+        m_rand ^= m_rand << 13;
+        m_rand ^= m_rand >> 17;
+        m_rand ^= m_rand << 5;
+        return max == 0 ? 0 : m_rand % max;
+    };
+
+    const LSize size { 32 + Int32(rand(224)), 32 + Int32(rand(224)) };
+    const LPoint origin { Int32(rand(std::max(1, bounds.w() - size.w()))), Int32(rand(std::max(1, bounds.h() - size.h()))) };
+    LView *view;
+    Float32 baseOpacity { 1.f };
+
+    switch (index % 4)
+    {
+    case 0:
+    case 1:
+    {
+        auto *textureView { new LTextureView(index % 4 == 0 ? m_opaqueTexture.get() : m_translucentTexture.get(), parent) };
+        textureView->enableDstSize(true);
+        textureView->setDstSize(size);
+        textureView->setPos(origin);
+        view = textureView;
+        break;
+    }
+    default:
+    {
+        baseOpacity = index % 4 == 2 ? 1.f : 0.5f;
+        auto *solidView { new LSolidColorView(rand(256) / 255.f, rand(256) / 255.f, rand(256) / 255.f, 1.f, parent) };
+        solidView->setSize(size);
+        solidView->setPos(origin);
+        solidView->setOpacity(baseOpacity);
+        view = solidView;
+        break;
+    }
+    }
+
+    m_ownedViews.emplace_back(view);
+    m_nodes.push_back({view, origin, Float32(rand(628)) / 100.f, baseOpacity});
+    return view;
+}
+
+void Bench::destroy() noexcept
+{
+    m_nodes.clear();
+    m_groups.clear();
+
+    // Children first, they are owned in creation order
+    while (!m_ownedViews.empty())
+        m_ownedViews.pop_back();
+
+    m_nestedScene.reset();
+    m_root.reset();
+    m_opaqueTexture.reset();
+    m_translucentTexture.reset();
+}
+
+void Bench::animate(LOutput *output) noexcept
+{
+    L_UNUSED(output)
+
+    const Float32 t { Float32(m_frame) * 0.05f };
+
+    if (config.patterns & Move)
+    {
+        for (Node &node : m_nodes)
+        {
+            const LPoint pos {
+                node.origin.x() + Int32(std::sin(t + node.phase) * 64.f),
+                node.origin.y() + Int32(std::cos(t + node.phase) * 48.f) };
+
+            if (node.view->type() == LView::TextureType)
+                static_cast<LTextureView*>(node.view)->setPos(pos);
+            else
+                static_cast<LSolidColorView*>(node.view)->setPos(pos);
+        }
+    }
+
+    if (config.patterns & Fade)
+    {
+        for (std::size_t i = 0; i < m_nodes.size(); i += 3)
+            m_nodes[i].view->setOpacity(m_nodes[i].baseOpacity * (0.55f + 0.45f * std::sin(t * 2.f + m_nodes[i].phase)));
+    }
+
+    if (config.patterns & Reorder)
+    {
+        for (UInt32 i = 0; i < REORDER_COUNT && !m_nodes.empty(); i++)
+        {
+            m_rand ^= m_rand << 13;
+            m_rand ^= m_rand >> 17;
+            m_rand ^= m_rand << 5;
+            LView *view { m_nodes[m_rand % m_nodes.size()].view };
+            LView *top { view->parent()->children().back() };
+
+            if (top != view)
+                view->insertAfter(top);
+        }
+    }
+
+    if (m_nestedScene)
+    {
+        const Float32 scale { 1.f + 0.25f * std::sin(t) };
+        m_nestedScene->setScalingVector(LSizeF(scale, scale));
+    }
+}
+
+void Bench::paint(LOutput *output) noexcept
+{
+    if (m_finished)
+    {
+        scene.handlePaintGL(output);
+        return;
+    }
+
+    animate(output);
+
+    output->painter()->resetStats();
+    const LPainter::Stats &stats { output->painter()->stats() };
+
+    const UInt64 start { nowNs() };
+    scene.handlePaintGL(output);
+
+    // Include the GPU work, the backend would otherwise overlap it with the next frame
+    glFinish();
+
+    const UInt64 frameNs { nowNs() - start };
+
+    if (m_frame++ < config.warmupFrames)
+        return;
+
+    m_samples.push_back({
+        .frameNs = frameNs,
+        .calcNewDamageNs = stats.calcNewDamageNs,
+        .bufferAgeDamageNs = stats.bufferAgeDamageNs,
+        .drawOpaqueDamageNs = stats.drawOpaqueDamageNs,
+        .drawBackgroundNs = stats.drawBackgroundNs,
+        .drawTranslucentDamageNs = stats.drawTranslucentDamageNs,
+        .drawRegionNs = stats.drawRegionNs,
+        .drawRegionCalls = stats.drawRegionCalls,
+        .drawCalls = stats.drawCalls,
+        .passDrawCallsAvoided = stats.passDrawCallsAvoided,
+        .passProgramChangesAvoided = stats.passProgramChangesAvoided,
+        .passTextureBindsAvoided = stats.passTextureBindsAvoided,
+        .passBlendingChangesAvoided = stats.passBlendingChangesAvoided });
+
+    if (m_samples.size() >= config.frames)
+    {
+        m_finished = true;
+        report();
+        compositor()->finish();
+    }
+}
+
+void Bench::report() const noexcept
+{
+    if (m_samples.empty())
+        return;
+
+    std::vector<UInt64> frameTimes;
+    frameTimes.reserve(m_samples.size());
+    Sample sum {};
+
+    for (const Sample &s : m_samples)
+    {
+        frameTimes.push_back(s.frameNs);
+        sum.frameNs += s.frameNs;
+        sum.calcNewDamageNs += s.calcNewDamageNs;
+        sum.bufferAgeDamageNs += s.bufferAgeDamageNs;
+        sum.drawOpaqueDamageNs += s.drawOpaqueDamageNs;
+        sum.drawBackgroundNs += s.drawBackgroundNs;
+        sum.drawTranslucentDamageNs += s.drawTranslucentDamageNs;
+        sum.drawRegionNs += s.drawRegionNs;
+        sum.drawRegionCalls += s.drawRegionCalls;
+        sum.drawCalls += s.drawCalls;
+        sum.passDrawCallsAvoided += s.passDrawCallsAvoided;
+        sum.passProgramChangesAvoided += s.passProgramChangesAvoided;
+        sum.passTextureBindsAvoided += s.passTextureBindsAvoided;
+        sum.passBlendingChangesAvoided += s.passBlendingChangesAvoided;
+    }
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+
+    const auto percentile = [&frameTimes](Float64 p) -> Float64
+    {
+        const std::size_t i { std::min(frameTimes.size() - 1, std::size_t(p * Float64(frameTimes.size() - 1) + 0.5)) };
+        return Float64(frameTimes[i]) / 1000000.0;
+    };
+
+    const Float64 n { Float64(m_samples.size()) };
+    const auto avgMs = [n](UInt64 ns) -> Float64 { return Float64(ns) / n / 1000000.0; };
+
+    printf("louvre-bench-scene\n");
+    printf("  views: %u, frames: %zu, output: %dx%d, patterns:%s%s%s%s\n",
+           config.views, m_samples.size(), m_outputSize.w(), m_outputSize.h(),
+           config.patterns & Move ? " move" : "",
+           config.patterns & Fade ? " fade" : "",
+           config.patterns & Reorder ? " reorder" : "",
+           config.patterns & Nested ? " nested" : "");
+    printf("  frame time (ms): avg %.3f  p50 %.3f  p99 %.3f  max %.3f\n",
+           avgMs(sum.frameNs), percentile(0.5), percentile(0.99), percentile(1.0));
+
+#if LOUVRE_PROFILING == 1
+    printf("  calcNewDamage (ms/frame):         %.3f\n", avgMs(sum.calcNewDamageNs));
+    printf("  buffer age damage (ms/frame):     %.3f\n", avgMs(sum.bufferAgeDamageNs));
+    printf("  drawOpaqueDamage (ms/frame):      %.3f\n", avgMs(sum.drawOpaqueDamageNs));
+    printf("  drawBackground (ms/frame):        %.3f\n", avgMs(sum.drawBackgroundNs));
+    printf("  drawTranslucentDamage (ms/frame): %.3f\n", avgMs(sum.drawTranslucentDamageNs));
+    printf("  LPainter::drawRegion (ms/frame):  %.3f\n", avgMs(sum.drawRegionNs));
+#else
+    printf("  per-phase timings unavailable, configure with -Dprofiling=true\n");
+#endif
+
+    printf("  drawRegion calls/frame: %.1f\n", Float64(sum.drawRegionCalls) / n);
+    printf("  GL draw calls/frame:    %.1f\n", Float64(sum.drawCalls) / n);
+    printf("  avoided by sorted passes (per frame): draws %.1f  programs %.1f  textures %.1f  blending %.1f\n",
+           Float64(sum.passDrawCallsAvoided) / n,
+           Float64(sum.passProgramChangesAvoided) / n,
+           Float64(sum.passTextureBindsAvoided) / n,
+           Float64(sum.passBlendingChangesAvoided) / n);
+    fflush(stdout);
+}
@@ -0,0 +1,91 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <LScene.h>
+#include <LSceneView.h>
+#include <LLayerView.h>
+#include <LTextureView.h>
+#include <LSolidColorView.h>
+#include <LTexture.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+using namespace Louvre;
+
+/* Builds a synthetic scene and records per-frame timings while animating it */
+class Bench
+{
+public:
+    enum Pattern : UInt32
+    {
+        Move    = static_cast<UInt32>(1) << 0,
+        Fade    = static_cast<UInt32>(1) << 1,
+        Reorder = static_cast<UInt32>(1) << 2,
+        Nested  = static_cast<UInt32>(1) << 3,
+        All     = Move | Fade | Reorder | Nested
+    };
+
+    struct Config
+    {
+        UInt32 views { 2000 };
+        UInt32 frames { 600 };
+        UInt32 warmupFrames { 30 };
+        UInt32 patterns { All };
+        UInt32 seed { 1 };
+    };
+
+    Bench(const Config &config) noexcept : config(config) {}
+
+    void build(const LSize &outputSize) noexcept;
+    void destroy() noexcept;
+    void paint(LOutput *output) noexcept;
+    void report() const noexcept;
+    bool finished() const noexcept { return m_finished; }
+
+    const Config config;
+    LScene scene;
+
+private:
+    struct Sample
+    {
+        UInt64 frameNs;
+        UInt64 calcNewDamageNs;
+        UInt64 bufferAgeDamageNs;
+        UInt64 drawOpaqueDamageNs;
+        UInt64 drawBackgroundNs;
+        UInt64 drawTranslucentDamageNs;
+        UInt64 drawRegionNs;
+        UInt32 drawRegionCalls;
+        UInt32 drawCalls;
+        UInt32 passDrawCallsAvoided;
+        UInt32 passProgramChangesAvoided;
+        UInt32 passTextureBindsAvoided;
+        UInt32 passBlendingChangesAvoided;
+    };
+
+    struct Node
+    {
+        LView *view;
+        LPoint origin;
+        Float32 phase;
+        Float32 baseOpacity;
+    };
+
+    void animate(LOutput *output) noexcept;
+    LView *createNode(UInt32 index, LView *parent, const LSize &bounds) noexcept;
+
+    std::unique_ptr<LLayerView> m_root;
+    std::unique_ptr<LSceneView> m_nestedScene;
+    std::vector<std::unique_ptr<LView>> m_ownedViews;
+    std::vector<Node> m_nodes;
+    std::vector<LLayerView*> m_groups;
+    std::unique_ptr<LTexture> m_opaqueTexture, m_translucentTexture;
+    std::vector<Sample> m_samples;
+    LSize m_outputSize;
+    UInt32 m_frame { 0 };
+    UInt32 m_rand { 1 };
+    std::atomic<bool> m_finished { false };
+};
+
+#endif // BENCH_H
@@ -0,0 +1,46 @@
+#include <LSeat.h>
+#include <LOutput.h>
+#include <LLog.h>
+#include "Compositor.h"
+#include "Output.h"
+
+void Compositor::initialized()
+{
+    LOutput *benchOutput { nullptr };
+
+    // Only the first output is benchmarked, the rest would compete for the GPU
+    for (LOutput *output : seat()->outputs())
+    {
+        if (output->isNonDesktop())
+            continue;
+
+        benchOutput = output;
+        break;
+    }
+
+    if (!benchOutput)
+    {
+        LLog::fatal("[louvre-bench-scene] No output available.");
+        finish();
+        return;
+    }
+
+    bench.build(benchOutput->size());
+    benchOutput->setPos(LPoint(0, 0));
+    benchOutput->enableVSync(false);
+    benchOutput->setRefreshRateLimit(-1);
+    addOutput(benchOutput);
+}
+
+void Compositor::uninitialized()
+{
+    bench.destroy();
+}
+
+LFactoryObject *Compositor::createObjectRequest(LFactoryObject::Type objectType, const void *params)
+{
+    if (objectType == LFactoryObject::Type::LOutput)
+        return new Output(params);
+
+    return nullptr;
+}
@@ -0,0 +1,21 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include <LCompositor.h>
+#include "Bench.h"
+
+using namespace Louvre;
+
+class Compositor final : public LCompositor
+{
+public:
+    Compositor(const Bench::Config &config) noexcept : bench(config) {}
+
+    void initialized() override;
+    void uninitialized() override;
+    LFactoryObject *createObjectRequest(LFactoryObject::Type objectType, const void *params) override;
+
+    Bench bench;
+};
+
+#endif // COMPOSITOR_H
@@ -0,0 +1,37 @@
+#include <LScene.h>
+#include "Compositor.h"
+#include "Output.h"
+
+static Bench &bench() noexcept
+{
+    return static_cast<Compositor*>(compositor())->bench;
+}
+
+void Output::initializeGL()
+{
+    bench().scene.handleInitializeGL(this);
+    repaint();
+}
+
+void Output::paintGL()
+{
+    bench().paint(this);
+
+    if (!bench().finished())
+        repaint();
+}
+
+void Output::moveGL()
+{
+    bench().scene.handleMoveGL(this);
+}
+
+void Output::resizeGL()
+{
+    bench().scene.handleResizeGL(this);
+}
+
+void Output::uninitializeGL()
+{
+    bench().scene.handleUninitializeGL(this);
+}
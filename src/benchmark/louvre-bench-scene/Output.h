@@ -0,0 +1,20 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <LOutput.h>
+
+using namespace Louvre;
+
+class Output final : public LOutput
+{
+public:
+    using LOutput::LOutput;
+
+    void initializeGL() override;
+    void paintGL() override;
+    void moveGL() override;
+    void resizeGL() override;
+    void uninitializeGL() override;
+};
+
+#endif // OUTPUT_H
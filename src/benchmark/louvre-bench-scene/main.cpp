@@ -0,0 +1,92 @@
+#include <LLog.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "Compositor.h"
+
+using namespace Louvre;
+
+static void printUsage() noexcept
+{
+    printf("Usage: louvre-bench-scene [options]\n"
+           "  --views N        Number of synthetic views (default 2000)\n"
+           "  --frames N       Number of measured frames (default 600)\n"
+           "  --warmup N       Frames rendered before measuring (default 30)\n"
+           "  --seed N         Seed for the view layout and reordering (default 1)\n"
+           "  --patterns LIST  Comma-separated: move,fade,reorder,nested,all (default all)\n");
+}
+
+static bool parsePatterns(const char *str, UInt32 &patterns) noexcept
+{
+    patterns = 0;
+    char buffer[128];
+    strncpy(buffer, str, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+
+    for (char *tok = strtok(buffer, ","); tok; tok = strtok(nullptr, ","))
+    {
+        if (strcmp(tok, "move") == 0)
+            patterns |= Bench::Move;
+        else if (strcmp(tok, "fade") == 0)
+            patterns |= Bench::Fade;
+        else if (strcmp(tok, "reorder") == 0)
+            patterns |= Bench::Reorder;
+        else if (strcmp(tok, "nested") == 0)
+            patterns |= Bench::Nested;
+        else if (strcmp(tok, "all") == 0)
+            patterns |= Bench::All;
+        else
+            return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    Bench::Config config;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const bool hasValue { i + 1 < argc };
+
+        if (strcmp(argv[i], "--views") == 0 && hasValue)
+            config.views = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--frames") == 0 && hasValue)
+            config.frames = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--warmup") == 0 && hasValue)
+            config.warmupFrames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue)
+            config.seed = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--patterns") == 0 && hasValue)
+        {
+            if (!parsePatterns(argv[++i], config.patterns))
+            {
+                printUsage();
+                return 1;
+            }
+        }
+        else
+        {
+            printUsage();
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    // Offscreen rendering by default, can still be overridden
+    setenv("LOUVRE_GRAPHIC_BACKEND", "headless", 0);
+
+    Compositor compositor { config };
+
+    if (!compositor.start())
+    {
+        LLog::fatal("[louvre-bench-scene] Failed to start compositor.");
+        return 1;
+    }
+
+    while (compositor.state() != LCompositor::Uninitialized)
+        compositor.processLoop(-1);
+
+    return 0;
+}
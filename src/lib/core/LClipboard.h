@@ -27,7 +27,7 @@ public:
     struct MimeTypeFile
     {
         std::string mimeType; /**< Mime type string. */
-        FILE *tmp { NULL }; /**< Clipboard content for the MIME type (can be NULL). */
+        FILE *tmp { NULL }; /**< Clipboard content for the MIME type, stored in a memfd when supported (can be NULL). */
     };
 
     /**
@@ -63,7 +63,9 @@ public:
      * @brief Filter of persistent clipboard MIME types.
      *
      * Keep the clipboard data for specific MIME types even after the
-     * client owning the clipboard data is disconnected.
+     * client owning the clipboard data is disconnected.\n
+     * Data larger than `LOUVRE_CLIPBOARD_MAX_SIZE` is discarded, and it is sent to clients
+     * from the event loop as their pipes are drained, so large transfers don't block the compositor.
      *
      * @return `true` to make the MIME type persistent, `false` otherwise.
      *
@@ -338,6 +338,7 @@ Int32 LCompositor::processLoop(Int32 msTimeout)
         }
 
         imp()->destroyPendingRenderBuffers(nullptr);
+        imp()->destroyPendingTextures();
         imp()->handleDestroyedClients();
     }
 
@@ -352,6 +353,9 @@ Int32 LCompositor::processLoop(Int32 msTimeout)
         while (!outputs().empty())
             removeOutput(outputs().back());
 
+        imp()->destroyPendingTextures();
+        imp()->textureUploader.stop();
+
         for (LTexture *texture : imp()->textures)
             texture->reset();
 
@@ -536,7 +540,10 @@ void LCompositor::removeOutput(LOutput *output)
                 s->sendOutputLeaveEvent(output);
 
             for (LView *v : imp()->views)
-                v->removeThread(o->threadId());
+                v->removeThread(o->imp()->threadSlot);
+
+            imp()->releaseThreadSlot(o->imp()->threadSlot);
+            o->imp()->threadSlot = UINT32_MAX;
 
             LVectorRemoveOne(imp()->outputs, output);
 
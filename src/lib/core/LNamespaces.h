@@ -103,6 +103,7 @@ namespace Louvre
     class LSessionLockManager;
     class LSurface;
     class LTexture;
+    class LTextureAtlas;
     class LScreenshotRequest;
     class LActivationTokenManager;
     class LActivationToken;
@@ -284,8 +285,9 @@ namespace Louvre
      */
     enum LGraphicBackendID : UInt32
     {
-        LGraphicBackendDRM = 0,    ///< ID for the DRM graphic backend.
-        LGraphicBackendWayland = 1 ///< ID for the Wayland graphic backend.
+        LGraphicBackendDRM = 0,     ///< ID for the DRM graphic backend.
+        LGraphicBackendWayland = 1, ///< ID for the Wayland graphic backend.
+        LGraphicBackendHeadless = 2 ///< ID for the Headless graphic backend.
     };
 
     /**
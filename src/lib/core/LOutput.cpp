@@ -134,6 +134,16 @@ void LOutput::setRefreshRateLimit(Int32 hz) noexcept
     return compositor()->imp()->graphicBackend->outputSetRefreshRateLimit((LOutput*)this, hz);
 }
 
+bool LOutput::frameSnapshotsEnabled() const noexcept
+{
+    return imp()->frameSnapshots.load();
+}
+
+void LOutput::enableFrameSnapshots(bool enabled) noexcept
+{
+    imp()->frameSnapshots.store(enabled);
+}
+
 UInt32 LOutput::gammaSize() const noexcept
 {
     return compositor()->imp()->graphicBackend->outputGetGammaSize((LOutput*)this);
@@ -502,6 +512,9 @@ void LOutput::setPos(const LPoint &pos) noexcept
 {
     imp()->rect.setPos(pos);
 
+    // Role positions of layer and session lock surfaces depend on it
+    compositor()->imp()->viewsInputSerial++;
+
     for (auto *head : imp()->wlrOutputHeads)
         head->position(pos);
 }
@@ -552,6 +552,35 @@ public:
      */
     void setRefreshRateLimit(Int32 hz) noexcept;
 
+    /**
+     * @brief Checks if frame snapshots are enabled (disabled by default).
+     *
+     * @see enableFrameSnapshots()
+     *
+     * @return `true` if enabled, `false` otherwise.
+     */
+    bool frameSnapshotsEnabled() const noexcept;
+
+    /**
+     * @brief Submits the GPU commands of each frame from a snapshot, without holding the compositor lock.
+     *
+     * By default, the compositor lock is held during the entire paintGL() call, so outputs are painted one at a time and
+     * the main thread cannot dispatch client requests meanwhile.\n
+     * When enabled, everything painted into the output framebuffer through the LPainter API during paintGL() is recorded into
+     * a snapshot of plain GL values (texture IDs, vertices, uniforms), which is replayed after the lock is released. This allows
+     * multiple outputs to submit their GPU commands in parallel and clients to be dispatched in the meantime.
+     *
+     * @warning paintGL() itself, including the scene traversal and damage calculation of LScene::handlePaintGL(), still runs
+     *          while holding the compositor lock. Only the submission of the recorded commands is moved out of it.
+     *
+     * @note Only LPainter calls are recorded. Raw OpenGL calls made within paintGL() are executed immediately, and reading the
+     *       output framebuffer from paintGL() returns the content of the previous frame. Rendering into other framebuffers,
+     *       such as those of nested LSceneViews, is executed immediately as usual.
+     *
+     * @param enabled `true` to enable, `false` to disable.
+     */
+    void enableFrameSnapshots(bool enabled) noexcept;
+
     /**
      * @brief Gets the size of the gamma table.
      *
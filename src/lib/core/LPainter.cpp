@@ -11,35 +11,15 @@
 #include <GLES2/gl2.h>
 #include <cstdio>
 #include <string.h>
+#include <algorithm>
 
 using namespace Louvre;
 
-static void makeExternalShader(std::string &shader) noexcept
-{
-    size_t pos = 0;
-    std::string findStr = "sampler2D";
-    std::string replaceStr = "samplerExternalOES";
+/* Shared by the generic programs and the specialized variants (see LPainterPrivate::bindVariant()).
+ * Branches use the V_* macros, which are either uniform expressions (generic) or constants the
+ * GLSL compiler folds away (variants) */
 
-    shader = std::string("#extension GL_OES_EGL_image_external : require\n") + shader;
-
-    while ((pos = shader.find(findStr, pos)) != std::string::npos)
-    {
-        shader.replace(pos, findStr.length(), replaceStr);
-        pos += replaceStr.length();
-    }
-}
-
-LPainter::LPainter() noexcept : LPRIVATE_INIT_UNIQUE(LPainter)
-{
-    imp()->painter = this;
-
-    compositor()->imp()->threadsMap[std::this_thread::get_id()].painter = this;
-
-    imp()->updateExtensions();
-    imp()->updateCPUFormats();
-
-    // Open the vertex/fragment shaders
-    GLchar vShaderStr[] = R"(
+static const char *vertexShaderSource = R"(
         precision mediump float;
         precision mediump int;
         uniform mediump vec2 texSize;
@@ -53,7 +33,18 @@ LPainter::LPainter() noexcept : LPRIVATE_INIT_UNIQUE(LPainter)
         {
             gl_Position = vec4(vertexPosition.xy, 0.0, 1.0);
 
-            if (mode == 1)
+            // Batched regions, texcoords are provided per vertex
+            if (V_MODE_BATCHED)
+            {
+                v_texcoord = vertexPosition.zw;
+
+                if (V_HAS_90DEG)
+                    v_texcoord.yx = v_texcoord;
+
+                return;
+            }
+
+            if (V_MODE_TEXTURE)
             {
                 if (vertexPosition.x == -1.0)
                     v_texcoord.x = srcRect.x;
@@ -65,12 +56,12 @@ LPainter::LPainter() noexcept : LPRIVATE_INIT_UNIQUE(LPainter)
                 else
                     v_texcoord.y = srcRect.w;
 
-                if (has90deg)
+                if (V_HAS_90DEG)
                     v_texcoord.yx = v_texcoord;
 
                 return;
             }
-            else if (mode == 0)
+            else if (V_MODE_LEGACY)
             {
                 v_texcoord.x = (srcRect.x + vertexPosition.z*srcRect.z) / texSize.x;
                 v_texcoord.y = (srcRect.y + srcRect.w - vertexPosition.w*srcRect.w) / texSize.y;
@@ -78,7 +69,7 @@ LPainter::LPainter() noexcept : LPRIVATE_INIT_UNIQUE(LPainter)
         }
         )";
 
-    GLchar fShaderStr[] =R"(
+static const char *fragmentShaderSource = R"(
         uniform mediump sampler2D tex;
         uniform bool colorFactorEnabled;
         uniform lowp int mode;
@@ -91,35 +82,35 @@ LPainter::LPainter() noexcept : LPRIVATE_INIT_UNIQUE(LPainter)
         void main()
         {
             // Texture
-            if (mode != 2)
+            if (V_TEXTURED)
             {
-                if (texColorEnabled)
+                if (V_TEX_COLOR)
                 {
                     gl_FragColor.xyz = color;
                     gl_FragColor.w = texture2D(tex, v_texcoord).w;
-                    if (alpha != 1.0)
+                    if (V_ALPHA)
                         gl_FragColor.w *= alpha;
                 }
                 else
                 {
-                    if (premultipliedAlpha)
+                    if (V_PREMULTIPLIED)
                     {
                         gl_FragColor = texture2D(tex, v_texcoord);
 
-                        if (alpha != 1.0)
+                        if (V_ALPHA)
                             gl_FragColor *= alpha;
 
-                        if (colorFactorEnabled)
+                        if (V_COLOR_FACTOR)
                             gl_FragColor.xyz *= color;
                     }
                     else
                     {
                         gl_FragColor = texture2D(tex, v_texcoord);
 
-                        if (alpha != 1.0)
+                        if (V_ALPHA)
                             gl_FragColor.w *= alpha;
 
-                        if (colorFactorEnabled)
+                        if (V_COLOR_FACTOR)
                             gl_FragColor.xyz *= color;
                     }
                 }
@@ -134,6 +125,47 @@ LPainter::LPainter() noexcept : LPRIVATE_INIT_UNIQUE(LPainter)
         }
         )";
 
+// Defines of the generic programs, everything is resolved at runtime
+static const char *genericShaderDefines = R"(
+#define V_MODE_BATCHED (mode == 3)
+#define V_MODE_TEXTURE (mode == 1)
+#define V_MODE_LEGACY (mode == 0)
+#define V_TEXTURED (mode != 2)
+#define V_HAS_90DEG has90deg
+#define V_TEX_COLOR texColorEnabled
+#define V_PREMULTIPLIED premultipliedAlpha
+#define V_COLOR_FACTOR colorFactorEnabled
+#define V_ALPHA (alpha != 1.0)
+)";
+
+static void makeExternalShader(std::string &shader) noexcept
+{
+    size_t pos = 0;
+    std::string findStr = "sampler2D";
+    std::string replaceStr = "samplerExternalOES";
+
+    shader = std::string("#extension GL_OES_EGL_image_external : require\n") + shader;
+
+    while ((pos = shader.find(findStr, pos)) != std::string::npos)
+    {
+        shader.replace(pos, findStr.length(), replaceStr);
+        pos += replaceStr.length();
+    }
+}
+
+LPainter::LPainter() noexcept : LPRIVATE_INIT_UNIQUE(LPainter)
+{
+    imp()->painter = this;
+
+    compositor()->imp()->threadsMap[std::this_thread::get_id()].painter = this;
+
+    imp()->updateExtensions();
+    imp()->updateCPUFormats();
+
+    // Open the vertex/fragment shaders
+    const std::string vShaderStr { std::string(genericShaderDefines) + vertexShaderSource };
+    const std::string fShaderStr { std::string(genericShaderDefines) + fragmentShaderSource };
+
     std::string fShaderStrExternal = fShaderStr;
     makeExternalShader(fShaderStrExternal);
 
@@ -178,37 +210,19 @@ LPainter::LPainter() noexcept : LPRIVATE_INIT_UNIQUE(LPainter)
         }
         )";
 
-    std::string fShaderStrScalerExternal = fShaderStr;
+    // Same box filter as the scaler program (not the regular one), only the sampler type differs
+    std::string fShaderStrScalerExternal = fShaderStrScaler;
     makeExternalShader(fShaderStrScalerExternal);
 
-    imp()->vertexShader = LOpenGL::compileShader(GL_VERTEX_SHADER, vShaderStr);
-    imp()->fragmentShader = LOpenGL::compileShader(GL_FRAGMENT_SHADER, fShaderStr);
-    imp()->fragmentShaderExternal = LOpenGL::compileShader(GL_FRAGMENT_SHADER, fShaderStrExternal.c_str());
-    imp()->fragmentShaderScaler = LOpenGL::compileShader(GL_FRAGMENT_SHADER, fShaderStrScaler);
-    imp()->fragmentShaderScalerExternal = LOpenGL::compileShader(GL_FRAGMENT_SHADER, fShaderStrScalerExternal.c_str());
-
-    GLint linked;
+    // Linked from cached binaries when available, see LProgramCache
+    LProgramCache &programCache { compositor()->imp()->programCache };
 
     /************** SCALER PROGRAM **************/
 
-    imp()->programObjectScaler = glCreateProgram();
-    glAttachShader(imp()->programObjectScaler, imp()->vertexShader);
-    glAttachShader(imp()->programObjectScaler, imp()->fragmentShaderScaler);
-
-    // Link the program
-    glLinkProgram(imp()->programObjectScaler);
+    imp()->programObjectScaler = programCache.link(vShaderStr.c_str(), fShaderStrScaler);
 
-    // Check the link status
-    glGetProgramiv(imp()->programObjectScaler, GL_LINK_STATUS, &linked);
-
-    if (!linked)
-    {
-        GLint infoLen = 0;
-        glGetProgramiv(imp()->programObjectScaler, GL_INFO_LOG_LENGTH, &infoLen);
-        glDeleteProgram(imp()->programObjectScaler);
-        imp()->programObjectScaler = 0;
+    if (!imp()->programObjectScaler)
         LLog::error("[LPainter::LPainter] Failed to compile scaler shader.");
-    }
     else
     {
         imp()->currentProgram = imp()->programObjectScaler;
@@ -218,24 +232,10 @@ LPainter::LPainter() noexcept : LPRIVATE_INIT_UNIQUE(LPainter)
 
     /************** SCALER PROGRAM EXTERNAL **************/
 
-    imp()->programObjectScalerExternal = glCreateProgram();
-    glAttachShader(imp()->programObjectScalerExternal, imp()->vertexShader);
-    glAttachShader(imp()->programObjectScalerExternal, imp()->fragmentShaderScalerExternal);
-
-    // Link the program
-    glLinkProgram(imp()->programObjectScalerExternal);
+    imp()->programObjectScalerExternal = programCache.link(vShaderStr.c_str(), fShaderStrScalerExternal.c_str());
 
-    // Check the link status
-    glGetProgramiv(imp()->programObjectScalerExternal, GL_LINK_STATUS, &linked);
-
-    if (!linked)
-    {
-        GLint infoLen = 0;
-        glGetProgramiv(imp()->programObjectScalerExternal, GL_INFO_LOG_LENGTH, &infoLen);
-        glDeleteProgram(imp()->programObjectScalerExternal);
-        imp()->programObjectScalerExternal = 0;
+    if (!imp()->programObjectScalerExternal)
         LLog::error("[LPainter::LPainter] Failed to compile scaler shader external.");
-    }
     else
     {
         imp()->currentProgram = imp()->programObjectScalerExternal;
@@ -245,23 +245,10 @@ LPainter::LPainter() noexcept : LPRIVATE_INIT_UNIQUE(LPainter)
 
     /************** RENDER PROGRAM EXTERNAL **************/
 
-    imp()->programObjectExternal = glCreateProgram();
-    glAttachShader(imp()->programObjectExternal, imp()->vertexShader);
-    glAttachShader(imp()->programObjectExternal, imp()->fragmentShaderExternal);
-
-    // Link the program
-    glLinkProgram(imp()->programObjectExternal);
-
-    // Check the link status
-    glGetProgramiv(imp()->programObjectExternal, GL_LINK_STATUS, &linked);
+    imp()->programObjectExternal = programCache.link(vShaderStr.c_str(), fShaderStrExternal.c_str());
 
-    if (!linked)
-    {
-        GLint infoLen = 0;
-        glGetProgramiv(imp()->programObjectExternal, GL_INFO_LOG_LENGTH, &infoLen);
-        glDeleteProgram(imp()->programObjectExternal);
+    if (!imp()->programObjectExternal)
         LLog::error("[LPainter::LPainter] Failed to compile external OES shader.");
-    }
     else
     {
         imp()->currentProgram = imp()->programObjectExternal;
@@ -274,21 +261,11 @@ LPainter::LPainter() noexcept : LPRIVATE_INIT_UNIQUE(LPainter)
 
     /************** RENDER PROGRAM **************/
 
-    imp()->programObject = glCreateProgram();
-    glAttachShader(imp()->programObject, imp()->vertexShader);
-    glAttachShader(imp()->programObject, imp()->fragmentShader);
+    imp()->programObject = programCache.link(vShaderStr.c_str(), fShaderStr.c_str());
 
-    // Link the program
-    glLinkProgram(imp()->programObject);
-
-    // Check the link status
-    glGetProgramiv(imp()->programObject, GL_LINK_STATUS, &linked);
-
-    if (!linked)
+    if (!imp()->programObject)
     {
-        GLint infoLen = 0;
-        glGetProgramiv(imp()->programObject, GL_INFO_LOG_LENGTH, &infoLen);
-        glDeleteProgram(imp()->programObject);
+        LLog::fatal("[LPainter::LPainter] Failed to compile shader.");
         exit(-1);
     }
 
@@ -313,6 +290,9 @@ LPainter::LPainter() noexcept : LPRIVATE_INIT_UNIQUE(LPainter)
     glDisable(GL_SAMPLE_ALPHA_TO_ONE);
 
     imp()->shaderSetAlpha(1.f);
+
+    const char *env { getenv("LOUVRE_SORTED_DRAW_PASSES") };
+    imp()->pass.enabled = env && atoi(env) == 1;
 }
 
 LPainter::~LPainter() noexcept
@@ -320,9 +300,12 @@ LPainter::~LPainter() noexcept
     notifyDestruction();
     glDeleteProgram(imp()->programObject);
     glDeleteProgram(imp()->programObjectExternal);
-    glDeleteShader(imp()->fragmentShaderExternal);
-    glDeleteShader(imp()->fragmentShader);
-    glDeleteShader(imp()->vertexShader);
+    glDeleteProgram(imp()->programObjectScaler);
+    glDeleteProgram(imp()->programObjectScalerExternal);
+
+    for (const auto &variant : imp()->variants)
+        if (variant.program)
+            glDeleteProgram(variant.program);
 }
 
 void LPainter::LPainterPrivate::setupProgram() noexcept
@@ -339,16 +322,77 @@ void LPainter::LPainterPrivate::setupProgram() noexcept
     glEnableVertexAttribArray(0);
 
     // Get Uniform Variables
-    currentUniforms->texSize = glGetUniformLocation(currentProgram, "texSize");
-    currentUniforms->srcRect = glGetUniformLocation(currentProgram, "srcRect");
-    currentUniforms->activeTexture = glGetUniformLocation(currentProgram, "tex");
-    currentUniforms->mode = glGetUniformLocation(currentProgram, "mode");
-    currentUniforms->color= glGetUniformLocation(currentProgram, "color");
-    currentUniforms->texColorEnabled = glGetUniformLocation(currentProgram, "texColorEnabled");
-    currentUniforms->colorFactorEnabled = glGetUniformLocation(currentProgram, "colorFactorEnabled");
-    currentUniforms->alpha = glGetUniformLocation(currentProgram, "alpha");
-    currentUniforms->premultipliedAlpha = glGetUniformLocation(currentProgram, "premultipliedAlpha");
-    currentUniforms->has90deg = glGetUniformLocation(currentProgram, "has90deg");
+    getUniformLocations(currentProgram, *currentUniforms);
+}
+
+void LPainter::LPainterPrivate::getUniformLocations(GLuint program, Uniforms &programUniforms) noexcept
+{
+    // Uniforms optimized out by variants get -1, which glUniform*() ignores
+    programUniforms.texSize = glGetUniformLocation(program, "texSize");
+    programUniforms.srcRect = glGetUniformLocation(program, "srcRect");
+    programUniforms.activeTexture = glGetUniformLocation(program, "tex");
+    programUniforms.mode = glGetUniformLocation(program, "mode");
+    programUniforms.color= glGetUniformLocation(program, "color");
+    programUniforms.texColorEnabled = glGetUniformLocation(program, "texColorEnabled");
+    programUniforms.colorFactorEnabled = glGetUniformLocation(program, "colorFactorEnabled");
+    programUniforms.alpha = glGetUniformLocation(program, "alpha");
+    programUniforms.premultipliedAlpha = glGetUniformLocation(program, "premultipliedAlpha");
+    programUniforms.has90deg = glGetUniformLocation(program, "has90deg");
+}
+
+bool LPainter::LPainterPrivate::compileVariant(UInt8 key) noexcept
+{
+    ShaderVariant &variant { variants[key] };
+    const UInt8 mode ( key & VariantModeMask );
+
+    std::string defines;
+    const auto define { [&defines](const char *name, const char *value)
+    {
+        defines += "\n#define ";
+        defines += name;
+        defines += ' ';
+        defines += value;
+    }};
+
+    const auto flag { [key](UInt8 bit) { return (key & bit) ? "true" : "false"; } };
+
+    // Texture and batched texture modes only differ in the vertex shader, so they share the variant
+    define("V_MODE_BATCHED", mode == TextureMode ? "(mode == 3)" : "false");
+    define("V_MODE_TEXTURE", mode == TextureMode ? "true" : "false");
+    define("V_MODE_LEGACY", mode == LegacyMode ? "true" : "false");
+    define("V_TEXTURED", mode == ColorMode ? "false" : "true");
+    define("V_HAS_90DEG", flag(VariantHas90Deg));
+    define("V_TEX_COLOR", flag(VariantTexColor));
+    define("V_PREMULTIPLIED", flag(VariantPremultiplied));
+    define("V_COLOR_FACTOR", flag(VariantColorFactor));
+    define("V_ALPHA", flag(VariantAlpha));
+    defines += '\n';
+
+    const std::string vShaderStr { defines + vertexShaderSource };
+    std::string fShaderStr { defines + fragmentShaderSource };
+
+    if (key & VariantExternal)
+        makeExternalShader(fShaderStr);
+
+    variant.program = compositor()->imp()->programCache.link(vShaderStr.c_str(), fShaderStr.c_str());
+
+    if (!variant.program)
+    {
+        variant.failed = true;
+        LLog::error("[LPainterPrivate::compileVariant] Failed to link shader variant %d, using the generic program instead.", key);
+        return false;
+    }
+
+    LLog::debug("[LPainterPrivate::compileVariant] Shader variant %d linked.", key);
+
+    getUniformLocations(variant.program, variant.uniforms);
+    variant.state = *currentState;
+    currentProgram = variant.program;
+    currentUniforms = &variant.uniforms;
+    currentState = &variant.state;
+    glUseProgram(currentProgram);
+    uploadUniforms();
+    return true;
 }
 
 void LPainter::LPainterPrivate::setupProgramScaler() noexcept
@@ -410,7 +454,9 @@ void LPainter::LPainterPrivate::updateCPUFormats() noexcept
 void LPainter::bindTextureMode(const TextureParams &p) noexcept
 {
     GLenum target = p.texture->target();
-    imp()->switchTarget(target);
+
+    if (!imp()->snapshot.deferring && !imp()->pass.recording)
+        imp()->switchTarget(target);
 
     if (imp()->userState.mode != LPainterPrivate::TextureMode)
     {
@@ -465,17 +511,21 @@ void LPainter::bindTextureMode(const TextureParams &p) noexcept
     LTransform invTrans = Louvre::requiredTransform(p.srcTransform, imp()->fb->transform());
     bool rotate = Louvre::is90Transform(invTrans);
 
+    // Size of the sampled part of the texture
+    const bool subRect { p.subRectB.w() > 0 && p.subRectB.h() > 0 };
+    const LSize &texSizeB { subRect ? p.subRectB.size() : p.texture->sizeB() };
+
     if (Louvre::is90Transform(p.srcTransform))
     {
-        srcH = Float32(p.texture->sizeB().w()) / p.srcScale;
-        srcW = Float32(p.texture->sizeB().h()) / p.srcScale;
+        srcH = Float32(texSizeB.w()) / p.srcScale;
+        srcW = Float32(texSizeB.h()) / p.srcScale;
         yFlip = !yFlip;
         xFlip = !xFlip;
     }
     else
     {
-        srcW = (Float32(p.texture->sizeB().w()) / p.srcScale);
-        srcH = (Float32(p.texture->sizeB().h()) / p.srcScale);
+        srcW = (Float32(texSizeB.w()) / p.srcScale);
+        srcH = (Float32(texSizeB.h()) / p.srcScale);
     }
 
     srcDstW = (Float32(p.dstSize.w()) * srcW) / srcRectW;
@@ -647,7 +697,8 @@ void LPainter::bindTextureMode(const TextureParams &p) noexcept
         return;
     }
 
-    imp()->shaderSetHas90Deg(rotate);
+    if (!imp()->snapshot.deferring && !imp()->pass.recording)
+        imp()->shaderSetHas90Deg(rotate);
 
     if (xFlip)
     {
@@ -674,6 +725,43 @@ void LPainter::bindTextureMode(const TextureParams &p) noexcept
     imp()->srcRect.setW(srcFbW);
     imp()->srcRect.setH(srcFbH);
 
+    /* The rect above maps the subrect to [0, 1], extend it to the whole texture.
+     * Framebuffer X maps to the texture V axis when the shader swaps the coords */
+    if (subRect)
+    {
+        const LSize &fullSizeB { p.texture->sizeB() };
+        const Float32 subX { Float32(rotate ? p.subRectB.y() : p.subRectB.x()) };
+        const Float32 subY { Float32(rotate ? p.subRectB.x() : p.subRectB.y()) };
+        const Float32 subW { Float32(rotate ? p.subRectB.h() : p.subRectB.w()) };
+        const Float32 subH { Float32(rotate ? p.subRectB.w() : p.subRectB.h()) };
+        const Float32 fullW { Float32(rotate ? fullSizeB.h() : fullSizeB.w()) };
+        const Float32 fullH { Float32(rotate ? fullSizeB.w() : fullSizeB.h()) };
+
+        imp()->srcRect.setX(srcFbX1 - subX * srcFbW / subW);
+        imp()->srcRect.setY(srcFbY1 - subY * srcFbH / subH);
+        imp()->srcRect.setW(srcFbW * fullW / subW);
+        imp()->srcRect.setH(srcFbH * fullH / subH);
+    }
+
+    if (imp()->snapshot.deferring)
+    {
+        imp()->snapshot.commands.push_back({
+            .type = LPainterPrivate::SnapshotCommand::BindTexture,
+            .id = p.texture->id(imp()->output),
+            .target = target,
+            .flag = rotate });
+        return;
+    }
+
+    if (imp()->pass.recording)
+    {
+        imp()->pass.texture = p.texture->id(imp()->output);
+        imp()->pass.target = target;
+        imp()->pass.has90deg = rotate;
+        imp()->pass.textureBinds++;
+        return;
+    }
+
     glActiveTexture(GL_TEXTURE0);
     imp()->shaderSetMode(LPainterPrivate::TextureMode);
     imp()->shaderSetActiveTexture(0);
@@ -695,38 +783,114 @@ void LPainter::bindColorMode() noexcept
 
 void LPainter::drawBox(const LBox &box) noexcept
 {
+    if (imp()->snapshot.deferring)
+    {
+        imp()->recordBoxes(&box, 1);
+        return;
+    }
+
+    if (imp()->pass.recording)
+    {
+        imp()->recordPassBoxes(&box, 1);
+        return;
+    }
+
     if (imp()->needsBlendFuncUpdate)
         imp()->updateBlendingParams();
 
+    if (imp()->canClear(imp()->currentBlending, 1))
+    {
+        imp()->clearBoxes(&box, 1, imp()->currentBlending.color);
+        return;
+    }
+
     imp()->setViewport(box.x1, box.y1, box.x2 - box.x1, box.y2 - box.y1);
+    imp()->bindVariant();
     glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+    imp()->stats.drawCalls++;
 }
 
 void LPainter::drawRect(const LRect &rect) noexcept
 {
+    if (imp()->snapshot.deferring)
+    {
+        const LBox box { rect.x(), rect.y(), rect.x() + rect.w(), rect.y() + rect.h() };
+        imp()->recordBoxes(&box, 1);
+        return;
+    }
+
+    if (imp()->pass.recording)
+    {
+        const LBox box { rect.x(), rect.y(), rect.x() + rect.w(), rect.y() + rect.h() };
+        imp()->recordPassBoxes(&box, 1);
+        return;
+    }
+
     if (imp()->needsBlendFuncUpdate)
         imp()->updateBlendingParams();
 
+    if (imp()->canClear(imp()->currentBlending, 1))
+    {
+        const LBox box { rect.x(), rect.y(), rect.x() + rect.w(), rect.y() + rect.h() };
+        imp()->clearBoxes(&box, 1, imp()->currentBlending.color);
+        return;
+    }
+
     imp()->setViewport(rect.x(), rect.y(), rect.w(), rect.h());
+    imp()->bindVariant();
     glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+    imp()->stats.drawCalls++;
 }
 
 void LPainter::drawRegion(const LRegion &region) noexcept
 {
-    if (imp()->needsBlendFuncUpdate)
-        imp()->updateBlendingParams();
+#if LOUVRE_PROFILING == 1
+    const UInt64 profilerStart { LPainterPrivate::profilerNs() };
+#endif
 
     Int32 n;
     const LBox *box = region.boxes(&n);
-    for (Int32 i = 0; i < n; i++)
+
+    if (imp()->snapshot.deferring)
+        imp()->recordBoxes(box, n);
+    else if (imp()->pass.recording)
+        imp()->recordPassBoxes(box, n);
+    else
     {
-        imp()->setViewport(box->x1,
-                           box->y1,
-                           box->x2 - box->x1,
-                           box->y2 - box->y1);
-        glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
-        box++;
+        if (imp()->needsBlendFuncUpdate)
+            imp()->updateBlendingParams();
+
+        if (imp()->canClear(imp()->currentBlending, n))
+            imp()->clearBoxes(box, n, imp()->currentBlending.color);
+        else
+#if LPAINTER_BATCH_REGIONS == 1
+        // Batched vertices carry no UVs for LegacyMode (left by LTexture::copyB()), which maps srcRect to each box
+        if (n > 1 && imp()->currentState->mode != LPainterPrivate::LegacyMode)
+            imp()->drawBoxesBatched(box, n);
+        else
+#endif
+        {
+            imp()->bindVariant();
+
+            for (Int32 i = 0; i < n; i++)
+            {
+                imp()->setViewport(box->x1,
+                                   box->y1,
+                                   box->x2 - box->x1,
+                                   box->y2 - box->y1);
+                glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+                box++;
+            }
+
+            imp()->stats.drawCalls += n;
+        }
     }
+
+    imp()->stats.drawRegionCalls++;
+
+#if LOUVRE_PROFILING == 1
+    imp()->stats.drawRegionNs += LPainterPrivate::profilerNs() - profilerStart;
+#endif
 }
 
 void LPainter::enableCustomTextureColor(bool enabled) noexcept
@@ -766,6 +930,11 @@ void LPainter::setAlpha(Float32 alpha) noexcept
     imp()->needsBlendFuncUpdate = true;
 }
 
+Float32 LPainter::alpha() const noexcept
+{
+    return imp()->userState.alpha;
+}
+
 void LPainter::setColor(const LRGBF &color) noexcept
 {
     if (imp()->userState.color == color)
@@ -777,16 +946,30 @@ void LPainter::setColor(const LRGBF &color) noexcept
 
 void LPainter::bindFramebuffer(LFramebuffer *framebuffer) noexcept
 {
+    imp()->endDrawPass();
+
     if (!framebuffer)
     {
         imp()->fbId = 0;
         imp()->fb = nullptr;
+        imp()->setDeferring(false);
         return;
     }
 
     imp()->fbId = framebuffer->id();
-    glBindFramebuffer(GL_FRAMEBUFFER, imp()->fbId);
     imp()->fb = framebuffer;
+
+    // Only the output framebuffer is deferred while recording a frame snapshot
+    if (imp()->snapshot.recording && framebuffer->type() == LFramebuffer::Output)
+    {
+        imp()->setDeferring(true);
+        imp()->snapshot.commands.push_back({ .type = LPainterPrivate::SnapshotCommand::BindFramebuffer, .id = imp()->fbId });
+        imp()->snapshot.viewport = {};
+        return;
+    }
+
+    imp()->setDeferring(false);
+    glBindFramebuffer(GL_FRAMEBUFFER, imp()->fbId);
 }
 
 LFramebuffer *LPainter::boundFramebuffer() const noexcept
@@ -796,16 +979,32 @@ LFramebuffer *LPainter::boundFramebuffer() const noexcept
 
 void LPainter::setViewport(const LRect &rect) noexcept
 {
-    imp()->setViewport(rect.x(), rect.y(), rect.w(), rect.h());
+    setViewport(rect.x(), rect.y(), rect.w(), rect.h());
 }
 
 void LPainter::setViewport(Int32 x, Int32 y, Int32 w, Int32 h) noexcept
 {
+    imp()->endDrawPass();
+
+    if (imp()->snapshot.deferring)
+    {
+        imp()->toFramebufferPixels(x, y, w, h);
+        imp()->recordViewport({x, y, x + w, y + h});
+        return;
+    }
+
     imp()->setViewport(x, y, w, h);
 }
 
 void LPainter::setClearColor(Float32 r, Float32 g, Float32 b, Float32 a) noexcept
 {
+    if (imp()->snapshot.deferring)
+    {
+        imp()->snapshot.commands.push_back({ .type = LPainterPrivate::SnapshotCommand::ClearColor, .color = {r, g, b, a} });
+        return;
+    }
+
+    imp()->clearColor = {r, g, b, a};
     glClearColor(r,g,b,a);
 }
 
@@ -818,7 +1017,6 @@ void LPainter::setColorFactor(Float32 r, Float32 g, Float32 b, Float32 a) noexce
         return;
 
     imp()->userState.colorFactor = {r, g, b, a};
-    imp()->shaderSetColorFactorEnabled(r != 1.f || g != 1.f || b != 1.f || a != 1.f);
     imp()->needsBlendFuncUpdate = true;
 }
 
@@ -828,7 +1026,6 @@ void LPainter::setColorFactor(const LRGBAF &factor) noexcept
         return;
 
     imp()->userState.colorFactor = factor;
-    imp()->shaderSetColorFactorEnabled(factor.r != 1.f || factor.g != 1.f || factor.b != 1.f || factor.a != 1.f);
     imp()->needsBlendFuncUpdate = true;
 }
 
@@ -837,6 +1034,20 @@ void LPainter::clearScreen() noexcept
     if (!imp()->fb)
         return;
 
+    imp()->endDrawPass();
+
+    if (imp()->snapshot.deferring)
+    {
+        Int32 x { imp()->fb->rect().x() };
+        Int32 y { imp()->fb->rect().y() };
+        Int32 w { imp()->fb->rect().w() };
+        Int32 h { imp()->fb->rect().h() };
+        imp()->toFramebufferPixels(x, y, w, h);
+        imp()->snapshot.commands.push_back({ .type = LPainterPrivate::SnapshotCommand::Clear, .box = {x, y, x + w, y + h} });
+        imp()->snapshot.viewport = {};
+        return;
+    }
+
     glDisable(GL_BLEND);
     imp()->setViewport(imp()->fb->rect().x(), imp()->fb->rect().y(), imp()->fb->rect().w(), imp()->fb->rect().h());
     glClear(GL_COLOR_BUFFER_BIT);
@@ -844,17 +1055,44 @@ void LPainter::clearScreen() noexcept
 }
 
 void LPainter::bindProgram() noexcept
+{
+    imp()->endDrawPass();
+
+    if (imp()->snapshot.deferring)
+    {
+        imp()->snapshot.commands.push_back({ .type = LPainterPrivate::SnapshotCommand::BindProgram });
+        imp()->snapshot.commands.push_back({ .type = LPainterPrivate::SnapshotCommand::BindFramebuffer, .id = imp()->fbId });
+        imp()->snapshot.viewport = {};
+        imp()->needsBlendFuncUpdate = true;
+        return;
+    }
+
+    imp()->resetGLState();
+    imp()->updateBlendingParams();
+}
+
+const LPainter::Stats &LPainter::stats() const noexcept
+{
+    return imp()->stats;
+}
+
+void LPainter::resetStats() noexcept
+{
+    imp()->stats = {};
+}
+
+void LPainter::LPainterPrivate::resetGLState() noexcept
 {
     eglBindAPI(EGL_OPENGL_ES_API);
-    glUseProgram(imp()->currentProgram);
+    glUseProgram(currentProgram);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     glBindRenderbuffer(GL_RENDERBUFFER, 0);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
     glBindTexture(GL_TEXTURE_2D, 0);
-    glBindAttribLocation(imp()->currentProgram, 0, "vertexPosition");
-    glUseProgram(imp()->currentProgram);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, imp()->square);
+    glBindAttribLocation(currentProgram, 0, "vertexPosition");
+    glUseProgram(currentProgram);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, square);
     glEnableVertexAttribArray(0);
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, 1.0f);
     glEnable(GL_BLEND);
@@ -901,49 +1139,222 @@ void LPainter::bindProgram() noexcept
     glBlendColor(0, 0, 0, 0);
     glBlendEquation(GL_FUNC_ADD);
 
-    glUniform2f(imp()->currentUniforms->texSize,
-                imp()->currentState->texSize.w(),
-                imp()->currentState->texSize.h());
+    uploadUniforms();
+}
 
-    glUniform4f(imp()->currentUniforms->srcRect,
-                imp()->currentState->srcRect.x(),
-                imp()->currentState->srcRect.y(),
-                imp()->currentState->srcRect.w(),
-                imp()->currentState->srcRect.h());
+void LPainter::LPainterPrivate::uploadUniforms() noexcept
+{
+    glUniform2f(currentUniforms->texSize,
+                currentState->texSize.w(),
+                currentState->texSize.h());
 
-    glUniform1i(imp()->currentUniforms->activeTexture,
-                imp()->currentState->activeTexture);
+    glUniform4f(currentUniforms->srcRect,
+                currentState->srcRect.x(),
+                currentState->srcRect.y(),
+                currentState->srcRect.w(),
+                currentState->srcRect.h());
 
-    glUniform1i(imp()->currentUniforms->colorFactorEnabled,
-                imp()->currentState->colorFactorEnabled);
+    glUniform1i(currentUniforms->activeTexture,
+                currentState->activeTexture);
 
-    glUniform1f(imp()->currentUniforms->alpha,
-                imp()->currentState->alpha);
+    glUniform1i(currentUniforms->colorFactorEnabled,
+                currentState->colorFactorEnabled);
 
-    glUniform1i(imp()->currentUniforms->mode,
-                imp()->currentState->mode);
+    glUniform1f(currentUniforms->alpha,
+                currentState->alpha);
 
-    glUniform3f(imp()->currentUniforms->color,
-                imp()->currentState->color.r,
-                imp()->currentState->color.g,
-                imp()->currentState->color.b);
+    glUniform1i(currentUniforms->mode,
+                currentState->mode);
 
-    glUniform1i(imp()->currentUniforms->texColorEnabled,
-                imp()->currentState->texColorEnabled);
+    glUniform3f(currentUniforms->color,
+                currentState->color.r,
+                currentState->color.g,
+                currentState->color.b);
 
-    glUniform1i(imp()->currentUniforms->premultipliedAlpha,
-                imp()->currentState->premultipliedAlpha);
+    glUniform1i(currentUniforms->texColorEnabled,
+                currentState->texColorEnabled);
 
-    glUniform1i(imp()->currentUniforms->has90deg,
-                imp()->currentState->has90deg);
+    glUniform1i(currentUniforms->premultipliedAlpha,
+                currentState->premultipliedAlpha);
 
-    imp()->updateBlendingParams();
+    glUniform1i(currentUniforms->has90deg,
+                currentState->has90deg);
 }
 
 void LPainter::setBlendFunc(const LBlendFunc &blendFunc) const noexcept
 {
     imp()->userState.customBlendFunc = blendFunc;
 
-    if (!imp()->userState.autoBlendFunc)
+    if (imp()->userState.autoBlendFunc)
+        return;
+
+    // Resolved along with the next draw
+    if (imp()->pass.recording)
+    {
+        imp()->needsBlendFuncUpdate = true;
+        return;
+    }
+
+    if (imp()->snapshot.deferring)
+    {
+        LPainterPrivate::SnapshotCommand cmd { .type = LPainterPrivate::SnapshotCommand::BlendFunc };
+        cmd.blending.blendFunc = blendFunc;
+        imp()->snapshot.commands.push_back(cmd);
+    }
+    else
         glBlendFuncSeparate(blendFunc.sRGBFactor, blendFunc.dRGBFactor, blendFunc.sAlphaFactor, blendFunc.dAlphaFactor);
 }
+
+void LPainter::LPainterPrivate::endDrawPass() noexcept
+{
+    if (!pass.recording)
+        return;
+
+    pass.recording = false;
+    needsBlendFuncUpdate = true;
+
+    if (pass.draws.empty())
+        return;
+
+    pass.order.resize(pass.draws.size());
+
+    for (UInt32 i = 0; i < pass.order.size(); i++)
+        pass.order[i] = i;
+
+    if (pass.opaque)
+    {
+        std::stable_sort(pass.order.begin(), pass.order.end(), [this](UInt32 a, UInt32 b)
+        {
+            const PassDraw &drawA { pass.draws[a] };
+            const PassDraw &drawB { pass.draws[b] };
+
+            if (drawA.clear != drawB.clear)
+                return drawA.clear;
+
+            if (drawA.variantKey != drawB.variantKey)
+                return drawA.variantKey < drawB.variantKey;
+
+            if (drawA.target != drawB.target)
+                return drawA.target < drawB.target;
+
+            return drawA.texture < drawB.texture;
+        });
+    }
+
+    // Merged draws are made contiguous
+    pass.batches.clear();
+    pass.replayVertices.clear();
+
+    for (UInt32 i : pass.order)
+    {
+        const PassDraw &draw { pass.draws[i] };
+
+        if (draw.clear)
+        {
+            pass.batches.push_back({ i, draw.first, draw.count });
+            continue;
+        }
+
+        const GLint first ( pass.replayVertices.size() / 4 );
+        pass.replayVertices.insert(pass.replayVertices.end(),
+                                   pass.vertices.begin() + std::size_t(draw.first) * 4,
+                                   pass.vertices.begin() + std::size_t(draw.first + draw.count) * 4);
+
+        if (!pass.batches.empty() && canMergePassDraws(pass.draws[pass.batches.back().draw], draw))
+            pass.batches.back().count += draw.count;
+        else
+            pass.batches.push_back({ i, first, draw.count });
+    }
+
+    const LBox &vp { pass.viewport };
+    glScissor(vp.x1, vp.y1, vp.x2 - vp.x1, vp.y2 - vp.y1);
+    glViewport(vp.x1, vp.y1, vp.x2 - vp.x1, vp.y2 - vp.y1);
+    glActiveTexture(GL_TEXTURE0);
+    shaderSetActiveTexture(0);
+
+    // Last non-clear draw
+    const PassDraw *prev { nullptr };
+    GLuint boundTexture { 0 };
+    GLenum boundTarget { GL_TEXTURE_2D };
+    UInt32 programChanges { 0 };
+    UInt32 textureBinds { 0 };
+    UInt32 blendingChanges { 0 };
+
+    for (const PassBatch &batch : pass.batches)
+    {
+        const PassDraw &draw { pass.draws[batch.draw] };
+
+        if (draw.clear)
+        {
+            glClearColor(draw.blending.color.r, draw.blending.color.g, draw.blending.color.b, 1.f);
+
+            for (GLsizei i = 0; i < batch.count; i++)
+            {
+                const LBox &box { pass.clearBoxes[batch.first + i] };
+                glScissor(box.x1, box.y1, box.x2 - box.x1, box.y2 - box.y1);
+                glClear(GL_COLOR_BUFFER_BIT);
+            }
+
+            glClearColor(clearColor.r, clearColor.g, clearColor.b, clearColor.a);
+            glScissor(vp.x1, vp.y1, vp.x2 - vp.x1, vp.y2 - vp.y1);
+            stats.clearCalls += batch.count;
+            continue;
+        }
+
+        if (draw.blending.mode == BatchedTextureMode)
+        {
+            if (textureBinds == 0 || draw.texture != boundTexture || draw.target != boundTarget)
+            {
+                boundTexture = draw.texture;
+                boundTarget = draw.target;
+                switchTarget(draw.target);
+                glBindTexture(draw.target, draw.texture);
+                glTexParameteri(draw.target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                glTexParameteri(draw.target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                glTexParameteri(draw.target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameteri(draw.target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                textureBinds++;
+            }
+
+            shaderSetHas90Deg(draw.has90deg);
+        }
+
+        if (!prev || !sameBlendingParams(prev->blending, draw.blending, !pass.opaque))
+        {
+            applyBlendingParams(draw.blending);
+            blendingChanges++;
+        }
+
+        if (!prev || prev->variantKey != draw.variantKey)
+            programChanges++;
+
+        bindVariant();
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, &pass.replayVertices[std::size_t(batch.first) * 4]);
+        glDrawArrays(GL_TRIANGLES, 0, batch.count);
+        stats.drawCalls++;
+        prev = &draw;
+    }
+
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, square);
+    shaderSetMode(TextureMode);
+
+    // Leave the last texture bound by the user, later draws outside the pass may not bind it again
+    if (pass.texture && (pass.texture != boundTexture || pass.target != boundTarget))
+    {
+        switchTarget(pass.target);
+        glBindTexture(pass.target, pass.texture);
+    }
+
+    shaderSetHas90Deg(pass.has90deg);
+
+    const auto avoided = [](UInt32 recorded, UInt32 submitted) -> UInt32
+    {
+        return recorded > submitted ? recorded - submitted : 0;
+    };
+
+    stats.passDraws += pass.draws.size();
+    stats.passDrawCallsAvoided += avoided(pass.draws.size(), pass.batches.size());
+    stats.passProgramChangesAvoided += avoided(pass.programChanges, programChanges);
+    stats.passTextureBindsAvoided += avoided(pass.textureBinds, textureBinds);
+    stats.passBlendingChangesAvoided += avoided(pass.blendingChanges, blendingChanges);
+}
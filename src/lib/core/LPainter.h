@@ -76,6 +76,15 @@ public:
          * @brief Scale factor of the texture.
          */
         Float32 srcScale { 1.f };
+
+        /**
+         * @brief Subrect of the texture buffer to be drawn as if it were the whole texture.
+         *
+         * Used to draw textures packed into a larger one, such as LTextureAtlas entries.
+         * Specified in buffer coordinates with the top-left corner as the origin, all other params are
+         * then relative to its size. An empty rect (default) uses the whole texture.
+         */
+        LRect subRectB;
     };
 
     /**
@@ -93,6 +102,8 @@ public:
      * In color mode, drawBox(), drawRect() and drawRegion() can be used to draw rectagles of the specified color.
      *
      * The color is set using setColor() and setAlpha().
+     * Fully opaque colors drawn with the auto blend function (see enableAutoBlendFunc()) are filled with scissored `glClear()` calls
+     * when the region has only a few boxes.
      */
     void bindColorMode() noexcept;
 
@@ -171,6 +182,13 @@ public:
      */
     void setAlpha(Float32 alpha) noexcept;
 
+    /**
+     * @brief Gets the alpha value.
+     *
+     * @see setAlpha().
+     */
+    Float32 alpha() const noexcept;
+
     /**
      * @brief Sets the color.
      *
@@ -270,9 +288,48 @@ public:
      * @brief Bind the internal LPainter program.
      *
      * @note This method should be used if you are working with your own OpenGL programs and want to use the LPainter methods again.
+     *       Calling it before your own OpenGL commands also submits draws deferred by sorted LSceneView passes (`LOUVRE_SORTED_DRAW_PASSES=1`),
+     *       so they are not drawn after them.
      */
     void bindProgram() noexcept;
 
+    /**
+     * @brief Rendering statistics.
+     *
+     * The phase timers are only updated when Louvre is built with `-Dprofiling=true`.
+     *
+     * @see stats()
+     */
+    struct Stats
+    {
+        UInt64 calcNewDamageNs; /**< Time spent in LSceneView::calcNewDamage() by the outermost scene. */
+        UInt64 bufferAgeDamageNs; /**< Time spent adding the damage of previous frames according to the buffer age by the outermost scene. */
+        UInt64 drawOpaqueDamageNs; /**< Time spent in LSceneView::drawOpaqueDamage() by the outermost scene. */
+        UInt64 drawBackgroundNs; /**< Time spent in LSceneView::drawBackground() by the outermost scene. */
+        UInt64 drawTranslucentDamageNs; /**< Time spent in LSceneView::drawTranslucentDamage() by the outermost scene. */
+        UInt64 drawRegionNs; /**< Time spent in drawRegion(). */
+        UInt32 drawRegionCalls; /**< Number of drawRegion() calls. */
+        UInt32 drawCalls; /**< Number of GL draw calls. */
+        UInt32 clearCalls; /**< Number of glClear() calls used to fill opaque color regions. */
+        UInt32 passDraws; /**< Draws recorded by sorted draw passes (`LOUVRE_SORTED_DRAW_PASSES=1`). */
+        UInt32 passDrawCallsAvoided; /**< GL draw calls avoided by sorted draw passes. */
+        UInt32 passProgramChangesAvoided; /**< Program changes avoided by sorted draw passes. */
+        UInt32 passTextureBindsAvoided; /**< Texture binds avoided by sorted draw passes. */
+        UInt32 passBlendingChangesAvoided; /**< Blending changes avoided by sorted draw passes. */
+    };
+
+    /**
+     * @brief Statistics accumulated by this painter since it was created or since the last resetStats() call.
+     *
+     * Each output thread has its own painter, see LOutput::painter().
+     */
+    const Stats &stats() const noexcept;
+
+    /**
+     * @brief Resets all stats() counters to zero.
+     */
+    void resetStats() noexcept;
+
     LPRIVATE_IMP_UNIQUE(LPainter)
 
     friend class LCompositor;
@@ -13,6 +13,7 @@
 #include <private/LSurfacePrivate.h>
 #include <LCursor.h>
 #include <LOutput.h>
+#include <LOutputMode.h>
 #include <LPopupRole.h>
 #include <LTime.h>
 #include <LKeyboard.h>
@@ -29,6 +30,7 @@ LPointer::LPointer(const void *params) noexcept : LFactoryObject(FactoryObjectTy
     LPointer **ptr { (LPointer**) params };
     assert(*ptr == nullptr && *ptr == seat()->pointer() && "Only a single LPointer instance can exist.");
     *ptr = this;
+    imp()->pendingMotionTimer.setCallback([this](LTimer*) { imp()->dispatchPendingMotion(); });
 }
 
 LPointer::~LPointer()
@@ -106,11 +108,18 @@ void LPointer::sendMoveEvent(const LPointerMoveEvent &event)
     {
         for (auto rPointer : gSeat->pointerRes())
         {
-            if (lockedPointer != rPointer)
+            const bool sendMotion { lockedPointer != rPointer && event.motion() != LPointerMoveEvent::RelativeOnly };
+            const bool sendRelativeMotion { event.motion() != LPointerMoveEvent::AbsoluteOnly };
+
+            if (!sendMotion && (!sendRelativeMotion || rPointer->relativePointerRes().empty()))
+                continue;
+
+            if (sendMotion)
                 rPointer->motion(event);
 
-            for (auto rRelativePointer : rPointer->relativePointerRes())
-                rRelativePointer->relativeMotion(event);
+            if (sendRelativeMotion)
+                for (auto rRelativePointer : rPointer->relativePointerRes())
+                    rRelativePointer->relativeMotion(event);
 
             rPointer->frame();
         }
@@ -356,6 +365,19 @@ void LPointer::enableNaturalScrollingY(bool enabled) noexcept
     imp()->state.setFlag(LPointerPrivate::NaturalScrollY, enabled);
 }
 
+void LPointer::enableMotionCoalescing(bool enabled) noexcept
+{
+    if (!enabled)
+        imp()->dispatchPendingMotion();
+
+    imp()->state.setFlag(S::MotionCoalescing, enabled);
+}
+
+bool LPointer::motionCoalescingEnabled() const noexcept
+{
+    return imp()->state.check(S::MotionCoalescing);
+}
+
 bool LPointer::naturalScrollingXEnabled() const noexcept
 {
     return imp()->state.check(LPointerPrivate::NaturalScrollX);
@@ -420,3 +442,55 @@ void LPointer::LPointerPrivate::sendLeaveEvent(LSurface *surface) noexcept
         }
     }
 }
+
+void LPointer::LPointerPrivate::coalesceMotion(const LPointerMoveEvent &event) noexcept
+{
+    if (state.check(S::PendingMotion))
+    {
+        pendingMotion.setDelta(pendingMotion.delta() + event.delta());
+        pendingMotion.setDeltaUnaccelerated(pendingMotion.deltaUnaccelerated() + event.deltaUnaccelerated());
+        pendingMotion.setDevice(event.device());
+        pendingMotion.setMs(event.ms());
+        pendingMotion.setUs(event.us());
+        pendingMotion.setSerial(event.serial());
+    }
+    else
+    {
+        pendingMotion = event;
+        pendingMotion.m_motion = LPointerMoveEvent::AbsoluteOnly;
+        state.add(S::PendingMotion);
+    }
+
+    if (pendingMotionTimer.running())
+        return;
+
+    // The first event after a frame is notified immediately, the following ones wait for the next frame
+    UInt32 frameMs { 0 };
+
+    if (cursor()->output() && cursor()->output()->currentMode() && cursor()->output()->currentMode()->refreshRate() > 0)
+        frameMs = 1000000 / cursor()->output()->currentMode()->refreshRate();
+
+    const UInt32 elapsedMs { LTime::ms() - lastMotionDispatchMs };
+
+    // Handlers may trigger new events, a zero interval would dispatch them recursively
+    if (elapsedMs >= frameMs && !state.check(S::DispatchingMotion))
+        dispatchPendingMotion();
+    else
+        pendingMotionTimer.start(elapsedMs >= frameMs ? 1 : frameMs - elapsedMs);
+}
+
+void LPointer::LPointerPrivate::dispatchPendingMotion() noexcept
+{
+    if (!state.check(S::PendingMotion))
+        return;
+
+    pendingMotionTimer.cancel();
+    state.remove(S::PendingMotion);
+    lastMotionDispatchMs = LTime::ms();
+
+    const LPointerMoveEvent event { pendingMotion };
+    state.add(S::DispatchingMotion);
+    seat()->onEvent(event);
+    seat()->pointer()->pointerMoveEvent(event);
+    state.remove(S::DispatchingMotion);
+}
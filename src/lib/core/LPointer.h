@@ -172,6 +172,31 @@ public:
      */
     bool naturalScrollingYEnabled() const noexcept;
 
+    /**
+     * @brief Toggles pointer motion coalescing.
+     *
+     * When enabled, only the absolute motion of pointer move events is coalesced. pointerMoveEvent() is invoked for each event
+     * received from the input backend with LPointerMoveEvent::RelativeOnly motion, which must only be forwarded with sendMoveEvent()
+     * (used for example by games when the pointer is locked). Their absolute motion is accumulated and notified at most once per
+     * frame of the output where the cursor is located, in an event with LPointerMoveEvent::AbsoluteOnly motion and the sum of their deltas.\n
+     * This prevents high polling rate mice from generating more cursor updates, LScene hit-tests and `wl_pointer.motion`
+     * events than can ever be displayed.
+     *
+     * @note Pending motion is always notified before any other pointer event, so their order is preserved.
+     *
+     * Disabled by default. See motionCoalescingEnabled().
+     *
+     * @param enabled Set to `true` to enable motion coalescing, or `false` to disable it.
+     */
+    void enableMotionCoalescing(bool enabled) noexcept;
+
+    /**
+     * @brief Checks if pointer motion coalescing is enabled.
+     *
+     * @see enableMotionCoalescing().
+     */
+    bool motionCoalescingEnabled() const noexcept;
+
     /**
      * @name Client Events
      *
@@ -185,6 +210,8 @@ public:
     /**
      * @brief Sends a pointer move event to the currently focused surface.
      *
+     * Sends `wl_pointer.motion` and relative motion events according to LPointerMoveEvent::motion().
+     *
      * @note To specify the position within the surface modify the mutable @ref LPointerMoveEvent::localPos property.
      */
     void sendMoveEvent(const LPointerMoveEvent &event);
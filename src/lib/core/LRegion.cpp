@@ -1,201 +1,660 @@
+#include <private/LFrameArena.h>
 #include <LRegion.h>
+#include <algorithm>
+#include <vector>
 
 using namespace Louvre;
 
-void LRegion::multiply(Float32 factor) noexcept
+#if LREGION_INLINE_BOXES > 0
+
+struct Span
 {
-    if (factor == 1.f)
+    Int32 x1, x2;
+};
+
+// Sorted and merged x spans of the boxes covering the y1-y2 band
+static Int32 bandSpans(const LBox *boxes, Int32 n, Int32 y1, Int32 y2, Span *spans) noexcept
+{
+    Int32 count { 0 };
+
+    for (Int32 i = 0; i < n; i++)
+    {
+        if (boxes[i].y1 > y1 || boxes[i].y2 < y2)
+            continue;
+
+        Int32 j { count++ };
+
+        for (; j > 0 && spans[j - 1].x1 > boxes[i].x1; j--)
+            spans[j] = spans[j - 1];
+
+        spans[j] = { boxes[i].x1, boxes[i].x2 };
+    }
+
+    Int32 merged { 0 };
+
+    for (Int32 i = 0; i < count; i++)
+    {
+        if (merged > 0 && spans[i].x1 <= spans[merged - 1].x2)
+            spans[merged - 1].x2 = std::max(spans[merged - 1].x2, spans[i].x2);
+        else
+            spans[merged++] = spans[i];
+    }
+
+    return merged;
+}
+
+static void extentsOf(const LBox *boxes, Int32 n, LBox *extents) noexcept
+{
+    if (n == 0)
+    {
+        *extents = { 0, 0, 0, 0 };
         return;
+    }
 
-    pixman_region32_t tmp;
-    pixman_region32_init(&tmp);
+    *extents = boxes[0];
 
-    int n;
-    const pixman_box32_t *rects { pixman_region32_rectangles(&m_region, &n) };
+    for (Int32 i = 1; i < n; i++)
+    {
+        extents->x1 = std::min(extents->x1, boxes[i].x1);
+        extents->y1 = std::min(extents->y1, boxes[i].y1);
+        extents->x2 = std::max(extents->x2, boxes[i].x2);
+        extents->y2 = std::max(extents->y2, boxes[i].y2);
+    }
+}
 
-    if (factor == 0.5f)
+static bool boxContains(const LBox &a, const LBox &b) noexcept
+{
+    return a.x1 <= b.x1 && a.y1 <= b.y1 && a.x2 >= b.x2 && a.y2 >= b.y2;
+}
+
+static bool boxesOverlap(const LBox &a, const LBox &b) noexcept
+{
+    return a.x1 < b.x2 && b.x1 < a.x2 && a.y1 < b.y2 && b.y1 < a.y2;
+}
+
+// Read-only Pixman region of inline boxes, stored on the stack so it needs no release
+struct InlinePixman
+{
+    pixman_region32_t region;
+    alignas(pixman_region32_data_t) UInt8 storage[LFrameArena::regionStorageSize(LREGION_INLINE_BOXES)];
+
+    const pixman_region32_t *init(const LBox *boxes, Int32 n) noexcept
+    {
+        LFrameArena::initRegion(&region, storage, boxes, n);
+        return &region;
+    }
+};
+
+#endif
+
+LRegion &LRegion::operator=(const LRegion &other) noexcept
+{
+    if (&other == this)
+        return *this;
+
+#if LREGION_INLINE_BOXES > 0
+    if (other.m_n >= 0)
+    {
+        setInline(other.m_boxes, other.m_n);
+        return *this;
+    }
+
+    m_n = -1;
+#endif
+
+    pixman_region32_copy(&m_region, &other.m_region);
+    return *this;
+}
+
+LRegion &LRegion::operator=(LRegion &&other) noexcept
+{
+    if (&other == this)
+        return *this;
+
+#if LREGION_INLINE_BOXES > 0
+    if (other.m_n >= 0)
     {
-        for (int i = 0; i < n; i++)
+        setInline(other.m_boxes, other.m_n);
+        other.clear();
+        return *this;
+    }
+
+    m_n = -1;
+    other.m_n = 0;
+    other.m_extents = { 0, 0, 0, 0 };
+#endif
+
+    pixman_region32_fini(&m_region);
+    m_region = other.m_region;
+    pixman_region32_init(&other.m_region);
+    return *this;
+}
+
+bool LRegion::containsPoint(const LPoint &point) const noexcept
+{
+#if LREGION_INLINE_BOXES > 0
+    if (m_n >= 0)
+    {
+        for (Int32 i = 0; i < m_n; i++)
+            if (point.x() >= m_boxes[i].x1 && point.x() < m_boxes[i].x2 &&
+                point.y() >= m_boxes[i].y1 && point.y() < m_boxes[i].y2)
+                return true;
+
+        return false;
+    }
+#endif
+
+    return pixman_region32_contains_point(&m_region, point.x(), point.y(), NULL);
+}
+
+void LRegion::offset(Int32 x, Int32 y) noexcept
+{
+    if (x == 0 && y == 0)
+        return;
+
+#if LREGION_INLINE_BOXES > 0
+    if (m_n >= 0)
+    {
+        if (m_n == 0)
+            return;
+
+        for (Int32 i = 0; i < m_n; i++)
         {
-            pixman_region32_union_rect(
-                        &tmp,
-                        &tmp,
-                        rects->x1 >> 1,
-                        rects->y1 >> 1,
-                        (rects->x2 - rects->x1) >> 1,
-                        (rects->y2 - rects->y1) >> 1);
-            rects++;
+            m_boxes[i].x1 += x;
+            m_boxes[i].x2 += x;
+            m_boxes[i].y1 += y;
+            m_boxes[i].y2 += y;
         }
+
+        m_extents.x1 += x;
+        m_extents.x2 += x;
+        m_extents.y1 += y;
+        m_extents.y2 += y;
+        return;
     }
-    else if (factor == 2.f)
+#endif
+
+    pixman_region32_translate(&m_region, x, y);
+}
+
+void LRegion::inverse(const LRect &rect) noexcept
+{
+    if (rect.w() <= 0 || rect.h() <= 0)
+    {
+        clear();
+        return;
+    }
+
+    const LBox box { rect.x(), rect.y(), rect.x() + rect.w(), rect.y() + rect.h() };
+
+#if LREGION_INLINE_BOXES > 0
+    if (m_n >= 0)
     {
-        for (int i = 0; i < n; i++)
+        LBox result[LREGION_INLINE_BOXES];
+        Int32 n;
+
+        if (inlineOp(Subtract, &box, 1, m_boxes, m_n, result, &n))
         {
-            pixman_region32_union_rect(
-                        &tmp,
-                        &tmp,
-                        rects->x1 << 1,
-                        rects->y1 << 1,
-                        (rects->x2 - rects->x1) << 1,
-                        (rects->y2 - rects->y1) << 1);
-            rects++;
+            setInline(result, n);
+            return;
         }
     }
+#endif
+
+    pixman_region32_inverse(pixmanRegion(), &m_region, (pixman_box32_t*)&box);
+    compact();
+}
+
+pixman_region32_t *LRegion::pixmanRegion() const noexcept
+{
+#if LREGION_INLINE_BOXES > 0
+    if (m_n == 1)
+        pixman_region32_reset(&m_region, (pixman_box32_t*)&m_boxes[0]);
+    else if (m_n > 1)
+    {
+        pixman_region32_fini(&m_region);
+        pixman_region32_init_rects(&m_region, (const pixman_box32_t*)m_boxes, m_n);
+    }
+
+    m_n = -1;
+#endif
+    return &m_region;
+}
+
+void LRegion::intersect(LRegion *dst, const LRegion *a, const LRegion *b) noexcept
+{
+    regionOp(Intersect, dst, a, b);
+}
+
+void LRegion::subtract(LRegion *dst, const LRegion *a, const LRegion *b) noexcept
+{
+    regionOp(Subtract, dst, a, b);
+}
+
+void LRegion::boxOp(Op op, const LBox &box) noexcept
+{
+#if LREGION_INLINE_BOXES > 0
+    if (m_n >= 0)
+    {
+        LBox result[LREGION_INLINE_BOXES];
+        Int32 n;
+
+        if (inlineOp(op, m_boxes, m_n, &box, 1, result, &n))
+        {
+            setInline(result, n);
+            return;
+        }
+    }
+#endif
+
+    const Int32 w { box.x2 - box.x1 };
+    const Int32 h { box.y2 - box.y1 };
+    pixman_region32_t *region { pixmanRegion() };
+
+    if (op == Union)
+        pixman_region32_union_rect(region, region, box.x1, box.y1, w, h);
+    else if (op == Intersect)
+        pixman_region32_intersect_rect(region, region, box.x1, box.y1, w, h);
     else
     {
-        for (int i = 0; i < n; i++)
+        pixman_region32_t tmp;
+        pixman_region32_init_rect(&tmp, box.x1, box.y1, w, h);
+        pixman_region32_subtract(region, region, &tmp);
+        pixman_region32_fini(&tmp);
+    }
+
+    compact();
+}
+
+void LRegion::regionOp(Op op, LRegion *dst, const LRegion *a, const LRegion *b) noexcept
+{
+#if LREGION_INLINE_BOXES > 0
+    if (a->m_n >= 0 && b->m_n >= 0)
+    {
+        LBox result[LREGION_INLINE_BOXES];
+        Int32 n;
+
+        if (inlineOp(op, a->m_boxes, a->m_n, b->m_boxes, b->m_n, result, &n))
         {
-            pixman_region32_union_rect(
-                &tmp,
-                &tmp,
-                floorf(float(rects->x1) * factor),
-                floorf(float(rects->y1) * factor),
-                ceilf(float(rects->x2 - rects->x1) * factor),
-                ceilf(float(rects->y2 - rects->y1) * factor));
-            rects++;
+            dst->setInline(result, n);
+            return;
         }
     }
 
-    pixman_region32_fini(&m_region);
-    m_region = tmp;
+    // Inline operands are converted into temporary Pixman regions so they keep their storage
+    InlinePixman tmpA, tmpB;
+    const pixman_region32_t *pA { a->m_n < 0 ? &a->m_region : tmpA.init(a->m_boxes, a->m_n) };
+    const pixman_region32_t *pB { b->m_n < 0 ? &b->m_region : tmpB.init(b->m_boxes, b->m_n) };
+
+    // Already converted if it is also an operand, m_region is empty otherwise
+    dst->m_n = -1;
+#else
+    const pixman_region32_t *pA { &a->m_region };
+    const pixman_region32_t *pB { &b->m_region };
+#endif
+
+    if (op == Union)
+        pixman_region32_union(&dst->m_region, (pixman_region32_t*)pA, (pixman_region32_t*)pB);
+    else if (op == Intersect)
+        pixman_region32_intersect(&dst->m_region, (pixman_region32_t*)pA, (pixman_region32_t*)pB);
+    else
+        pixman_region32_subtract(&dst->m_region, (pixman_region32_t*)pA, (pixman_region32_t*)pB);
+
+    dst->compact();
 }
 
-void LRegion::multiply(Float32 xFactor, Float32 yFactor) noexcept
+#if LREGION_INLINE_BOXES > 0
+bool LRegion::inlineOp(Op op, const LBox *a, Int32 na, const LBox *b, Int32 nb, LBox *dst, Int32 *n) noexcept
 {
-    if (xFactor == 1.f && yFactor == 1.f)
+    *n = 0;
+
+    if (na == 0 || nb == 0)
+    {
+        if (op == Intersect || (na == 0 && op == Subtract))
+            return true;
+
+        *n = na == 0 ? nb : na;
+        std::copy(na == 0 ? b : a, (na == 0 ? b : a) + *n, dst);
+        return true;
+    }
+
+    LBox extA, extB;
+    extentsOf(a, na, &extA);
+    extentsOf(b, nb, &extB);
+
+    if (op == Intersect)
+    {
+        if (!boxesOverlap(extA, extB))
+            return true;
+
+        if (na == 1 && nb == 1)
+        {
+            dst[0] = { std::max(a[0].x1, b[0].x1), std::max(a[0].y1, b[0].y1), std::min(a[0].x2, b[0].x2), std::min(a[0].y2, b[0].y2) };
+            *n = 1;
+            return true;
+        }
+    }
+    else if (op == Subtract)
+    {
+        if (nb == 1 && boxContains(b[0], extA))
+            return true;
+
+        if (!boxesOverlap(extA, extB))
+        {
+            *n = na;
+            std::copy(a, a + na, dst);
+            return true;
+        }
+    }
+    else
+    {
+        if (nb == 1 && boxContains(b[0], extA))
+        {
+            dst[0] = b[0];
+            *n = 1;
+            return true;
+        }
+
+        if (na == 1 && boxContains(a[0], extB))
+        {
+            dst[0] = a[0];
+            *n = 1;
+            return true;
+        }
+    }
+
+    // Split into horizontal bands at every box edge
+    Int32 ys[4 * LREGION_INLINE_BOXES];
+    Int32 ny { 0 };
+
+    for (Int32 i = 0; i < na; i++)
+    {
+        ys[ny++] = a[i].y1;
+        ys[ny++] = a[i].y2;
+    }
+
+    for (Int32 i = 0; i < nb; i++)
+    {
+        ys[ny++] = b[i].y1;
+        ys[ny++] = b[i].y2;
+    }
+
+    std::sort(ys, ys + ny);
+    ny = std::unique(ys, ys + ny) - ys;
+
+    Span spansA[LREGION_INLINE_BOXES], spansB[LREGION_INLINE_BOXES], spans[2 * LREGION_INLINE_BOXES];
+    Int32 prevBand { -1 }, prevCount { 0 };
+
+    for (Int32 band = 0; band < ny - 1; band++)
+    {
+        const Int32 y1 { ys[band] }, y2 { ys[band + 1] };
+        const Int32 cA { bandSpans(a, na, y1, y2, spansA) };
+        const Int32 cB { bandSpans(b, nb, y1, y2, spansB) };
+        Int32 count { 0 };
+        Int32 i { 0 }, j { 0 };
+
+        if (op == Union)
+        {
+            while (i < cA || j < cB)
+            {
+                const Span &s { (j >= cB || (i < cA && spansA[i].x1 <= spansB[j].x1)) ? spansA[i++] : spansB[j++] };
+
+                if (count > 0 && s.x1 <= spans[count - 1].x2)
+                    spans[count - 1].x2 = std::max(spans[count - 1].x2, s.x2);
+                else
+                    spans[count++] = s;
+            }
+        }
+        else if (op == Intersect)
+        {
+            while (i < cA && j < cB)
+            {
+                const Int32 x1 { std::max(spansA[i].x1, spansB[j].x1) };
+                const Int32 x2 { std::min(spansA[i].x2, spansB[j].x2) };
+
+                if (x1 < x2)
+                    spans[count++] = { x1, x2 };
+
+                if (spansA[i].x2 < spansB[j].x2)
+                    i++;
+                else
+                    j++;
+            }
+        }
+        else
+        {
+            for (; i < cA; i++)
+            {
+                Int32 x1 { spansA[i].x1 };
+
+                for (j = 0; j < cB && x1 < spansA[i].x2; j++)
+                {
+                    if (spansB[j].x2 <= x1 || spansB[j].x1 >= spansA[i].x2)
+                        continue;
+
+                    if (spansB[j].x1 > x1)
+                        spans[count++] = { x1, spansB[j].x1 };
+
+                    x1 = spansB[j].x2;
+                }
+
+                if (x1 < spansA[i].x2)
+                    spans[count++] = { x1, spansA[i].x2 };
+            }
+        }
+
+        if (count == 0)
+            continue;
+
+        // Coalesce with the previous band if adjacent and with the same spans
+        if (prevBand >= 0 && prevCount == count && dst[prevBand].y2 == y1)
+        {
+            bool equal { true };
+
+            for (Int32 k = 0; k < count && equal; k++)
+                equal = dst[prevBand + k].x1 == spans[k].x1 && dst[prevBand + k].x2 == spans[k].x2;
+
+            if (equal)
+            {
+                for (Int32 k = 0; k < count; k++)
+                    dst[prevBand + k].y2 = y2;
+
+                continue;
+            }
+        }
+
+        if (*n + count > LREGION_INLINE_BOXES)
+            return false;
+
+        prevBand = *n;
+        prevCount = count;
+
+        for (Int32 k = 0; k < count; k++)
+            dst[(*n)++] = { spans[k].x1, y1, spans[k].x2, y2 };
+    }
+
+    return true;
+}
+
+void LRegion::setInline(const LBox *boxes, Int32 n) noexcept
+{
+    if (m_n < 0)
+        pixman_region32_clear(&m_region);
+
+    if (boxes != m_boxes)
+        std::copy(boxes, boxes + n, m_boxes);
+
+    m_n = n;
+    extentsOf(m_boxes, m_n, &m_extents);
+}
+
+#endif
+
+void LRegion::compact() noexcept
+{
+#if LREGION_INLINE_BOXES > 0
+    if (m_n >= 0)
         return;
 
+    Int32 n;
+    const LBox *boxes { (const LBox*)pixman_region32_rectangles(&m_region, &n) };
+
+    if (n > LREGION_INLINE_BOXES)
+        return;
+
+    std::copy(boxes, boxes + n, m_boxes);
+    m_extents = n == 0 ? LBox { 0, 0, 0, 0 } : *(const LBox*)pixman_region32_extents(&m_region);
+    pixman_region32_clear(&m_region);
+    m_n = n;
+#endif
+}
+
+void LRegion::addBoxes(const LBox *boxes, Int32 n) noexcept
+{
+    if (n <= 0)
+        return;
+
+#if LREGION_INLINE_BOXES > 0
+    // Few boxes are merged inline without allocating
+    if (m_n >= 0 && n <= LREGION_INLINE_BOXES)
+    {
+        for (Int32 i = 0; i < n; i++)
+            if (boxes[i].x1 < boxes[i].x2 && boxes[i].y1 < boxes[i].y2)
+                boxOp(Union, boxes[i]);
+
+        return;
+    }
+#endif
+
+    // Sorts the boxes into bands and merges them in a single pass, empty boxes are discarded
     pixman_region32_t tmp;
-    pixman_region32_init(&tmp);
+    pixman_region32_init_rects(&tmp, (const pixman_box32_t*)boxes, n);
 
-    int n;
-    const pixman_box32_t *rects { pixman_region32_rectangles(&m_region, &n) };
+    if (empty())
+    {
+        pixman_region32_fini(&m_region);
+        m_region = tmp;
+#if LREGION_INLINE_BOXES > 0
+        m_n = -1;
+#endif
+    }
+    else
+    {
+        pixman_region32_t *region { pixmanRegion() };
+        pixman_region32_union(region, region, &tmp);
+        pixman_region32_fini(&tmp);
+    }
 
-    for (int i = 0; i < n; i++)
+    compact();
+}
+
+// Replaces dst with the union of the src boxes mapped by func, dst and src can be the same
+template<class Func>
+static void mapBoxes(LRegion *dst, const LRegion *src, Func func) noexcept
+{
+    Int32 n;
+    const LBox *boxes { src->boxes(&n) };
+    LBox stackBoxes[8];
+    std::vector<LBox> heapBoxes;
+    LBox *mapped { stackBoxes };
+
+    // From the frame arena when called from a rendering thread
+    LFrameArena *arena { LFrameArena::current() };
+    LFrameArena::Marker marker { arena };
+
+    if (n > 8)
     {
-        pixman_region32_union_rect(
-            &tmp,
-            &tmp,
-            floor(float(rects->x1) * xFactor),
-            floor(float(rects->y1) * yFactor),
-            ceil(float(rects->x2 - rects->x1) * xFactor),
-            ceil(float(rects->y2 - rects->y1) * yFactor));
-        rects++;
+        mapped = arena ? arena->allocate<LBox>(n) : nullptr;
+
+        if (!mapped)
+        {
+            heapBoxes.resize(n);
+            mapped = heapBoxes.data();
+        }
     }
 
-    pixman_region32_fini(&m_region);
-    m_region = tmp;
+    for (Int32 i = 0; i < n; i++)
+        mapped[i] = func(boxes[i]);
+
+    dst->clear();
+    dst->addBoxes(mapped, n);
+}
+
+static LBox halfBox(const LBox &b) noexcept
+{
+    const Int32 x { b.x1 >> 1 }, y { b.y1 >> 1 };
+    return { x, y, x + ((b.x2 - b.x1) >> 1), y + ((b.y2 - b.y1) >> 1) };
+}
+
+static LBox doubleBox(const LBox &b) noexcept
+{
+    return { b.x1 << 1, b.y1 << 1, b.x2 << 1, b.y2 << 1 };
+}
+
+static LBox scaledBox(const LBox &b, Float32 xFactor, Float32 yFactor) noexcept
+{
+    const Int32 x ( floorf(Float32(b.x1) * xFactor) );
+    const Int32 y ( floorf(Float32(b.y1) * yFactor) );
+    return { x, y,
+             x + Int32(ceilf(Float32(b.x2 - b.x1) * xFactor)),
+             y + Int32(ceilf(Float32(b.y2 - b.y1) * yFactor)) };
+}
+
+void LRegion::multiply(Float32 factor) noexcept
+{
+    if (factor == 1.f)
+        return;
+
+    if (factor == 0.5f)
+        mapBoxes(this, this, halfBox);
+    else if (factor == 2.f)
+        mapBoxes(this, this, doubleBox);
+    else
+        mapBoxes(this, this, [factor](const LBox &b) { return scaledBox(b, factor, factor); });
+}
+
+void LRegion::multiply(Float32 xFactor, Float32 yFactor) noexcept
+{
+    if (xFactor == 1.f && yFactor == 1.f)
+        return;
+
+    mapBoxes(this, this, [xFactor, yFactor](const LBox &b) { return scaledBox(b, xFactor, yFactor); });
 }
 
 void LRegion::transform(const LSize &size, LTransform transform) noexcept
 {
-    pixman_region32_intersect_rect(&m_region, &m_region, 0, 0, size.w(), size.h());
+    clip(0, 0, size.w(), size.h());
 
-    LBox *boxes;
-    Int32 n, i;
-    pixman_region32_t tmp;
+    const Int32 w { size.w() }, h { size.h() };
 
     switch (transform)
     {
     case LTransform::Normal:
         return;
     case LTransform::Flipped270:
-        pixman_region32_init(&tmp);
-        boxes = (LBox*)pixman_region32_rectangles(&m_region, &n);
-        for (i = 0; i < n; i++)
-        {
-            pixman_region32_union_rect(&tmp, &tmp,
-                                       size.h() - boxes->y2,
-                                       size.w() - boxes->x2,
-                                       boxes->y2 - boxes->y1,
-                                       boxes->x2 - boxes->x1);
-            boxes++;
-        }
+        mapBoxes(this, this, [w, h](const LBox &b) -> LBox { return { h - b.y2, w - b.x2, h - b.y1, w - b.x1 }; });
         break;
     case LTransform::Flipped90:
-        pixman_region32_init(&tmp);
-        boxes = (LBox*)pixman_region32_rectangles(&m_region, &n);
-        for (i = 0; i < n; i++)
-        {
-            pixman_region32_union_rect(&tmp, &tmp,
-                                       boxes->y1,
-                                       boxes->x1,
-                                       boxes->y2 - boxes->y1,
-                                       boxes->x2 - boxes->x1);
-            boxes++;
-        }
+        mapBoxes(this, this, [](const LBox &b) -> LBox { return { b.y1, b.x1, b.y2, b.x2 }; });
         break;
     case LTransform::Flipped180:
-        pixman_region32_init(&tmp);
-        boxes = (LBox*)pixman_region32_rectangles(&m_region, &n);
-        for (i = 0; i < n; i++)
-        {
-            pixman_region32_union_rect(&tmp, &tmp,
-                                       boxes->x1,
-                                       size.h() - boxes->y2,
-                                       boxes->x2 - boxes->x1,
-                                       boxes->y2 - boxes->y1);
-            boxes++;
-        }
+        mapBoxes(this, this, [h](const LBox &b) -> LBox { return { b.x1, h - b.y2, b.x2, h - b.y1 }; });
         break;
     case LTransform::Rotated180:
-        pixman_region32_init(&tmp);
-        boxes = (LBox*)pixman_region32_rectangles(&m_region, &n);
-        for (i = 0; i < n; i++)
-        {
-            pixman_region32_union_rect(&tmp, &tmp,
-                                       size.w() - boxes->x2,
-                                       size.h() - boxes->y2,
-                                       boxes->x2 - boxes->x1,
-                                       boxes->y2 - boxes->y1);
-            boxes++;
-        }
+        mapBoxes(this, this, [w, h](const LBox &b) -> LBox { return { w - b.x2, h - b.y2, w - b.x1, h - b.y1 }; });
         break;
     case LTransform::Flipped:
-        pixman_region32_init(&tmp);
-        boxes = (LBox*)pixman_region32_rectangles(&m_region, &n);
-        for (i = 0; i < n; i++)
-        {
-            pixman_region32_union_rect(&tmp, &tmp,
-                                       size.w() - boxes->x2,
-                                       boxes->y1,
-                                       boxes->x2 - boxes->x1,
-                                       boxes->y2 - boxes->y1);
-            boxes++;
-        }
+        mapBoxes(this, this, [w](const LBox &b) -> LBox { return { w - b.x2, b.y1, w - b.x1, b.y2 }; });
         break;
     case LTransform::Rotated90:
-        pixman_region32_init(&tmp);
-        boxes = (LBox*)pixman_region32_rectangles(&m_region, &n);
-        for (i = 0; i < n; i++)
-        {
-            pixman_region32_union_rect(&tmp, &tmp,
-                                       boxes->y1,
-                                       size.w() - boxes->x2,
-                                       boxes->y2 - boxes->y1,
-                                       boxes->x2 - boxes->x1);
-            boxes++;
-        }
+        mapBoxes(this, this, [w](const LBox &b) -> LBox { return { b.y1, w - b.x2, b.y2, w - b.x1 }; });
         break;
     case LTransform::Rotated270:
-        pixman_region32_init(&tmp);
-        boxes = (LBox*)pixman_region32_rectangles(&m_region, &n);
-        for (i = 0; i < n; i++)
-        {
-            pixman_region32_union_rect(&tmp, &tmp,
-                                       size.h() - boxes->y2,
-                                       boxes->x1,
-                                       boxes->y2 - boxes->y1,
-                                       boxes->x2 - boxes->x1);
-            boxes++;
-        }
+        mapBoxes(this, this, [h](const LBox &b) -> LBox { return { h - b.y2, b.x1, h - b.y1, b.x2 }; });
         break;
     default:
         return;
     }
-
-    pixman_region32_fini(&m_region);
-    m_region = tmp;
 }
 
 LPointF LRegion::closestPointFrom(const LPointF &point, Float32 margin) const noexcept
@@ -267,51 +726,10 @@ void LRegion::multiply(LRegion *dst, LRegion *src, Float32 factor) noexcept
         return;
     }
 
-    pixman_region32_clear(&dst->m_region);
-
-    int n;
-    const pixman_box32_t *rects { pixman_region32_rectangles(&src->m_region, &n) };
-
     if (factor == 0.5f)
-    {
-        for (int i = 0; i < n; i++)
-        {
-            pixman_region32_union_rect(
-                &dst->m_region,
-                &dst->m_region,
-                rects->x1 >> 1,
-                rects->y1 >> 1,
-                (rects->x2 - rects->x1) >> 1,
-                (rects->y2 - rects->y1) >> 1);
-            rects++;
-        }
-    }
+        mapBoxes(dst, src, halfBox);
     else if (factor == 2.f)
-    {
-        for (int i = 0; i < n; i++)
-        {
-            pixman_region32_union_rect(
-                &dst->m_region,
-                &dst->m_region,
-                rects->x1 << 1,
-                rects->y1 << 1,
-                (rects->x2 - rects->x1) << 1,
-                (rects->y2 - rects->y1) << 1);
-            rects++;
-        }
-    }
+        mapBoxes(dst, src, doubleBox);
     else
-    {
-        for (int i = 0; i < n; i++)
-        {
-            pixman_region32_union_rect(
-                &dst->m_region,
-                &dst->m_region,
-                floor(float(rects->x1) * factor),
-                floor(float(rects->y1) * factor),
-                ceil(float(rects->x2 - rects->x1) * factor),
-                ceil(float(rects->y2 - rects->y1) * factor));
-            rects++;
-        }
-    }
+        mapBoxes(dst, src, [factor](const LBox &b) { return scaledBox(b, factor, factor); });
 }
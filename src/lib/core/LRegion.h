@@ -6,13 +6,21 @@
 #include <LTransform.h>
 #include <pixman.h>
 
+/* Maximum number of boxes stored within the LRegion object before falling back to a Pixman region, 0 keeps
+ * every region in m_region. Inline storage increases sizeof(LRegion) and leaves m_region empty while a region
+ * is stored inline, which breaks the ABI and code using m_region directly, so it stays disabled until the next
+ * major version (where it is meant to be 8) */
+#define LREGION_INLINE_BOXES 0
+
 /**
  * @brief Collection of non-overlapping rectangles
  *
  * The LRegion class provides an efficient mechanism for creating sets of rectangles that do not overlap in their geometries.
  * It offers methods for performing operations such as additions, subtractions, intersections, and more on rectangles.
  * This class is extensively used by the library for tasks like calculating surface damage, defining opaque, translucent, and input regions, among others.
- * Internally, LRegion employs the algorithm and functions from the [Pixman](http://www.pixman.org/) library.
+ * Internally, LRegion employs the algorithm and functions from the [Pixman](http://www.pixman.org/) library.\n
+ * When @ref LREGION_INLINE_BOXES is greater than 0, regions of up to that many rectangles are stored within the object
+ * and operated without heap allocations, only larger results are stored in a Pixman region.
  */
 class Louvre::LRegion
 {
@@ -30,7 +38,8 @@ public:
      */
     LRegion(const LRect &rect) noexcept
     {
-        pixman_region32_init_rect(&m_region, rect.x(), rect.y(), rect.w(), rect.h());
+        pixman_region32_init(&m_region);
+        addRect(rect);
     }
 
     /**
@@ -49,7 +58,7 @@ public:
     LRegion(const LRegion &other) noexcept
     {
         pixman_region32_init(&m_region);
-        pixman_region32_copy(&m_region, &other.m_region);
+        *this = other;
     }
 
     /**
@@ -62,8 +71,8 @@ public:
      */
     LRegion(LRegion &&other) noexcept
     {
-        m_region = other.m_region;
-        pixman_region32_init(&other.m_region);
+        pixman_region32_init(&m_region);
+        *this = static_cast<LRegion&&>(other);
     }
 
     /**
@@ -72,12 +81,7 @@ public:
      * @param other The LRegion to assign from.
      * @return A reference to the modified LRegion.
      */
-    LRegion &operator=(const LRegion &other) noexcept
-    {
-        if (&other != this)
-            pixman_region32_copy(&m_region, &other.m_region);
-        return *this;
-    }
+    LRegion &operator=(const LRegion &other) noexcept;
 
     /**
      * @brief Move assignment operator.
@@ -88,23 +92,22 @@ public:
      * @param other The LRegion to move from.
      * @return A reference to this LRegion after the move.
      */
-    LRegion &operator=(LRegion &&other) noexcept
-    {
-        if (&other != this)
-        {
-            pixman_region32_fini(&m_region);
-            m_region = other.m_region;
-            pixman_region32_init(&other.m_region);
-        }
-        return *this;
-    }
+    LRegion &operator=(LRegion &&other) noexcept;
 
     /**
      * @brief Clears the LRegion, deleting all rectangles.
      */
     void clear() noexcept
     {
+#if LREGION_INLINE_BOXES > 0
+        if (m_n < 0)
+            pixman_region32_clear(&m_region);
+
+        m_n = 0;
+        m_extents = { 0, 0, 0, 0 };
+#else
         pixman_region32_clear(&m_region);
+#endif
     }
 
     /**
@@ -114,7 +117,7 @@ public:
      */
     void addRect(const LRect &rect) noexcept
     {
-        pixman_region32_union_rect(&m_region, &m_region, rect.x(), rect.y(), rect.w(), rect.h());
+        addRect(rect.x(), rect.y(), rect.w(), rect.h());
     }
 
     /**
@@ -125,7 +128,7 @@ public:
      */
     void addRect(const LPoint &pos, const LSize &size) noexcept
     {
-        pixman_region32_union_rect(&m_region, &m_region, pos.x(), pos.y(), size.w(), size.h());
+        addRect(pos.x(), pos.y(), size.w(), size.h());
     }
 
     /**
@@ -137,7 +140,7 @@ public:
      */
     void addRect(Int32 x, Int32 y, const LSize &size) noexcept
     {
-        pixman_region32_union_rect(&m_region, &m_region, x, y, size.w(), size.h());
+        addRect(x, y, size.w(), size.h());
     }
 
     /**
@@ -149,7 +152,7 @@ public:
      */
     void addRect(const LPoint &pos, Int32 w, Int32 h) noexcept
     {
-        pixman_region32_union_rect(&m_region, &m_region, pos.x(), pos.y(), w, h);
+        addRect(pos.x(), pos.y(), w, h);
     }
 
     /**
@@ -162,7 +165,8 @@ public:
      */
     void addRect(Int32 x, Int32 y, Int32 w, Int32 h) noexcept
     {
-        pixman_region32_union_rect(&m_region, &m_region, x, y, w, h);
+        if (w > 0 && h > 0)
+            boxOp(Union, { x, y, x + w, y + h });
     }
 
     /**
@@ -173,9 +177,21 @@ public:
     void addRegion(const LRegion &region) noexcept
     {
         if (&region != this)
-            pixman_region32_union(&m_region, &m_region, &region.m_region);
+            regionOp(Union, this, this, &region);
     }
 
+    /**
+     * @brief Adds multiple boxes to the LRegion (union operation).
+     *
+     * Equivalent to calling addRect() for each box, but the region is constructed only once,
+     * which is much faster when adding many rectangles.\n
+     * The boxes can be in any order and overlap each other, empty boxes are ignored.
+     *
+     * @param boxes Array of boxes to add.
+     * @param n The number of boxes.
+     */
+    void addBoxes(const LBox *boxes, Int32 n) noexcept;
+
     /**
      * @brief Subtracts a rectangle from the LRegion.
      *
@@ -183,10 +199,7 @@ public:
      */
     void subtractRect(const LRect &rect) noexcept
     {
-        pixman_region32_t tmp;
-        pixman_region32_init_rect(&tmp, rect.x(), rect.y(), rect.w(), rect.h());
-        pixman_region32_subtract(&m_region, &m_region, &tmp);
-        pixman_region32_fini(&tmp);        
+        subtractRect(rect.x(), rect.y(), rect.w(), rect.h());
     }
 
     /**
@@ -197,10 +210,7 @@ public:
      */
     void subtractRect(const LPoint &pos, const LSize &size) noexcept
     {
-        pixman_region32_t tmp;
-        pixman_region32_init_rect(&tmp, pos.x(), pos.y(), size.w(), size.h());
-        pixman_region32_subtract(&m_region, &m_region, &tmp);
-        pixman_region32_fini(&tmp);
+        subtractRect(pos.x(), pos.y(), size.w(), size.h());
     }
 
     /**
@@ -212,10 +222,7 @@ public:
      */
     void subtractRect(const LPoint &pos, Int32 w, Int32 h) noexcept
     {
-        pixman_region32_t tmp;
-        pixman_region32_init_rect(&tmp, pos.x(), pos.y(), w, h);
-        pixman_region32_subtract(&m_region, &m_region, &tmp);
-        pixman_region32_fini(&tmp);
+        subtractRect(pos.x(), pos.y(), w, h);
     }
 
     /**
@@ -227,10 +234,7 @@ public:
      */
     void subtractRect(Int32 x, Int32 y, const LSize &size) noexcept
     {
-        pixman_region32_t tmp;
-        pixman_region32_init_rect(&tmp, x, y, size.w(), size.h());
-        pixman_region32_subtract(&m_region, &m_region, &tmp);
-        pixman_region32_fini(&tmp);
+        subtractRect(x, y, size.w(), size.h());
     }
 
     /**
@@ -243,10 +247,8 @@ public:
      */
     void subtractRect(Int32 x, Int32 y, Int32 w, Int32 h) noexcept
     {
-        pixman_region32_t tmp;
-        pixman_region32_init_rect(&tmp, x, y, w, h);
-        pixman_region32_subtract(&m_region, &m_region, &tmp);
-        pixman_region32_fini(&tmp);
+        if (w > 0 && h > 0)
+            boxOp(Subtract, { x, y, x + w, y + h });
     }
 
     /**
@@ -256,7 +258,7 @@ public:
      */
     void subtractRegion(const LRegion &region) noexcept
     {
-        pixman_region32_subtract(&m_region, &m_region, &region.m_region);
+        regionOp(Subtract, this, this, &region);
     }
 
     /**
@@ -267,7 +269,7 @@ public:
     void intersectRegion(const LRegion &region) noexcept
     {
         if (&region != this)
-            pixman_region32_intersect(&m_region, &m_region, &region.m_region);
+            regionOp(Intersect, this, this, &region);
     }
 
     /**
@@ -291,10 +293,7 @@ public:
      * @param point The point to check.
      * @return true if the region contains the point, false otherwise.
      */
-    bool containsPoint(const LPoint &point) const noexcept
-    {
-        return pixman_region32_contains_point(&m_region, point.x(), point.y(), NULL);
-    }
+    bool containsPoint(const LPoint &point) const noexcept;
 
     /**
      * @brief Translate each rectangle in the LRegion by the specified offset.
@@ -303,10 +302,7 @@ public:
      */
     void offset(const LPoint &offset) noexcept
     {
-        if (offset.x() == 0 && offset.y() == 0)
-            return;
-
-        pixman_region32_translate(&m_region, offset.x(), offset.y());
+        this->offset(offset.x(), offset.y());
     }
 
     /**
@@ -315,30 +311,14 @@ public:
      * @param x The x offset to apply.
      * @param y The y offset to apply.
      */
-    void offset(Int32 x, Int32 y) noexcept
-    {
-        if (x == 0 && y == 0)
-            return;
-
-        pixman_region32_translate(&m_region, x, y);
-    }
+    void offset(Int32 x, Int32 y) noexcept;
 
     /**
      * @brief Invert the region contained within the specified rectangle.
      *
      * @param rect The rectangle to define the area of inversion.
      */
-    void inverse(const LRect &rect) noexcept
-    {
-        pixman_box32_t r {
-            rect.x(),
-            rect.y(),
-            rect.x() + rect.w(),
-            rect.y() + rect.h()
-        };
-
-        pixman_region32_inverse(&m_region, &m_region, &r);
-    }
+    void inverse(const LRect &rect) noexcept;
 
     /**
      * @brief Check if the LRegion is empty (contains no rectangles).
@@ -347,6 +327,11 @@ public:
      */
     bool empty() const noexcept
     {
+#if LREGION_INLINE_BOXES > 0
+        if (m_n >= 0)
+            return m_n == 0;
+#endif
+
         return !pixman_region32_not_empty(&m_region);
     }
 
@@ -357,7 +342,7 @@ public:
      */
     void clip(const LRect &rect) noexcept
     {
-        pixman_region32_intersect_rect(&m_region, &m_region, rect.x(), rect.y(), rect.w(), rect.h());
+        clip(rect.x(), rect.y(), rect.w(), rect.h());
     }
 
     /**
@@ -365,7 +350,7 @@ public:
      */
     void clip(const LPoint &pos, const LSize &size) noexcept
     {
-        pixman_region32_intersect_rect(&m_region, &m_region, pos.x(), pos.y(), size.w(), size.h());
+        clip(pos.x(), pos.y(), size.w(), size.h());
     }
 
     /**
@@ -373,7 +358,10 @@ public:
      */
     void clip(Int32 x, Int32 y, Int32 w, Int32 h) noexcept
     {
-        pixman_region32_intersect_rect(&m_region, &m_region, x, y, w, h);
+        if (w > 0 && h > 0)
+            boxOp(Intersect, { x, y, x + w, y + h });
+        else
+            clear();
     }
 
     /**
@@ -386,6 +374,11 @@ public:
      */
     const LBox &extents() const noexcept
     {
+#if LREGION_INLINE_BOXES > 0
+        if (m_n >= 0)
+            return m_extents;
+#endif
+
         return *(LBox*)pixman_region32_extents(&m_region);
     }
 
@@ -395,10 +388,18 @@ public:
      * @param n A pointer to an integer that will be set to the number of rectangles.
      * @return A pointer to an array of LBox objects representing the rectangles.
      *
-     * @note This variant allows you to access the rectangles using the native Pixman method, which is considerably faster.
+     * @note The rectangles are sorted in Pixman's y-x banded order.
      */
     const LBox *boxes(Int32 *n) const noexcept
     {
+#if LREGION_INLINE_BOXES > 0
+        if (m_n >= 0)
+        {
+            *n = m_n;
+            return m_boxes;
+        }
+#endif
+
         return (LBox*)pixman_region32_rectangles(&m_region, n);
     }
 
@@ -453,7 +454,55 @@ public:
     }
 
     static void multiply(LRegion *dst, LRegion *src, Float32 factor) noexcept;
+
+    /**
+     * @brief Stores the intersection of two regions in dst.
+     *
+     * Any of the regions can be the same.
+     */
+    static void intersect(LRegion *dst, const LRegion *a, const LRegion *b) noexcept;
+
+    /**
+     * @brief Stores region a minus region b in dst.
+     *
+     * Any of the regions can be the same.
+     */
+    static void subtract(LRegion *dst, const LRegion *a, const LRegion *b) noexcept;
+
+    /**
+     * @brief Access to the region as a Pixman region.
+     *
+     * Converts the inline rectangles if needed, the returned region can be modified with Pixman functions
+     * and remains valid until the next LRegion method call.
+     */
+    pixman_region32_t *pixmanRegion() const noexcept;
+
+    // When LREGION_INLINE_BOXES > 0, it's an empty region without heap data while the region is stored inline, see pixmanRegion()
     mutable pixman_region32_t m_region;
+
+private:
+    enum Op
+    {
+        Union,
+        Intersect,
+        Subtract
+    };
+
+    void boxOp(Op op, const LBox &box) noexcept;
+    static void regionOp(Op op, LRegion *dst, const LRegion *a, const LRegion *b) noexcept;
+
+    // Moves the Pixman region rectangles to the inline storage if they fit
+    void compact() noexcept;
+
+#if LREGION_INLINE_BOXES > 0
+    static bool inlineOp(Op op, const LBox *a, Int32 na, const LBox *b, Int32 nb, LBox *dst, Int32 *n) noexcept;
+    void setInline(const LBox *boxes, Int32 n) noexcept;
+
+    // Number of inline boxes or -1 if stored in m_region
+    mutable Int32 m_n { 0 };
+    LBox m_extents { 0, 0, 0, 0 };
+    LBox m_boxes[LREGION_INLINE_BOXES];
+#endif
 };
 
 #endif // LREGION_H
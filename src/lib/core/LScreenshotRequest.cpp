@@ -54,11 +54,29 @@ Int8 LScreenshotRequest::copy() noexcept
             damage.addRect(resource().rectB());
         }
 
+        const GLenum format { static_cast<GLenum>(resource().output()->painter()->imp()->openGLExtensions.EXT_read_format_bgra ? GL_BGRA : GL_RGBA) };
+        const Int32 screenH { resource().output()->currentMode()->sizeB().h() };
+        LScreenshotReadback &readback { resource().output()->imp()->screenshotReadback };
+
+        // Copied into the client buffer and ready() sent in a later frame
+        if (readback.available() && readback.read(this, resource().rectB(), screenH, format))
+        {
+            GLint currentFramebuffer { 0 };
+            glGetIntegerv(GL_FRAMEBUFFER_BINDING, &currentFramebuffer);
+            resource().flags(currentFramebuffer == 0 ? ZWLR_SCREENCOPY_FRAME_V1_FLAGS_Y_INVERT : 0);
+
+            if (resource().waitForDamage())
+            {
+                damage.offset(-resource().rectB().x(), -resource().rectB().y());
+                resource().damage(damage);
+            }
+
+            return 1;
+        }
+
         wl_shm_buffer *shm_buffer = wl_shm_buffer_get(resource().buffer());
         wl_shm_buffer_begin_access(shm_buffer);
         UInt8 *pixels { static_cast<UInt8*>(wl_shm_buffer_get_data(shm_buffer)) };
-        const GLenum format { static_cast<GLenum>(resource().output()->painter()->imp()->openGLExtensions.EXT_read_format_bgra ? GL_BGRA : GL_RGBA) };
-        const Int32 screenH { resource().output()->currentMode()->sizeB().h() };
         glPixelStorei(GL_PACK_ALIGNMENT, 4);
         glPixelStorei(GL_PACK_ROW_LENGTH, wl_shm_buffer_get_width(shm_buffer));
         glPixelStorei(GL_PACK_SKIP_PIXELS, 0);
@@ -81,52 +99,10 @@ Int8 LScreenshotRequest::copy() noexcept
     else // DMA buffer
     {
         LDMABuffer *dmaBuffer { static_cast<LDMABuffer*>(wl_resource_get_user_data(resource().buffer())) };
-        UInt32 i { 0 };
-        EGLAttrib attribs[19];
-        attribs[i++] = EGL_WIDTH;
-        attribs[i++] = dmaBuffer->planes()->width;
-        attribs[i++] = EGL_HEIGHT;
-        attribs[i++] = dmaBuffer->planes()->height;
-        attribs[i++] = EGL_LINUX_DRM_FOURCC_EXT;
-        attribs[i++] = dmaBuffer->planes()->format;
-        attribs[i++] = EGL_DMA_BUF_PLANE0_FD_EXT;
-        attribs[i++] = dmaBuffer->planes()->fds[0];
-        attribs[i++] = EGL_DMA_BUF_PLANE0_OFFSET_EXT;
-        attribs[i++] = dmaBuffer->planes()->offsets[0];
-        attribs[i++] = EGL_DMA_BUF_PLANE0_PITCH_EXT;
-        attribs[i++] = dmaBuffer->planes()->strides[0];
-        attribs[i++] = EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT;
-        attribs[i++] = dmaBuffer->planes()->modifiers[0] & 0xFFFFFFFF;
-        attribs[i++] = EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT;
-        attribs[i++] = dmaBuffer->planes()->modifiers[0] >> 32;
-        attribs[i++] = EGL_IMAGE_PRESERVED_KHR;
-        attribs[i++] = EGL_TRUE;
-        attribs[i++] = EGL_NONE;
-
-        EGLImage image { eglCreateImage(compositor()->eglDisplay(), EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, NULL, attribs) };
-
-        if (image == EGL_NO_IMAGE)
-        {
-            resource().failed();
-            return -1;
-        }
-
-        GLuint rb, fb;
-        glGenRenderbuffers(1, &rb);
-        glBindRenderbuffer(GL_RENDERBUFFER, rb);
-        compositor()->imp()->glEGLImageTargetRenderbufferStorageOES(GL_RENDERBUFFER, image);
-        glBindRenderbuffer(GL_RENDERBUFFER, 0);
-
-        glGenFramebuffers(1, &fb);
-        glBindFramebuffer(GL_FRAMEBUFFER, fb);
-        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, rb);
-        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        auto *target { resource().output()->imp()->screenshotDMATarget(dmaBuffer) };
 
-        if (status != GL_FRAMEBUFFER_COMPLETE)
+        if (!target)
         {
-            glDeleteFramebuffers(1, &fb);
-            glDeleteRenderbuffers(1, &rb);
-            eglDestroyImage(compositor()->eglDisplay(), image);
             resource().failed();
             return -1;
         }
@@ -138,12 +114,7 @@ Int8 LScreenshotRequest::copy() noexcept
 
             // No damage, wait...
             if (resource().waitForDamage() && outputDamage.damage.empty())
-            {
-                glDeleteFramebuffers(1, &fb);
-                glDeleteRenderbuffers(1, &rb);
-                eglDestroyImage(compositor()->eglDisplay(), image);
                 return 0;
-            }
 
             damage = std::move(outputDamage.damage);
         }
@@ -154,7 +125,7 @@ Int8 LScreenshotRequest::copy() noexcept
         }
 
         LFramebufferWrapper glFb(
-            fb,
+            target->framebuffer,
             LSize((Int32)dmaBuffer->planes()->width, (Int32)dmaBuffer->planes()->height),
             resource().rectB().pos());
 
@@ -178,9 +149,6 @@ Int8 LScreenshotRequest::copy() noexcept
         p.drawRect(resource().rectB());
         /* TODO: glFinish(); */
         p.bindFramebuffer(prevFb);
-        glDeleteFramebuffers(1, &fb);
-        glDeleteRenderbuffers(1, &rb);
-        eglDestroyImage(compositor()->eglDisplay(), image);
         resource().flags(0);
     }
 
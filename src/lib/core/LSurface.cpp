@@ -47,6 +47,9 @@ LSurface::~LSurface()
         delete imp()->texture;
 
     delete imp()->textureBackup;
+
+    if (imp()->textureUploadTarget)
+        delete imp()->textureUploadTarget;
 }
 
 LCursorRole *LSurface::cursorRole() const noexcept
@@ -113,22 +116,26 @@ LBaseSurfaceRole *LSurface::role() const noexcept
 void LSurface::setPos(const LPoint &newPos) noexcept
 {
     imp()->pos = newPos;
+    imp()->posChanged();
 }
 
 void LSurface::setPos(Int32 x, Int32 y) noexcept
 {
     imp()->pos.setX(x);
     imp()->pos.setY(y);
+    imp()->posChanged();
 }
 
 void LSurface::setX(Int32 x) noexcept
 {
     imp()->pos.setX(x);
+    imp()->posChanged();
 }
 
 void LSurface::setY(Int32 y) noexcept
 {
     imp()->pos.setY(y);
+    imp()->posChanged();
 }
 
 const LSize &LSurface::sizeB() const noexcept
@@ -229,6 +236,14 @@ LTexture *LSurface::texture() const noexcept
     return imp()->texture;
 }
 
+const LRGBAF *LSurface::solidColor() const noexcept
+{
+    if (imp()->stateFlags.check(LSurfacePrivate::SolidColor))
+        return &imp()->solidColor;
+
+    return nullptr;
+}
+
 bool LSurface::hasDamage() const noexcept
 {
     return imp()->stateFlags.check(LSurfacePrivate::Damaged);
@@ -404,7 +419,8 @@ const std::vector<LOutput *> &LSurface::outputs() const noexcept
 
 void LSurface::requestNextFrame(bool clearDamage) noexcept
 {
-    if (imp()->stateFlags.check(LSurfacePrivate::Destroyed))
+    // The last commit is not on screen until its SHM copy finishes, see finishTextureUpload()
+    if (imp()->stateFlags.check(LSurfacePrivate::Destroyed) || imp()->textureUpload)
         return;
 
     for (auto *presentation : imp()->presentationFeedbackResources)
@@ -395,6 +395,18 @@ public:
      */
     LTexture *texture() const noexcept;
 
+    /**
+     * @brief Solid color of single pixel buffers
+     *
+     * Clients using the [single pixel buffer](https://wayland.app/protocols/single-pixel-buffer-v1) protocol attach 1x1 buffers
+     * to fill the whole surface with a color, commonly for backgrounds and letterboxing.\n
+     * If the current buffer is one of them, returns its color with non-premultiplied alpha. The texture() still contains the pixel,
+     * but drawing the color directly (as LSurfaceView does) avoids sampling it. The surface is considered opaque when the alpha is 1.
+     *
+     * @return The color or `nullptr` if the current buffer is not a single pixel buffer.
+     */
+    const LRGBAF *solidColor() const noexcept;
+
     /**
      * @brief Native [wl_buffer](https://wayland.app/protocols/wayland#wl_buffer) handle
      *
@@ -435,7 +447,8 @@ public:
      * @brief ACK the frame callback
      *
      * Notifies the surface that it's time for it to draw its next frame.\n
-     * If not called, the given surface should not update its content.
+     * If not called, the given surface should not update its content.\n
+     * Does nothing while the last committed SHM buffer is still being copied into the surface texture.
      *
      * @warning This method clears the current damage region of the surface.
      */
@@ -732,7 +745,8 @@ public:
     /**
      * @brief Notifies about new damages on the surface
      *
-     * Reimplement this virtual method if you want to be notified when the surface has new damage.
+     * Reimplement this virtual method if you want to be notified when the surface has new damage.\n
+     * If the SHM buffer is copied asynchronously, it is triggered once the copy finishes, after the commit.
      *
      * #### Default Implementation
      * @snippet LSurfaceDefault.cpp damageChanged
@@ -276,6 +276,9 @@ LTexture *LTexture::copy(const LSize &dst, const LRect &src, bool highQualitySca
     }
 
     GLuint textureId { id(painter->imp()->output) };
+
+    // Reused across copies, textures are detached before returning
+    const GLuint scratchFramebuffer { compositor()->imp()->threadsMap[std::this_thread::get_id()].renderTargetPool.scratchFramebuffer() };
     LTexture *textureCopy { nullptr };
     bool ret = false;
 
@@ -319,9 +322,7 @@ LTexture *LTexture::copy(const LSize &dst, const LRect &src, bool highQualitySca
         Float32 pixSizeW = wScaleF / Float32(sizeB().w() * wScale);
         Float32 pixSizeH = hScaleF / Float32(sizeB().h() * hScale);
 
-        GLuint framebuffer;
-        glGenFramebuffers(1, &framebuffer);
-        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, scratchFramebuffer);
         GLuint texCopy;
         glGenTextures(1, &texCopy);
         LTexture::LTexturePrivate::setTextureParams(texCopy, GL_TEXTURE_2D, GL_REPEAT, GL_REPEAT, GL_LINEAR, GL_LINEAR);
@@ -331,7 +332,7 @@ LTexture *LTexture::copy(const LSize &dst, const LRect &src, bool highQualitySca
         if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         {
             glDeleteTextures(1, &texCopy);
-            glDeleteFramebuffers(1, &framebuffer);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
             glUseProgram(prevProgram);
             LLog::error("[LTexture::copyB] glCheckFramebufferStatus failed. Skipping highQualityScaling.");
             goto skipHQ;
@@ -373,7 +374,7 @@ LTexture *LTexture::copy(const LSize &dst, const LRect &src, bool highQualitySca
         glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
         textureCopy = new LTexture(premultipliedAlpha());
         ret = textureCopy->setDataFromGL(texCopy, GL_TEXTURE_2D, DRM_FORMAT_ABGR8888, dstSize, true);
-        glDeleteFramebuffers(1, &framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
         glUseProgram(prevProgram);
 
         if (ret)
@@ -402,14 +403,12 @@ LTexture *LTexture::copy(const LSize &dst, const LRect &src, bool highQualitySca
             srcRect.y() >= 0 &&
             srcRect.y() + srcRect.h() <= sizeB().h())
         {
-            GLuint framebuffer;
-            glGenFramebuffers(1, &framebuffer);
-            glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+            glBindFramebuffer(GL_FRAMEBUFFER, scratchFramebuffer);
             glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureId, 0);
 
             if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
             {
-                glDeleteFramebuffers(1, &framebuffer);
+                glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
                 LLog::error("[LTexture::copyB] glCheckFramebufferStatus failed. Skipping glCopyTexImage2D method.");
                 goto skipAll;
             }
@@ -422,15 +421,13 @@ LTexture *LTexture::copy(const LSize &dst, const LRect &src, bool highQualitySca
             glCopyTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, srcRect.x(), srcRect.y(), srcRect.w(), srcRect.h(), 0);
             textureCopy = new LTexture(premultipliedAlpha());
             ret = textureCopy->setDataFromGL(texCopy, GL_TEXTURE_2D, DRM_FORMAT_ABGR8888, dstSize, true);
-            glDeleteFramebuffers(1, &framebuffer);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
         }
         // Scaled draw to new texture fb
         else
         {
             LFramebuffer *prevFb { painter->boundFramebuffer() };
-            GLuint framebuffer;
-            glGenFramebuffers(1, &framebuffer);
-            glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+            glBindFramebuffer(GL_FRAMEBUFFER, scratchFramebuffer);
             GLuint texCopy;
             glGenTextures(1, &texCopy);
             LTexture::LTexturePrivate::setTextureParams(texCopy, GL_TEXTURE_2D,
@@ -442,12 +439,12 @@ LTexture *LTexture::copy(const LSize &dst, const LRect &src, bool highQualitySca
             if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
             {
                 glDeleteTextures(1, &texCopy);
-                glDeleteFramebuffers(1, &framebuffer);
+                glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
                 LLog::error("[LTexture::copyB] glCheckFramebufferStatus failed. Skipping lowQualityScaling method.");
                 goto skipAll;
             }
 
-            LFramebufferWrapper wrapperFb(framebuffer, dstSize);
+            LFramebufferWrapper wrapperFb(scratchFramebuffer, dstSize);
             painter->bindFramebuffer(&wrapperFb);
             painter->enableCustomTextureColor(false);
             painter->enableAutoBlendFunc(true);
@@ -466,7 +463,8 @@ LTexture *LTexture::copy(const LSize &dst, const LRect &src, bool highQualitySca
             glEnable(GL_BLEND);
             textureCopy = new LTexture(premultipliedAlpha());
             ret = textureCopy->setDataFromGL(texCopy, GL_TEXTURE_2D, DRM_FORMAT_ABGR8888, dstSize, true);
-            glDeleteFramebuffers(1, &framebuffer);
+            glBindFramebuffer(GL_FRAMEBUFFER, scratchFramebuffer);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
             painter->bindFramebuffer(prevFb);
             // New texture copy (highQualityScaling = false)
         }
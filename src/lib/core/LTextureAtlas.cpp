@@ -0,0 +1,311 @@
+#include <LTextureAtlas.h>
+#include <LLog.h>
+#include <algorithm>
+#include <cstring>
+
+using namespace Louvre;
+
+// Border around each entry replicating its edges
+#define LTEXTUREATLAS_BORDER 1
+
+LTextureAtlas::Entry::Entry(LTextureAtlas *atlas, const LSize &sizeB) noexcept :
+    m_atlas(atlas),
+    m_rectB(0, 0, sizeB.w(), sizeB.h()),
+    m_pixels(std::size_t(sizeB.area()) * 4)
+{}
+
+LTextureAtlas::LTextureAtlas(const LSize &pageSizeB, UInt32 format, bool premultipliedAlpha) noexcept :
+    m_pageSizeB(pageSizeB),
+    m_format(format),
+    m_premultipliedAlpha(premultipliedAlpha)
+{
+    if (LTexture::formatBytesPerPixel(format) != 4)
+        LLog::error("[LTextureAtlas::LTextureAtlas] Unsupported format, only formats with 4 bytes per pixel can be used.");
+}
+
+LTextureAtlas::~LTextureAtlas() noexcept
+{
+    notifyDestruction();
+
+    while (!m_entries.empty())
+    {
+        delete m_entries.back();
+        m_entries.pop_back();
+    }
+
+    while (!m_pages.empty())
+    {
+        delete m_pages.back();
+        m_pages.pop_back();
+    }
+}
+
+LTextureAtlas::Entry *LTextureAtlas::add(const LSize &sizeB, UInt32 stride, const void *buffer) noexcept
+{
+    if (LTexture::formatBytesPerPixel(m_format) != 4 || sizeB.w() <= 0 || sizeB.h() <= 0 || !buffer)
+        return nullptr;
+
+    if (sizeB.w() + 2 * LTEXTUREATLAS_BORDER > m_pageSizeB.w() || sizeB.h() + 2 * LTEXTUREATLAS_BORDER > m_pageSizeB.h())
+        return nullptr;
+
+    Entry *entry { new Entry(this, sizeB) };
+    const std::size_t rowSize { std::size_t(sizeB.w()) * 4 };
+
+    for (Int32 y = 0; y < sizeB.h(); y++)
+        memcpy(&entry->m_pixels[y * rowSize], static_cast<const UInt8*>(buffer) + std::size_t(y) * stride, rowSize);
+
+    if (!place(entry))
+    {
+        delete entry;
+        return nullptr;
+    }
+
+    m_entries.push_back(entry);
+
+    if (!upload(entry))
+    {
+        LLog::error("[LTextureAtlas::add] Failed to upload entry.");
+        remove(entry);
+        return nullptr;
+    }
+
+    return entry;
+}
+
+bool LTextureAtlas::update(Entry *entry, UInt32 stride, const void *buffer) noexcept
+{
+    if (!entry || entry->m_atlas != this || !buffer)
+        return false;
+
+    const std::size_t rowSize { std::size_t(entry->m_rectB.w()) * 4 };
+
+    for (Int32 y = 0; y < entry->m_rectB.h(); y++)
+        memcpy(&entry->m_pixels[y * rowSize], static_cast<const UInt8*>(buffer) + std::size_t(y) * stride, rowSize);
+
+    return upload(entry);
+}
+
+void LTextureAtlas::remove(Entry *entry) noexcept
+{
+    if (!entry || entry->m_atlas != this)
+        return;
+
+    auto it { std::find(m_entries.begin(), m_entries.end(), entry) };
+
+    if (it == m_entries.end())
+        return;
+
+    m_entries.erase(it);
+
+    const size_t pageIndex { entry->m_page };
+    Page &page { m_pagesData[pageIndex] };
+    page.usedArea -= UInt64(entry->m_rectB.w() + 2 * LTEXTUREATLAS_BORDER) * UInt64(entry->m_rectB.h() + 2 * LTEXTUREATLAS_BORDER);
+    delete entry;
+
+    if (page.usedArea == 0)
+        removePage(pageIndex);
+}
+
+void LTextureAtlas::repack() noexcept
+{
+    if (m_entries.empty())
+    {
+        while (!m_pages.empty())
+            removePage(m_pages.size() - 1);
+
+        return;
+    }
+
+    for (Page &page : m_pagesData)
+    {
+        page.skyline = { { 0, 0, m_pageSizeB.w() } };
+        page.usedArea = 0;
+    }
+
+    // Tallest first leaves flatter skylines
+    std::vector<Entry*> sorted { m_entries };
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Entry *a, const Entry *b)
+    {
+        if (a->m_rectB.h() != b->m_rectB.h())
+            return a->m_rectB.h() > b->m_rectB.h();
+
+        return a->m_rectB.w() > b->m_rectB.w();
+    });
+
+    for (Entry *entry : sorted)
+        if (place(entry))
+            upload(entry);
+
+    for (size_t i = m_pages.size(); i > 0; i--)
+        if (m_pagesData[i - 1].usedArea == 0)
+            removePage(i - 1);
+}
+
+Float32 LTextureAtlas::usage() const noexcept
+{
+    if (m_pages.empty())
+        return 0.f;
+
+    UInt64 used { 0 };
+
+    for (const Page &page : m_pagesData)
+        used += page.usedArea;
+
+    return Float32(used) / (Float32(m_pageSizeB.area()) * Float32(m_pages.size()));
+}
+
+bool LTextureAtlas::place(Entry *entry) noexcept
+{
+    const LSize sizeB { entry->m_rectB.w() + 2 * LTEXTUREATLAS_BORDER, entry->m_rectB.h() + 2 * LTEXTUREATLAS_BORDER };
+    LPoint pos;
+    size_t index;
+    size_t pageIndex { 0 };
+
+    for (; pageIndex < m_pagesData.size(); pageIndex++)
+        if (findPosition(m_pagesData[pageIndex], sizeB, pos, index))
+            break;
+
+    if (pageIndex == m_pagesData.size())
+    {
+        if (!addPage() || !findPosition(m_pagesData.back(), sizeB, pos, index))
+            return false;
+    }
+
+    Page &page { m_pagesData[pageIndex] };
+    std::vector<Skyline> &sky { page.skyline };
+    sky.insert(sky.begin() + index, { pos.x(), pos.y() + sizeB.h(), sizeB.w() });
+
+    // Shrink or remove the segments now covered by the new one
+    for (size_t i = index + 1; i < sky.size();)
+    {
+        const Int32 prevEnd { sky[i - 1].x + sky[i - 1].w };
+
+        if (sky[i].x >= prevEnd)
+            break;
+
+        const Int32 shrink { prevEnd - sky[i].x };
+        sky[i].x += shrink;
+        sky[i].w -= shrink;
+
+        if (sky[i].w > 0)
+            break;
+
+        sky.erase(sky.begin() + i);
+    }
+
+    // Merge segments at the same height
+    for (size_t i = 0; i + 1 < sky.size();)
+    {
+        if (sky[i].y == sky[i + 1].y)
+        {
+            sky[i].w += sky[i + 1].w;
+            sky.erase(sky.begin() + i + 1);
+        }
+        else
+            i++;
+    }
+
+    page.usedArea += UInt64(sizeB.area());
+    entry->m_page = pageIndex;
+    entry->m_rectB.setPos(pos + LPoint(LTEXTUREATLAS_BORDER));
+    return true;
+}
+
+bool LTextureAtlas::findPosition(const Page &page, const LSize &sizeB, LPoint &pos, size_t &index) const noexcept
+{
+    Int32 bestY { m_pageSizeB.h() };
+    Int32 bestX { m_pageSizeB.w() };
+    bool found { false };
+
+    for (size_t i = 0; i < page.skyline.size(); i++)
+    {
+        const Int32 x { page.skyline[i].x };
+
+        if (x + sizeB.w() > m_pageSizeB.w())
+            break;
+
+        // Lowest position where the rect doesn't overlap the segments it spans
+        Int32 y { 0 };
+        Int32 widthLeft { sizeB.w() };
+
+        for (size_t j = i; j < page.skyline.size() && widthLeft > 0; j++)
+        {
+            y = std::max(y, page.skyline[j].y);
+            widthLeft -= page.skyline[j].w;
+        }
+
+        if (y + sizeB.h() > m_pageSizeB.h())
+            continue;
+
+        if (y < bestY || (y == bestY && x < bestX))
+        {
+            bestY = y;
+            bestX = x;
+            index = i;
+            found = true;
+        }
+    }
+
+    if (found)
+        pos = { bestX, bestY };
+
+    return found;
+}
+
+bool LTextureAtlas::addPage() noexcept
+{
+    LTexture *texture { new LTexture(m_premultipliedAlpha) };
+    const std::vector<UInt8> clear(std::size_t(m_pageSizeB.area()) * 4, 0);
+
+    if (!texture->setDataFromMainMemory(m_pageSizeB, m_pageSizeB.w() * 4, m_format, clear.data()))
+    {
+        LLog::error("[LTextureAtlas::addPage] Failed to create page texture.");
+        delete texture;
+        return false;
+    }
+
+    m_pages.push_back(texture);
+    m_pagesData.push_back({ { { 0, 0, m_pageSizeB.w() } }, 0 });
+    return true;
+}
+
+void LTextureAtlas::removePage(size_t index) noexcept
+{
+    delete m_pages[index];
+    m_pages.erase(m_pages.begin() + index);
+    m_pagesData.erase(m_pagesData.begin() + index);
+
+    for (Entry *entry : m_entries)
+        if (entry->m_page > index)
+            entry->m_page--;
+}
+
+bool LTextureAtlas::upload(Entry *entry) noexcept
+{
+    const Int32 w { entry->m_rectB.w() };
+    const Int32 h { entry->m_rectB.h() };
+    const Int32 paddedW { w + 2 * LTEXTUREATLAS_BORDER };
+    const Int32 paddedH { h + 2 * LTEXTUREATLAS_BORDER };
+    std::vector<UInt32> padded(std::size_t(paddedW) * std::size_t(paddedH));
+    const UInt32 *src { reinterpret_cast<const UInt32*>(entry->m_pixels.data()) };
+
+    // Edges are replicated into the border
+    for (Int32 y = 0; y < paddedH; y++)
+    {
+        const UInt32 *srcRow { src + std::size_t(std::clamp(y - LTEXTUREATLAS_BORDER, 0, h - 1)) * w };
+        UInt32 *dstRow { &padded[std::size_t(y) * paddedW] };
+
+        for (Int32 x = 0; x < LTEXTUREATLAS_BORDER; x++)
+        {
+            dstRow[x] = srcRow[0];
+            dstRow[paddedW - 1 - x] = srcRow[w - 1];
+        }
+
+        memcpy(dstRow + LTEXTUREATLAS_BORDER, srcRow, std::size_t(w) * 4);
+    }
+
+    return entry->texture()->updateRect(
+        LRect(entry->m_rectB.pos() - LPoint(LTEXTUREATLAS_BORDER), LSize(paddedW, paddedH)),
+        paddedW * 4,
+        padded.data());
+}
@@ -0,0 +1,204 @@
+#ifndef LTEXTUREATLAS_H
+#define LTEXTUREATLAS_H
+
+#include <LObject.h>
+#include <LTexture.h>
+#include <LRect.h>
+#include <vector>
+#include <memory>
+
+namespace Louvre
+{
+    /**
+     * @brief Packs small textures into shared pages
+     *
+     * UI elements such as icons, buttons or text labels are usually drawn from many tiny textures, each with
+     * its own OpenGL texture object, memory overhead and bind. An LTextureAtlas packs them into a few larger
+     * textures (pages) instead, so consecutive draws of its entries sample the same texture.
+     *
+     * Each entry is added from a main memory buffer with add() and drawn with LTextureView::setTexture(Entry*),
+     * or by LPainter using the page texture and LPainter::TextureParams::subRectB.
+     * Entries are surrounded by a 1px border replicating their edges, so linear filtering never samples
+     * neighbouring entries.
+     *
+     * Pages are filled using skyline packing. Space released by remove() is only reused once the whole page
+     * is empty, call repack() after removing many entries to compact them into fewer pages.
+     *
+     * @note A copy of the pixels of each entry is kept in main memory to allow repacking.
+     */
+    class LTextureAtlas final : public LObject
+    {
+    public:
+        class Entry;
+
+        /**
+         * @brief Constructor.
+         *
+         * @param pageSizeB Size of each page in buffer coordinates. Entries larger than it (including the border) can't be added.
+         * @param format DRM format of the pages and entries, must use 4 bytes per pixel, for example `DRM_FORMAT_ARGB8888`.
+         * @param premultipliedAlpha Whether the pixels of the entries have premultiplied alpha.
+         */
+        LTextureAtlas(const LSize &pageSizeB = LSize(1024, 1024), UInt32 format = DRM_FORMAT_ARGB8888, bool premultipliedAlpha = false) noexcept;
+
+        LCLASS_NO_COPY(LTextureAtlas)
+
+        /**
+         * @brief Destructor.
+         *
+         * Destroys all entries and pages.
+         */
+        ~LTextureAtlas() noexcept;
+
+        /**
+         * @brief Adds an entry.
+         *
+         * @param sizeB Size of the buffer in pixels.
+         * @param stride Stride of the buffer in bytes.
+         * @param buffer Pointer to the first pixel of the buffer, with the same format as the atlas.
+         * @return The new entry, or `nullptr` if it doesn't fit in a page or the page texture couldn't be created.
+         */
+        Entry *add(const LSize &sizeB, UInt32 stride, const void *buffer) noexcept;
+
+        /**
+         * @brief Replaces the pixels of an entry.
+         *
+         * @param entry Entry of this atlas.
+         * @param stride Stride of the buffer in bytes.
+         * @param buffer Pointer to the first pixel of a buffer with the same size and format as the entry.
+         * @return `true` on success, `false` otherwise.
+         */
+        bool update(Entry *entry, UInt32 stride, const void *buffer) noexcept;
+
+        /**
+         * @brief Removes and destroys an entry.
+         *
+         * Pages left empty are destroyed.
+         */
+        void remove(Entry *entry) noexcept;
+
+        /**
+         * @brief Repacks all entries.
+         *
+         * Entries are sorted by height and packed again starting from the first page, leftover pages are destroyed.
+         * Entries keep their pixels but may change their page and rect, views using them don't need to be repainted.
+         */
+        void repack() noexcept;
+
+        /**
+         * @brief Textures of the pages.
+         */
+        const std::vector<LTexture*> &pages() const noexcept
+        {
+            return m_pages;
+        }
+
+        /**
+         * @brief Entries of the atlas in insertion order.
+         */
+        const std::vector<Entry*> &entries() const noexcept
+        {
+            return m_entries;
+        }
+
+        /**
+         * @brief Size of each page in buffer coordinates.
+         */
+        const LSize &pageSizeB() const noexcept
+        {
+            return m_pageSizeB;
+        }
+
+        /**
+         * @brief DRM format of the pages and entries.
+         */
+        UInt32 format() const noexcept
+        {
+            return m_format;
+        }
+
+        /**
+         * @brief Ratio of the page area covered by entries (including their border) in the range [0.0, 1.0].
+         *
+         * A low value after many removals indicates repack() would release pages.
+         */
+        Float32 usage() const noexcept;
+
+    private:
+        struct Skyline
+        {
+            Int32 x, y, w;
+        };
+
+        struct Page
+        {
+            std::vector<Skyline> skyline;
+            UInt64 usedArea { 0 };
+        };
+
+        std::vector<LTexture*> m_pages;
+        std::vector<Page> m_pagesData;
+        std::vector<Entry*> m_entries;
+        LSize m_pageSizeB;
+        UInt32 m_format;
+        bool m_premultipliedAlpha;
+        bool place(Entry *entry) noexcept;
+        bool findPosition(const Page &page, const LSize &sizeB, LPoint &pos, size_t &index) const noexcept;
+        bool addPage() noexcept;
+        void removePage(size_t index) noexcept;
+        bool upload(Entry *entry) noexcept;
+    };
+
+    /**
+     * @brief Texture packed into an LTextureAtlas page
+     *
+     * Entries are created and destroyed by their atlas, see LTextureAtlas::add() and LTextureAtlas::remove().
+     */
+    class LTextureAtlas::Entry final : public LObject
+    {
+    public:
+        LCLASS_NO_COPY(Entry)
+
+        /**
+         * @brief Atlas the entry belongs to.
+         */
+        LTextureAtlas *atlas() const noexcept
+        {
+            return m_atlas;
+        }
+
+        /**
+         * @brief Page texture containing the entry.
+         */
+        LTexture *texture() const noexcept
+        {
+            return m_atlas->m_pages[m_page];
+        }
+
+        /**
+         * @brief Rect of the entry within the page in buffer coordinates, excluding its border.
+         */
+        const LRect &rectB() const noexcept
+        {
+            return m_rectB;
+        }
+
+        /**
+         * @brief Size of the entry in buffer coordinates.
+         */
+        const LSize &sizeB() const noexcept
+        {
+            return m_rectB.size();
+        }
+
+    private:
+        friend class LTextureAtlas;
+        Entry(LTextureAtlas *atlas, const LSize &sizeB) noexcept;
+        ~Entry() noexcept { notifyDestruction(); };
+        LTextureAtlas *m_atlas;
+        size_t m_page { 0 };
+        LRect m_rectB;
+        std::vector<UInt8> m_pixels;
+    };
+};
+
+#endif // LTEXTUREATLAS_H
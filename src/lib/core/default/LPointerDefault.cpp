@@ -24,6 +24,13 @@ using namespace Louvre;
 //! [pointerMoveEvent]
 void LPointer::pointerMoveEvent(const LPointerMoveEvent &event)
 {
+    // The absolute motion is notified later, see enableMotionCoalescing()
+    if (event.motion() == LPointerMoveEvent::RelativeOnly)
+    {
+        sendMoveEvent(event);
+        return;
+    }
+
     // Update the cursor position
     cursor()->move(event.delta().x(), event.delta().y());
 
@@ -10,6 +10,7 @@ void LPointerButtonEvent::notify()
 {
     if (compositor()->state() == LCompositor::Initialized)
     {
+        seat()->pointer()->imp()->dispatchPendingMotion();
         seat()->onEvent(*this);
 
         if (state() == Pressed)
@@ -1,3 +1,4 @@
+#include <private/LPointerPrivate.h>
 #include <LPointerHoldBeginEvent.h>
 #include <LCompositor.h>
 #include <LSeat.h>
@@ -9,6 +10,7 @@ void LPointerHoldBeginEvent::notify()
 {
     if (compositor()->state() == LCompositor::Initialized)
     {
+        seat()->pointer()->imp()->dispatchPendingMotion();
         seat()->onEvent(*this);
         seat()->pointer()->pointerHoldBeginEvent(*this);
     }
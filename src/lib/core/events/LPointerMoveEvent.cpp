@@ -1,3 +1,4 @@
+#include <private/LPointerPrivate.h>
 #include <LPointerMoveEvent.h>
 #include <LCompositor.h>
 #include <LSeat.h>
@@ -9,7 +10,20 @@ void LPointerMoveEvent::notify()
 {
     if (compositor()->state() == LCompositor::Initialized)
     {
+        LPointer &pointer { *seat()->pointer() };
+
+        // Only the absolute motion is coalesced, the relative motion is notified right away
+        if (pointer.motionCoalescingEnabled())
+        {
+            m_motion = RelativeOnly;
+            seat()->onEvent(*this);
+            pointer.pointerMoveEvent(*this);
+            m_motion = RelativeAndAbsolute;
+            pointer.imp()->coalesceMotion(*this);
+            return;
+        }
+
         seat()->onEvent(*this);
-        seat()->pointer()->pointerMoveEvent(*this);
+        pointer.pointerMoveEvent(*this);
     }
 }
@@ -11,6 +11,23 @@
 class Louvre::LPointerMoveEvent final : public LPointerEvent
 {
 public:
+    /**
+     * @brief Motion carried by the event.
+     *
+     * Only differs from @ref RelativeAndAbsolute when pointer motion coalescing is enabled, see LPointer::enableMotionCoalescing().
+     */
+    enum Motion : UInt8
+    {
+        /// Relative and absolute motion
+        RelativeAndAbsolute,
+
+        /// Only relative motion, the absolute motion is accumulated and notified later
+        RelativeOnly,
+
+        /// Only absolute motion, with the accumulated deltas of the previous @ref RelativeOnly events
+        AbsoluteOnly
+    };
+
     /**
      * @brief Constructs an LPointerMoveEvent object.
      *
@@ -92,6 +109,16 @@ public:
         return m_deltaUnaccelerated;
     }
 
+    /**
+     * @brief Gets the motion carried by the event.
+     *
+     * Events with @ref RelativeOnly motion must not move the cursor, see LPointer::enableMotionCoalescing().
+     */
+    Motion motion() const noexcept
+    {
+        return m_motion;
+    }
+
     /**
      * @brief The surface or view local position where the pointer is positioned in surface coordinates.
      */
@@ -100,8 +127,10 @@ public:
 protected:
     LPointF m_delta;
     LPointF m_deltaUnaccelerated;
+    Motion m_motion { RelativeAndAbsolute };
 private:
     friend class LInputBackend;
+    friend class LPointer;
     void notify();
 };
 
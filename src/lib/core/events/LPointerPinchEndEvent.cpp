@@ -1,3 +1,4 @@
+#include <private/LPointerPrivate.h>
 #include <LPointerPinchEndEvent.h>
 #include <LCompositor.h>
 #include <LSeat.h>
@@ -9,6 +10,7 @@ void LPointerPinchEndEvent::notify()
 {
     if (compositor()->state() == LCompositor::Initialized)
     {
+        seat()->pointer()->imp()->dispatchPendingMotion();
         seat()->onEvent(*this);
         seat()->pointer()->pointerPinchEndEvent(*this);
     }
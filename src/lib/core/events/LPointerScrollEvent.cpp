@@ -1,3 +1,4 @@
+#include <private/LPointerPrivate.h>
 #include <LPointerScrollEvent.h>
 #include <LCompositor.h>
 #include <LPointer.h>
@@ -9,6 +10,7 @@ void LPointerScrollEvent::notify()
 {
     if (compositor()->state() == LCompositor::Initialized)
     {
+        seat()->pointer()->imp()->dispatchPendingMotion();
         seat()->onEvent(*this);
         seat()->pointer()->pointerScrollEvent(*this);
     }
@@ -1,3 +1,4 @@
+#include <private/LPointerPrivate.h>
 #include <LPointerSwipeUpdateEvent.h>
 #include <LCompositor.h>
 #include <LSeat.h>
@@ -9,6 +10,7 @@ void LPointerSwipeUpdateEvent::notify()
 {
     if (compositor()->state() == LCompositor::Initialized)
     {
+        seat()->pointer()->imp()->dispatchPendingMotion();
         seat()->onEvent(*this);
         seat()->pointer()->pointerSwipeUpdateEvent(*this);
     }
@@ -19,9 +19,26 @@ LRenderBuffer::LRenderBuffer(const LSize &sizeB) noexcept : LFramebuffer(RenderB
 LRenderBuffer::~LRenderBuffer() noexcept
 {
     notifyDestruction();
+    releaseFramebuffers();
+}
 
-    for (auto &pair : m_threadsMap)
-        compositor()->imp()->addRenderBufferToDestroy(pair.first, pair.second);
+void LRenderBuffer::releaseFramebuffers() noexcept
+{
+    for (ThreadData &data : m_threadsData)
+    {
+        if (!data.framebufferId)
+            continue;
+
+        if (data.textureId)
+            compositor()->imp()->threadsMap[data.thread].renderTargetPool.release({
+                .framebufferId = data.framebufferId,
+                .textureId = data.textureId,
+                .sizeB = m_texture.sizeB()});
+        else
+            compositor()->imp()->addRenderBufferToDestroy(data.thread, data);
+    }
+
+    m_threadsData.clear();
 }
 
 void LRenderBuffer::setSizeB(const LSize &sizeB) noexcept
@@ -30,16 +47,12 @@ void LRenderBuffer::setSizeB(const LSize &sizeB) noexcept
 
     if (m_texture.sizeB() != newSize)
     {
+        releaseFramebuffers();
+        m_texture.reset();
         m_texture.m_sizeB = newSize;
 
         m_rect.setW(roundf(Float32(m_texture.m_sizeB.w()) / m_scale));
         m_rect.setH(roundf(Float32(m_texture.m_sizeB.h()) / m_scale));
-
-        for (auto &pair : m_threadsMap)
-            compositor()->imp()->addRenderBufferToDestroy(pair.first, pair.second);
-
-        m_texture.reset();
-        m_threadsMap.clear();
     }
 }
 
@@ -81,7 +94,31 @@ const LRect &LRenderBuffer::rect() const noexcept
 
 GLuint LRenderBuffer::id() const noexcept
 {
-    ThreadData &data { m_threadsMap[std::this_thread::get_id()] };
+    const UInt32 slot { LCompositor::LCompositorPrivate::currentThreadSlot() };
+
+    if (slot >= m_threadsData.size())
+        m_threadsData.resize(slot + 1);
+
+    ThreadData &data { m_threadsData[slot] };
+
+    // Left by a thread that no longer exists, its context and GL objects are already destroyed
+    if (data.thread != std::this_thread::get_id())
+        data = { .thread = std::this_thread::get_id() };
+
+    if (!data.framebufferId && !m_texture.initialized())
+    {
+        LRenderTargetPool::Target target;
+
+        if (compositor()->imp()->threadsMap[std::this_thread::get_id()].renderTargetPool.acquire(m_texture.sizeB(), target))
+        {
+            data.framebufferId = target.framebufferId;
+            data.textureId = target.textureId;
+            m_texture.m_sourceType = LTexture::GL;
+            m_texture.setDataFromGL(target.textureId, GL_TEXTURE_2D, DRM_FORMAT_ABGR8888, m_texture.sizeB(), false);
+            m_texture.m_sourceType = LTexture::Framebuffer;
+            return data.framebufferId;
+        }
+    }
 
     if (!data.framebufferId)
     {
@@ -114,3 +151,18 @@ Int32 LRenderBuffer::currentBufferIndex() const noexcept
 {
     return 0;
 }
+
+LRenderBuffer::PoolStats LRenderBuffer::poolStats() noexcept
+{
+    PoolStats stats {};
+
+    for (const auto &pair : compositor()->imp()->threadsMap)
+    {
+        stats.hits += pair.second.renderTargetPool.hits;
+        stats.misses += pair.second.renderTargetPool.misses;
+        stats.evictions += pair.second.renderTargetPool.evictions;
+        stats.idleBytes += pair.second.renderTargetPool.idleBytes;
+    }
+
+    return stats;
+}
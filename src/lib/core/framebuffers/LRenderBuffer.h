@@ -4,6 +4,7 @@
 #include <LTexture.h>
 #include <LFramebuffer.h>
 #include <thread>
+#include <vector>
 
 /**
  * @brief Represents a custom render destination framebuffer.
@@ -151,16 +152,47 @@ public:
     void setFramebufferDamage(const LRegion *damage) noexcept override;
     LTransform transform() const noexcept override;
 
+    /**
+     * @brief Render target pool statistics.
+     *
+     * @see poolStats()
+     */
+    struct PoolStats
+    {
+        UInt64 hits; /**< Framebuffers reused from the pool. */
+        UInt64 misses; /**< Framebuffers allocated because none of the requested size was available. */
+        UInt64 evictions; /**< Idle framebuffers destroyed to stay within the memory budget. */
+        UInt64 idleBytes; /**< Memory currently held by idle framebuffers. */
+    };
+
+    /**
+     * @brief Statistics of the render target pool, summed across all threads.
+     *
+     * Framebuffers released by resized or destroyed render buffers are kept in a per-thread pool
+     * and reused by new ones of the same size, evicting the least recently used ones once they exceed
+     * the `LOUVRE_RENDER_TARGET_POOL_SIZE` budget.
+     */
+    static PoolStats poolStats() noexcept;
+
 private:
     friend class LCompositor;
     struct ThreadData
     {
         GLuint framebufferId = 0;
+
+        // Non zero if the framebuffer and texture belong to the thread's LRenderTargetPool
+        GLuint textureId = 0;
+
+        // Slots are reused by new threads after an output is removed
+        std::thread::id thread;
     };
+    void releaseFramebuffers() noexcept;
     mutable LTexture m_texture { true };
     LRect m_rect;
     Float32 m_scale { 1.f };
-    mutable std::unordered_map<std::thread::id, ThreadData> m_threadsMap;
+
+    // Indexed by the slot of the rendering thread
+    mutable std::vector<ThreadData> m_threadsData;
 };
 
 #endif // LRENDERBUFFER_H
@@ -22,6 +22,8 @@ namespace Louvre
         const std::vector<LDMAFormat>*      (*backendGetScanoutDMAFormats)();
         EGLDisplay                          (*backendGetAllocatorEGLDisplay)();
         EGLContext                          (*backendGetAllocatorEGLContext)();
+        bool                                (*backendCreateSharedContext)();
+        void                                (*backendDestroySharedContext)();
 
         /* TEXTURES */
         bool                                (*textureCreateFromCPUBuffer)(LTexture *texture, const LSize &size, UInt32 stride, UInt32 format, const void *pixels);
@@ -36,6 +38,7 @@ namespace Louvre
         GLenum                              (*textureGetTarget)(LTexture *texture);
         void                                (*textureSetFence)(LTexture *texture);
         void                                (*textureDestroy)(LTexture *texture);
+        void                                (*textureDestroyPending)();
 
         /* OUTPUT */
         bool                                (*outputInitialize)(LOutput *output);
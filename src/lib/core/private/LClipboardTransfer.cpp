@@ -0,0 +1,290 @@
+#include <private/LClipboardTransfer.h>
+#include <private/LCompositorPrivate.h>
+#include <LUtils.h>
+#include <LLog.h>
+#include <sys/sendfile.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+
+using namespace Louvre;
+
+void LClipboardTransfer::start(Int32 srcFd, off_t size, Int32 dstFd) noexcept
+{
+    const Int32 fd { fcntl(srcFd, F_DUPFD_CLOEXEC, 0) };
+
+    if (fd < 0)
+    {
+        LLog::error("[LClipboardTransfer::start] Failed to duplicate the clipboard fd.");
+        close(dstFd);
+        return;
+    }
+
+    const Int32 flags { fcntl(dstFd, F_GETFL) };
+
+    if (flags >= 0)
+        fcntl(dstFd, F_SETFL, flags | O_NONBLOCK);
+
+    LClipboardTransfer *transfer { new LClipboardTransfer(fd, size, dstFd) };
+
+    // Small transfers usually fit in the pipe buffer
+    if (transfer->write())
+    {
+        delete transfer;
+        return;
+    }
+
+    transfer->m_source = compositor()->addFdListener(dstFd, transfer, &writable, WL_EVENT_WRITABLE);
+
+    if (!transfer->m_source)
+        delete transfer;
+}
+
+void LClipboardTransfer::receive(Int32 srcFd, Int32 storageFd) noexcept
+{
+    const Int32 fd { fcntl(storageFd, F_DUPFD_CLOEXEC, 0) };
+
+    if (fd < 0)
+    {
+        LLog::error("[LClipboardTransfer::receive] Failed to duplicate the clipboard fd.");
+        close(srcFd);
+        return;
+    }
+
+    const Int32 flags { fcntl(srcFd, F_GETFL) };
+
+    if (flags >= 0)
+        fcntl(srcFd, F_SETFL, flags | O_NONBLOCK);
+
+    // The size is unknown until the source client closes the pipe
+    LClipboardTransfer *transfer { new LClipboardTransfer(srcFd, -1, fd) };
+    transfer->m_storageFd = storageFd;
+    transfer->m_source = compositor()->addFdListener(srcFd, transfer, &readable, WL_EVENT_READABLE);
+
+    if (!transfer->m_source)
+        delete transfer;
+}
+
+bool LClipboardTransfer::receiving(Int32 storageFd) noexcept
+{
+    for (const LClipboardTransfer *transfer : compositor()->imp()->clipboardTransfers)
+        if (transfer->m_storageFd == storageFd)
+            return true;
+
+    return false;
+}
+
+void LClipboardTransfer::cancelReceive(Int32 storageFd) noexcept
+{
+    for (LClipboardTransfer *transfer : compositor()->imp()->clipboardTransfers)
+    {
+        if (transfer->m_storageFd == storageFd)
+        {
+            delete transfer;
+            return;
+        }
+    }
+}
+
+void LClipboardTransfer::cancelAll() noexcept
+{
+    auto &transfers { compositor()->imp()->clipboardTransfers };
+
+    while (!transfers.empty())
+        delete transfers.back();
+}
+
+off_t LClipboardTransfer::maxSize() noexcept
+{
+    static off_t max { -1 };
+
+    if (max == -1)
+    {
+        // MiB
+        const char *env { getenv("LOUVRE_CLIPBOARD_MAX_SIZE") };
+        max = env ? atoi(env) : 256;
+
+        if (max < 0)
+            max = 256;
+
+        max *= 1024 * 1024;
+    }
+
+    return max;
+}
+
+FILE *LClipboardTransfer::createStorage() noexcept
+{
+    const Int32 fd { memfd_create("louvre-clipboard", MFD_CLOEXEC) };
+
+    if (fd >= 0)
+    {
+        FILE *file { fdopen(fd, "w+") };
+
+        if (file)
+            return file;
+
+        close(fd);
+    }
+
+    return tmpfile();
+}
+
+LClipboardTransfer::LClipboardTransfer(Int32 srcFd, off_t size, Int32 dstFd) noexcept :
+    m_srcFd(srcFd),
+    m_dstFd(dstFd),
+    m_size(size)
+{
+    compositor()->imp()->clipboardTransfers.push_back(this);
+}
+
+LClipboardTransfer::~LClipboardTransfer() noexcept
+{
+    LVectorRemoveOneUnordered(compositor()->imp()->clipboardTransfers, this);
+
+    if (m_source)
+        compositor()->removeFdListener(m_source);
+
+    if (m_size < 0)
+        LLog::debug("[LClipboardTransfer::~LClipboardTransfer] Source client interrupted after %ld bytes.", m_offset);
+    else if (m_offset != m_size)
+        LLog::debug("[LClipboardTransfer::~LClipboardTransfer] Transfer interrupted after %ld/%ld bytes.", m_offset, m_size);
+
+    close(m_srcFd);
+    close(m_dstFd);
+}
+
+bool LClipboardTransfer::write() noexcept
+{
+    ssize_t n;
+
+    while (m_offset < m_size)
+    {
+        if (m_zeroCopy)
+        {
+            n = sendfile(m_dstFd, m_srcFd, &m_offset, m_size - m_offset);
+
+            if (n < 0 && (errno == EINVAL || errno == ENOSYS))
+            {
+                m_zeroCopy = false;
+                continue;
+            }
+        }
+        else
+        {
+            UInt8 buffer[65536];
+            n = pread(m_srcFd, buffer, std::min<off_t>(sizeof(buffer), m_size - m_offset), m_offset);
+
+            if (n > 0)
+            {
+                n = ::write(m_dstFd, buffer, n);
+
+                if (n > 0)
+                    m_offset += n;
+            }
+        }
+
+        if (n > 0)
+            continue;
+
+        if (n < 0 && errno == EINTR)
+            continue;
+
+        // Wait until writable
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return false;
+
+        // Storage truncated or receiver gone
+        return true;
+    }
+
+    return true;
+}
+
+bool LClipboardTransfer::read() noexcept
+{
+    const off_t max { maxSize() };
+    ssize_t n;
+
+    while (true)
+    {
+        // One byte more than the max is enough to know it was exceeded
+        const size_t len { max > 0 ? size_t(std::min<off_t>(65536, max + 1 - m_offset)) : 65536 };
+
+        if (m_zeroCopy)
+        {
+            n = splice(m_srcFd, nullptr, m_dstFd, &m_offset, len, SPLICE_F_NONBLOCK);
+
+            if (n < 0 && (errno == EINVAL || errno == ENOSYS))
+            {
+                m_zeroCopy = false;
+                continue;
+            }
+        }
+        else
+        {
+            UInt8 buffer[65536];
+            n = ::read(m_srcFd, buffer, len);
+
+            if (n > 0)
+            {
+                if (pwrite(m_dstFd, buffer, n, m_offset) != n)
+                {
+                    LLog::error("[LClipboardTransfer::read] Failed to store clipboard data.");
+                    ftruncate(m_dstFd, 0);
+                    m_size = m_offset = 0;
+                    return true;
+                }
+
+                m_offset += n;
+            }
+        }
+
+        if (n > 0)
+        {
+            if (max > 0 && m_offset > max)
+            {
+                LLog::debug("[LClipboardTransfer::read] Persistent clipboard data discarded, it exceeds LOUVRE_CLIPBOARD_MAX_SIZE.");
+                ftruncate(m_dstFd, 0);
+                m_size = m_offset = 0;
+                return true;
+            }
+
+            continue;
+        }
+
+        if (n < 0 && errno == EINTR)
+            continue;
+
+        // Wait until readable
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return false;
+
+        // Closed by the source client (or failed)
+        m_size = m_offset;
+        return true;
+    }
+}
+
+int LClipboardTransfer::writable(int /*fd*/, unsigned int mask, void *data) noexcept
+{
+    LClipboardTransfer *transfer { static_cast<LClipboardTransfer*>(data) };
+
+    if ((mask & (WL_EVENT_HANGUP | WL_EVENT_ERROR)) || transfer->write())
+        delete transfer;
+
+    return 0;
+}
+
+int LClipboardTransfer::readable(int /*fd*/, unsigned int mask, void *data) noexcept
+{
+    LClipboardTransfer *transfer { static_cast<LClipboardTransfer*>(data) };
+
+    // Read what is left before a hangup
+    if (transfer->read() || (mask & (WL_EVENT_HANGUP | WL_EVENT_ERROR)))
+        delete transfer;
+
+    return 0;
+}
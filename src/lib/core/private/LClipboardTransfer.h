@@ -0,0 +1,68 @@
+#ifndef LCLIPBOARDTRANSFER_H
+#define LCLIPBOARDTRANSFER_H
+
+#include <LNamespaces.h>
+#include <wayland-server.h>
+#include <sys/types.h>
+#include <cstdio>
+
+namespace Louvre
+{
+    /* Sends persistent clipboard data to a receiver's fd, or stores the data written by the source client,
+     * from the main event loop. Fds are made non-blocking and data is copied each time they become
+     * writable or readable, so slow clients don't stall the compositor.
+     * Used by Protocols::Wayland::RDataOffer::receive() and RDataSource::requestPersistentMimeType(). */
+    class LClipboardTransfer
+    {
+    public:
+        LClipboardTransfer(const LClipboardTransfer&) = delete;
+        LClipboardTransfer &operator=(const LClipboardTransfer&) = delete;
+
+        /* Takes ownership of dstFd and duplicates srcFd, so the data outlives the clipboard.
+         * Sends the first [0, size) bytes of srcFd */
+        static void start(Int32 srcFd, off_t size, Int32 dstFd) noexcept;
+
+        /* Takes ownership of srcFd (the read end of a pipe sent to the source client) and duplicates storageFd.
+         * Copies everything read into storageFd, which is emptied if the data exceeds maxSize() */
+        static void receive(Int32 srcFd, Int32 storageFd) noexcept;
+
+        // Checks if the source client is still writing into storageFd
+        static bool receiving(Int32 storageFd) noexcept;
+
+        // Must be called before closing storageFd, so receiving() isn't fooled by a reused fd number
+        static void cancelReceive(Int32 storageFd) noexcept;
+
+        // Called when the compositor is uninitialized
+        static void cancelAll() noexcept;
+
+        // Max bytes kept for each persistent MIME type (LOUVRE_CLIPBOARD_MAX_SIZE), 0 if unlimited
+        static off_t maxSize() noexcept;
+
+        // Memfd backed storage for a persistent MIME type (or a tmpfile() if not supported)
+        static FILE *createStorage() noexcept;
+
+    private:
+        LClipboardTransfer(Int32 srcFd, off_t size, Int32 dstFd) noexcept;
+        ~LClipboardTransfer() noexcept;
+
+        // Return true once finished (or failed)
+        bool write() noexcept;
+        bool read() noexcept;
+        static int writable(int fd, unsigned int mask, void *data) noexcept;
+        static int readable(int fd, unsigned int mask, void *data) noexcept;
+
+        Int32 m_srcFd;
+        Int32 m_dstFd;
+        off_t m_offset { 0 };
+        off_t m_size;
+        wl_event_source *m_source { nullptr };
+
+        // Storage fd passed to receive(), -1 if sending
+        Int32 m_storageFd { -1 };
+
+        // Switches to pread()/read() and write() if sendfile() or splice() are not supported by the client's fd
+        bool m_zeroCopy { true };
+    };
+}
+
+#endif // LCLIPBOARDTRANSFER_H
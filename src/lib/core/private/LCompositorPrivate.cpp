@@ -349,6 +349,7 @@ bool LCompositor::LCompositorPrivate::initGraphicBackend()
     if (WL_bind_wayland_display)
         eglBindWaylandDisplayWL(eglDisplay(), display);
 
+    acquireThreadSlot();
     painter = new LPainter();
     cursor = new LCursor();
     initDRMLeaseGlobals();
@@ -463,6 +464,9 @@ void LCompositor::LCompositorPrivate::unitGraphicBackend(bool closeLib)
 {
     unitDMAFeedback();
     unitDRMLeaseGlobals();
+    textureUploader.stop();
+    threadsMap[std::this_thread::get_id()].renderTargetPool.clear();
+    releaseThreadSlot(currentThreadSlot());
 
     if (painter)
     {
@@ -505,6 +509,8 @@ bool LCompositor::LCompositorPrivate::initSeat()
 
 void LCompositor::LCompositorPrivate::unitSeat()
 {
+    LClipboardTransfer::cancelAll();
+
     if (seat)
     {
         // Notify first
@@ -804,6 +810,98 @@ void LCompositor::LCompositorPrivate::destroyPendingRenderBuffers(std::thread::i
         glDeleteFramebuffers(1, &threadData.renderBuffersToDestroy.back().framebufferId);
         threadData.renderBuffersToDestroy.pop_back();
     }
+
+    threadData.renderTargetPool.trim();
+}
+
+void LCompositor::LCompositorPrivate::destroyGLTexture(GLuint id) noexcept
+{
+    if (frameSnapshotsInFlight.load() != 0)
+        glTexturesPendingDestruction.push_back(id);
+    else
+        glDeleteTextures(1, &id);
+}
+
+void LCompositor::LCompositorPrivate::destroyEGLImage(EGLImage image) noexcept
+{
+    if (frameSnapshotsInFlight.load() != 0)
+        eglImagesPendingDestruction.push_back(image);
+    else
+        eglDestroyImage(LCompositor::eglDisplay(), image);
+}
+
+void LCompositor::LCompositorPrivate::destroyPendingTextures()
+{
+    if (frameSnapshotsInFlight.load() != 0)
+        return;
+
+    if (!glTexturesPendingDestruction.empty())
+    {
+        glDeleteTextures(glTexturesPendingDestruction.size(), glTexturesPendingDestruction.data());
+        glTexturesPendingDestruction.clear();
+    }
+
+    while (!eglImagesPendingDestruction.empty())
+    {
+        eglDestroyImage(LCompositor::eglDisplay(), eglImagesPendingDestruction.back());
+        eglImagesPendingDestruction.pop_back();
+    }
+
+    graphicBackend->textureDestroyPending();
+}
+
+void LCompositor::LCompositorPrivate::checkOutputsLayout() noexcept
+{
+    bool changed { outputsLayout.size() != outputs.size() };
+
+    for (std::size_t i = 0; !changed && i < outputs.size(); i++)
+        changed = outputsLayout[i] != outputs[i]->rect();
+
+    if (!changed)
+        return;
+
+    outputsLayout.clear();
+
+    for (LOutput *output : outputs)
+        outputsLayout.push_back(output->rect());
+
+    outputsLayoutSerial++;
+}
+
+static thread_local UInt32 threadSlot { 0 };
+
+UInt32 LCompositor::LCompositorPrivate::acquireThreadSlot(UInt32 slot) noexcept
+{
+    // Rebind a slot kept by an output that was reinitialized
+    if (slot < threadSlots.size())
+    {
+        threadSlots[slot] = std::this_thread::get_id();
+        threadSlot = slot;
+        return slot;
+    }
+
+    slot = 0;
+
+    while (slot < threadSlots.size() && threadSlots[slot] != std::thread::id())
+        slot++;
+
+    if (slot == threadSlots.size())
+        threadSlots.emplace_back();
+
+    threadSlots[slot] = std::this_thread::get_id();
+    threadSlot = slot;
+    return slot;
+}
+
+void LCompositor::LCompositorPrivate::releaseThreadSlot(UInt32 slot) noexcept
+{
+    if (slot < threadSlots.size())
+        threadSlots[slot] = std::thread::id();
+}
+
+UInt32 LCompositor::LCompositorPrivate::currentThreadSlot() noexcept
+{
+    return threadSlot;
 }
 
 void LCompositor::LCompositorPrivate::addRenderBufferToDestroy(std::thread::id thread, LRenderBuffer::ThreadData &data)
@@ -857,8 +955,12 @@ LPainter *LCompositor::LCompositorPrivate::findPainter()
 
 void LCompositor::LCompositorPrivate::sendPendingConfigurations()
 {
-    for (LSurface *s : surfaces)
+    // Indexed because roles could queue new configurations meanwhile
+    for (std::size_t i = 0; i < surfacesPendingConfiguration.size(); i++)
     {
+        LSurface *s { surfacesPendingConfiguration[i] };
+        s->imp()->stateFlags.remove(LSurface::LSurfacePrivate::PendingConfiguration);
+
         if (s->toplevel())
             s->toplevel()->sendPendingConfiguration();
         else if (s->popup())
@@ -867,6 +969,8 @@ void LCompositor::LCompositorPrivate::sendPendingConfigurations()
             s->sessionLock()->sendPendingConfiguration();
     }
 
+    surfacesPendingConfiguration.clear();
+
     for (LClient *c : clients)
         for (auto *g : c->wlrOutputManagerGlobals())
             g->done();
@@ -874,14 +978,31 @@ void LCompositor::LCompositorPrivate::sendPendingConfigurations()
 
 void LCompositor::LCompositorPrivate::sendPresentationTime()
 {
+    if (surfacesPendingPresentationFeedback.empty())
+        return;
+
     for (LOutput *o : outputs)
     {
         o->imp()->pageflipMutex.lock();
         if (o->imp()->stateFlags.check(LOutput::LOutputPrivate::HasUnhandledPresentationTime))
-            for (LSurface *s : surfaces)
+            for (LSurface *s : surfacesPendingPresentationFeedback)
                 s->imp()->sendPresentationFeedback(o);
         o->imp()->pageflipMutex.unlock();
     }
+
+    for (std::size_t i = 0; i < surfacesPendingPresentationFeedback.size();)
+    {
+        LSurface *s { surfacesPendingPresentationFeedback[i] };
+
+        if (s->imp()->presentationFeedbackResources.empty())
+        {
+            s->imp()->stateFlags.remove(LSurface::LSurfacePrivate::PendingPresentationFeedback);
+            surfacesPendingPresentationFeedback[i] = surfacesPendingPresentationFeedback.back();
+            surfacesPendingPresentationFeedback.pop_back();
+        }
+        else
+            i++;
+    }
 }
 
 void LCompositor::LCompositorPrivate::initDMAFeedback() noexcept
@@ -2,6 +2,11 @@
 #define LCOMPOSITORPRIVATE_H
 
 #include <private/LBackendPrivate.h>
+#include <private/LTextureUploader.h>
+#include <private/LClipboardTransfer.h>
+#include <private/LRenderTargetPool.h>
+#include <private/LFrameArena.h>
+#include <private/LProgramCache.h>
 #include <LCompositor.h>
 #include <LOutput.h>
 #include <LInputDevice.h>
@@ -10,6 +15,7 @@
 #include <EGL/eglext.h>
 #include <sys/epoll.h>
 #include <map>
+#include <atomic>
 #include <unistd.h>
 #include <string>
 #include <filesystem>
@@ -107,7 +113,33 @@ LPRIVATE_CLASS(LCompositor)
     std::vector<LClient*>clients;
     std::vector<LOutput*>outputs;
     std::vector<LView*>views;
+
+    /* Incremented when the views tree or stacking order changes, or outputs are arranged.
+     * Scenes rebuild their input index when it differs, other changes are tracked per view (LView::invalidateInputBounds()) */
+    UInt32 viewsInputSerial { 1 };
+
+    /* Incremented by checkOutputsLayout() when the output rects differ from the ones of the previous call.
+     * Views update their intersected outputs only when moved or when it changes, see LSceneView::calcNewDamage() */
+    UInt32 outputsLayoutSerial { 1 };
+    std::vector<LRect> outputsLayout;
+    void checkOutputsLayout() noexcept;
     std::vector<LTexture*>textures;
+
+    /* Number of outputs replaying a frame snapshot without holding the lock (LOutput::enableFrameSnapshots()).
+     * Graphic backends release the GL objects of textures destroyed meanwhile with destroyGLTexture() and
+     * destroyEGLImage(), which keep them here until it drops to 0 */
+    std::atomic<UInt32> frameSnapshotsInFlight { 0 };
+    std::vector<GLuint> glTexturesPendingDestruction;
+    std::vector<EGLImage> eglImagesPendingDestruction;
+    void destroyGLTexture(GLuint id) noexcept;
+    void destroyEGLImage(EGLImage image) noexcept;
+    void destroyPendingTextures();
+
+    // Asynchronous SHM buffer uploads, see LSurface::LSurfacePrivate::bufferToTexture()
+    LTextureUploader textureUploader;
+
+    // Persistent clipboard data being sent to clients, see LClipboardTransfer
+    std::vector<LClipboardTransfer*> clipboardTransfers;
     std::vector<LAnimation*>animations;
     std::vector<LTimer*>oneShotTimers;
 
@@ -120,13 +152,31 @@ LPRIVATE_CLASS(LCompositor)
     {
         LPainter *painter { nullptr };
         std::vector<LRenderBuffer::ThreadData> renderBuffersToDestroy;
+        LRenderTargetPool renderTargetPool;
+
+        // Reset at the end of each frame of the output rendered by the thread
+        LFrameArena frameArena;
     };
 
     std::map<std::thread::id, ThreadData> threadsMap;
+
+    // Program binaries shared by the painters of all threads
+    LProgramCache programCache;
+
+    /* Dense indices of the threads rendering views (the main thread and each output thread).
+     * Views, scenes and render buffers store their per-thread data in arrays indexed by them */
+    std::vector<std::thread::id> threadSlots;
+    UInt32 acquireThreadSlot(UInt32 slot = UINT32_MAX) noexcept;
+    void releaseThreadSlot(UInt32 slot) noexcept;
+    static UInt32 currentThreadSlot() noexcept;
     void destroyPendingRenderBuffers(std::thread::id *id);
     void addRenderBufferToDestroy(std::thread::id thread, LRenderBuffer::ThreadData &data);
     static LPainter *findPainter();
 
+    /* Surfaces with a role configuration or presentation feedback to send, so that flushing
+     * them doesn't iterate every surface. See LSurface::LSurfacePrivate::queueConfiguration() */
+    std::vector<LSurface*> surfacesPendingConfiguration;
+    std::vector<LSurface*> surfacesPendingPresentationFeedback;
     void sendPendingConfigurations();
     void sendPresentationTime();
     bool isInputBackendInitialized { false };
@@ -0,0 +1,186 @@
+#include <private/LFrameArena.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+using namespace Louvre;
+
+// Size of the first block, enough for the temporaries of most frames
+#define LFRAMEARENA_BLOCK_SIZE 65536
+
+static thread_local LFrameArena *currentArena { nullptr };
+
+LFrameArena *LFrameArena::current() noexcept
+{
+    return currentArena;
+}
+
+void LFrameArena::bind(LFrameArena *arena) noexcept
+{
+    currentArena = arena;
+}
+
+void *LFrameArena::allocate(std::size_t size, std::size_t alignment) noexcept
+{
+    while (m_block < m_blocks.size())
+    {
+        const Block &block { m_blocks[m_block] };
+        const std::uintptr_t start { reinterpret_cast<std::uintptr_t>(block.data) };
+        const std::uintptr_t aligned { (start + m_offset + alignment - 1) & ~std::uintptr_t(alignment - 1) };
+
+        if (aligned + size <= start + block.size)
+        {
+            m_offset = aligned + size - start;
+
+            if (m_base + m_offset > peakBytes)
+                peakBytes = m_base + m_offset;
+
+            return reinterpret_cast<void*>(aligned);
+        }
+
+        // Smaller blocks after the current one are replaced below
+        if (m_block + 1 < m_blocks.size() && m_blocks[m_block + 1].size >= size + alignment)
+        {
+            m_base += block.size;
+            m_block++;
+            m_offset = 0;
+            continue;
+        }
+
+        break;
+    }
+
+    std::size_t blockSize { m_blocks.empty() ? LFRAMEARENA_BLOCK_SIZE : m_blocks.back().size * 2 };
+
+    if (blockSize < size + alignment)
+        blockSize = size + alignment;
+
+    Block newBlock { static_cast<UInt8*>(std::malloc(blockSize)), blockSize };
+
+    if (!newBlock.data)
+        return nullptr;
+
+    if (m_blocks.empty())
+        m_blocks.push_back(newBlock);
+    else
+    {
+        const std::size_t next { m_block + 1 };
+
+        if (next < m_blocks.size())
+        {
+            std::free(m_blocks[next].data);
+            m_blocks[next] = newBlock;
+        }
+        else
+            m_blocks.push_back(newBlock);
+
+        m_base += m_blocks[m_block].size;
+        m_block = next;
+    }
+
+    m_offset = 0;
+    return allocate(size, alignment);
+}
+
+void LFrameArena::initRegion(pixman_region32_t *region, const LBox *boxes, Int32 n) noexcept
+{
+    if (n <= 1)
+    {
+        initRegion(region, nullptr, boxes, n);
+        return;
+    }
+
+    void *storage { allocate(regionStorageSize(n), alignof(pixman_region32_data_t)) };
+
+    if (storage)
+        initRegion(region, storage, boxes, n);
+    else
+        pixman_region32_init_rects(region, (const pixman_box32_t*)boxes, n);
+}
+
+void LFrameArena::initRegion(pixman_region32_t *region, void *storage, const LBox *boxes, Int32 n) noexcept
+{
+    if (n == 0)
+    {
+        pixman_region32_init(region);
+        return;
+    }
+
+    region->extents = *(const pixman_box32_t*)&boxes[0];
+
+    // Single boxes don't use data
+    if (n == 1)
+    {
+        region->data = nullptr;
+        return;
+    }
+
+    for (Int32 i = 1; i < n; i++)
+    {
+        region->extents.x1 = std::min(region->extents.x1, boxes[i].x1);
+        region->extents.x2 = std::max(region->extents.x2, boxes[i].x2);
+    }
+
+    region->extents.y2 = boxes[n - 1].y2;
+
+    /* A zero size marks the data as not owned by the region (pixman only frees data with size != 0),
+     * so it is also safe if pixman_region32_fini() is called by mistake */
+    region->data = static_cast<pixman_region32_data_t*>(storage);
+    region->data->size = 0;
+    region->data->numRects = n;
+    std::memcpy(region->data + 1, boxes, sizeof(pixman_box32_t) * n);
+}
+
+void LFrameArena::reset() noexcept
+{
+    // Merge blocks so the next frames fit in one
+    if (m_blocks.size() > 1)
+    {
+        std::size_t size { 0 };
+
+        for (const Block &block : m_blocks)
+        {
+            size += block.size;
+            std::free(block.data);
+        }
+
+        m_blocks.clear();
+        Block block { static_cast<UInt8*>(std::malloc(size)), size };
+
+        if (block.data)
+            m_blocks.push_back(block);
+    }
+
+    m_block = 0;
+    m_offset = 0;
+    m_base = 0;
+}
+
+void LFrameArena::clear() noexcept
+{
+    for (const Block &block : m_blocks)
+        std::free(block.data);
+
+    m_blocks.clear();
+    m_block = 0;
+    m_offset = 0;
+    m_base = 0;
+}
+
+void LFrameArena::rewind(std::size_t block, std::size_t offset) noexcept
+{
+    if (block >= m_blocks.size())
+    {
+        reset();
+        return;
+    }
+
+    m_base = 0;
+
+    for (std::size_t i = 0; i < block; i++)
+        m_base += m_blocks[i].size;
+
+    m_block = block;
+    m_offset = offset;
+}
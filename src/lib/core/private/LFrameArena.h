@@ -0,0 +1,103 @@
+#ifndef LFRAMEARENA_H
+#define LFRAMEARENA_H
+
+#include <LNamespaces.h>
+#include <LBox.h>
+#include <pixman.h>
+#include <type_traits>
+#include <cstddef>
+#include <vector>
+
+namespace Louvre
+{
+    /* Per-thread bump allocator for temporaries that only live while a frame is rendered, so scene
+     * and painter code running on the output threads doesn't contend for the heap lock.
+     * Each rendering thread owns one (see LCompositorPrivate::ThreadData) and binds it with bind(),
+     * memory is released all at once by reset() at the end of each frame of the output. */
+    class LFrameArena
+    {
+    public:
+        // Allocations done after the marker are released when it goes out of scope
+        class Marker
+        {
+        public:
+            Marker(LFrameArena *arena) noexcept :
+                m_arena(arena),
+                m_block(arena ? arena->m_block : 0),
+                m_offset(arena ? arena->m_offset : 0)
+            {}
+
+            ~Marker() noexcept
+            {
+                if (m_arena)
+                    m_arena->rewind(m_block, m_offset);
+            }
+
+            Marker(const Marker&) = delete;
+            Marker &operator=(const Marker&) = delete;
+
+        private:
+            LFrameArena *m_arena;
+            std::size_t m_block;
+            std::size_t m_offset;
+        };
+
+        LFrameArena() = default;
+        LFrameArena(const LFrameArena&) = delete;
+        LFrameArena &operator=(const LFrameArena&) = delete;
+        ~LFrameArena() noexcept { clear(); }
+
+        // The arena bound to the calling thread or nullptr
+        static LFrameArena *current() noexcept;
+        static void bind(LFrameArena *arena) noexcept;
+
+        void *allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) noexcept;
+
+        // Uninitialized storage, destructors are never called
+        template<class T>
+        T *allocate(std::size_t n) noexcept
+        {
+            static_assert(std::is_trivially_destructible_v<T>);
+            return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+        }
+
+        /* Read-only pixman region of boxes already sorted in y-x bands (e.g. from LRegion::boxes()).
+         * Its data lives in the arena: it must not be passed as destination of pixman operations,
+         * and pixman_region32_fini() does nothing on it */
+        void initRegion(pixman_region32_t *region, const LBox *boxes, Int32 n) noexcept;
+
+        // Same as above using the given storage of at least regionStorageSize(n) bytes
+        static void initRegion(pixman_region32_t *region, void *storage, const LBox *boxes, Int32 n) noexcept;
+
+        static constexpr std::size_t regionStorageSize(Int32 n) noexcept
+        {
+            return sizeof(pixman_region32_data_t) + sizeof(pixman_box32_t) * n;
+        }
+
+        // Releases all allocations in O(1), blocks are merged if the last frame needed more than one
+        void reset() noexcept;
+
+        // Frees all the memory
+        void clear() noexcept;
+
+        // Max bytes used by a frame
+        std::size_t peakBytes { 0 };
+
+    private:
+        struct Block
+        {
+            UInt8 *data;
+            std::size_t size;
+        };
+
+        std::vector<Block> m_blocks;
+        std::size_t m_block { 0 };
+        std::size_t m_offset { 0 };
+
+        // Sum of the sizes of the blocks before m_block
+        std::size_t m_base { 0 };
+        void rewind(std::size_t block, std::size_t offset) noexcept;
+    };
+}
+
+#endif // LFRAMEARENA_H
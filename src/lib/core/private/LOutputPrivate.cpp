@@ -40,6 +40,9 @@ bool LOutput::LOutputPrivate::initialize()
 void LOutput::LOutputPrivate::backendInitializeGL()
 {
     threadId = std::this_thread::get_id();
+    threadSlot = compositor()->imp()->acquireThreadSlot(threadSlot);
+
+    LFrameArena::bind(&compositor()->imp()->threadsMap[threadId].frameArena);
 
     painter = new LPainter();
     painter->imp()->output = output;
@@ -83,16 +86,29 @@ void LOutput::LOutputPrivate::damageToBufferCoords() noexcept
         damage.offset(-rect.pos().x(), -rect.pos().y());
         damage.transform(rect.size(), transform);
 
-        LRegion tmp; Int32 n;
+        Int32 n;
         const LBox *box { damage.boxes(&n) };
-        while (n > 0)
+        LBox *boxesB { compositor()->imp()->threadsMap[threadId].frameArena.allocate<LBox>(n) };
+
+        if (boxesB)
         {
-            tmp.addRect(floorf(Float32(box->x1) * fractionalScale) - 2, floorf(Float32(box->y1) * fractionalScale) - 2,
-                        ceilf(Float32(box->x2 - box->x1) * fractionalScale) + 4, ceilf(Float32(box->y2 - box->y1) * fractionalScale) + 4);
-            n--; box++;
-        }
+            for (Int32 i = 0; i < n; i++)
+            {
+                boxesB[i].x1 = floorf(Float32(box->x1) * fractionalScale) - 2;
+                boxesB[i].y1 = floorf(Float32(box->y1) * fractionalScale) - 2;
+                boxesB[i].x2 = boxesB[i].x1 + Int32(ceilf(Float32(box->x2 - box->x1) * fractionalScale)) + 4;
+                boxesB[i].y2 = boxesB[i].y1 + Int32(ceilf(Float32(box->y2 - box->y1) * fractionalScale)) + 4;
+                box++;
+            }
 
-        damage = std::move(tmp);
+            damage.clear();
+            damage.addBoxes(boxesB, n);
+        }
+        else
+        {
+            damage.clear();
+            damage.addRect(LRect(0, output->currentMode()->sizeB()));
+        }
         damage.clip(LRect(0, output->currentMode()->sizeB()));
 
         if (output->hasBufferDamageSupport())
@@ -194,6 +210,88 @@ void LOutput::LOutputPrivate::handleScreenshotRequests(bool withCursor) noexcept
     }
 }
 
+LOutput::LOutputPrivate::ScreenshotDMATarget *LOutput::LOutputPrivate::screenshotDMATarget(LDMABuffer *dmaBuffer) noexcept
+{
+    for (auto &target : screenshotDMATargets)
+        if (target.buffer == dmaBuffer)
+            return &target;
+
+    UInt32 i { 0 };
+    EGLAttrib attribs[19];
+    attribs[i++] = EGL_WIDTH;
+    attribs[i++] = dmaBuffer->planes()->width;
+    attribs[i++] = EGL_HEIGHT;
+    attribs[i++] = dmaBuffer->planes()->height;
+    attribs[i++] = EGL_LINUX_DRM_FOURCC_EXT;
+    attribs[i++] = dmaBuffer->planes()->format;
+    attribs[i++] = EGL_DMA_BUF_PLANE0_FD_EXT;
+    attribs[i++] = dmaBuffer->planes()->fds[0];
+    attribs[i++] = EGL_DMA_BUF_PLANE0_OFFSET_EXT;
+    attribs[i++] = dmaBuffer->planes()->offsets[0];
+    attribs[i++] = EGL_DMA_BUF_PLANE0_PITCH_EXT;
+    attribs[i++] = dmaBuffer->planes()->strides[0];
+    attribs[i++] = EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT;
+    attribs[i++] = dmaBuffer->planes()->modifiers[0] & 0xFFFFFFFF;
+    attribs[i++] = EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT;
+    attribs[i++] = dmaBuffer->planes()->modifiers[0] >> 32;
+    attribs[i++] = EGL_IMAGE_PRESERVED_KHR;
+    attribs[i++] = EGL_TRUE;
+    attribs[i++] = EGL_NONE;
+
+    EGLImage image { eglCreateImage(compositor()->eglDisplay(), EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, NULL, attribs) };
+
+    if (image == EGL_NO_IMAGE)
+        return nullptr;
+
+    GLuint rb, fb;
+    glGenRenderbuffers(1, &rb);
+    glBindRenderbuffer(GL_RENDERBUFFER, rb);
+    compositor()->imp()->glEGLImageTargetRenderbufferStorageOES(GL_RENDERBUFFER, image);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &fb);
+    glBindFramebuffer(GL_FRAMEBUFFER, fb);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, rb);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        glDeleteFramebuffers(1, &fb);
+        glDeleteRenderbuffers(1, &rb);
+        eglDestroyImage(compositor()->eglDisplay(), image);
+        return nullptr;
+    }
+
+    ScreenshotDMATarget &target { screenshotDMATargets.emplace_back() };
+    target.buffer.reset(dmaBuffer);
+    target.image = image;
+    target.renderbuffer = rb;
+    target.framebuffer = fb;
+
+    // Released on the next frame
+    target.buffer.setOnDestroyCallback([this](auto)
+    {
+        output->repaint();
+    });
+
+    return &target;
+}
+
+void LOutput::LOutputPrivate::destroyScreenshotDMATargets(bool all) noexcept
+{
+    for (auto it = screenshotDMATargets.begin(); it != screenshotDMATargets.end();)
+    {
+        if (all || !it->buffer)
+        {
+            glDeleteFramebuffers(1, &it->framebuffer);
+            glDeleteRenderbuffers(1, &it->renderbuffer);
+            eglDestroyImage(compositor()->eglDisplay(), it->image);
+            it = screenshotDMATargets.erase(it);
+        }
+        else
+            it++;
+    }
+}
+
 void LOutput::LOutputPrivate::blitFramebuffers() noexcept
 {
     if (stateFlags.checkAll(UsingFractionalScale | FractionalOversamplingEnabled))
@@ -346,14 +444,28 @@ void LOutput::LOutputPrivate::backendPaintGL()
         scanout[0].surface.reset();
     }
 
+    /* paintGL() (scene traversal, damage and recording) always runs locked,
+     * frame snapshots only move the GL submission out of the lock */
+    const bool useFrameSnapshot { callLock && frameSnapshots.load() };
+
     /* Let users do their rendering*/
     painter->bindProgram();
+
+    if (useFrameSnapshot)
+        painter->imp()->beginFrameSnapshot();
+
     painter->bindFramebuffer(&fb);
     stateFlags.add(IsInPaintGL);
     output->paintGL();
     stateFlags.remove(IsInPaintGL);
-    painter->bindProgram();
-    painter->bindFramebuffer(&fb);
+
+    if (useFrameSnapshot)
+        painter->imp()->endFrameSnapshot();
+    else
+    {
+        painter->bindProgram();
+        painter->bindFramebuffer(&fb);
+    }
 
     /* Force repaint if there are unreleased buffers */
     if (scanout[0].buffer || scanout[1].buffer)
@@ -366,11 +478,18 @@ void LOutput::LOutputPrivate::backendPaintGL()
      * security sensitive normal/unlocked content is possibly visible. */
     removeFromSessionLockPendingRepaint();
 
+    /* Send screen copies read in previous frames */
+    screenshotReadback.process(output);
+    destroyScreenshotDMATargets(false);
+
     /* Remove denied or invalid screen copy requests */
     validateScreenshotRequests();
 
     compositor()->imp()->currentOutput = nullptr;
 
+    if (useFrameSnapshot)
+        replayFrameSnapshot();
+
     if (!stateFlags.check(HasScanoutBuffer))
     {
         /* Turn damage into buffer coords and handle buffer
@@ -388,11 +507,32 @@ void LOutput::LOutputPrivate::backendPaintGL()
     /* Destroy render buffers created from this thread and marked as destroyed by the user */
     compositor()->imp()->destroyPendingRenderBuffers(&output->imp()->threadId);
 
+    /* Release the temporaries of this frame */
+    compositor()->imp()->threadsMap[output->imp()->threadId].frameArena.reset();
+
     /* Handle LOutput::repaint() calls from this thread */
     compositor()->imp()->handleOutputRepaintRequests();
 
     if (callLock)
         compositor()->imp()->unlock();
+
+    /* The main thread started waiting to change the output state during the replay,
+     * it released the lock and waits for the ACK before taking it again */
+    if (useFrameSnapshot && !output->imp()->callLock.load())
+        callLockACK.store(true);
+}
+
+void LOutput::LOutputPrivate::replayFrameSnapshot()
+{
+    /* GL objects of textures destroyed by other threads meanwhile are kept alive
+     * until the replay ends, see LCompositorPrivate::destroyGLTexture() */
+    compositor()->imp()->frameSnapshotsInFlight++;
+    compositor()->imp()->unlock();
+    painter->imp()->replayFrameSnapshot();
+    compositor()->imp()->lock();
+    compositor()->imp()->frameSnapshotsInFlight--;
+    painter->bindProgram();
+    painter->bindFramebuffer(&fb);
 }
 
 void LOutput::LOutputPrivate::backendResizeGL()
@@ -451,6 +591,9 @@ void LOutput::LOutputPrivate::backendUninitializeGL()
        screenshotRequests.pop_back();
     }
 
+    screenshotReadback.destroy();
+    destroyScreenshotDMATargets(true);
+
     output->uninitializeGL();
     removeFromSessionLockPendingRepaint();
 
@@ -462,6 +605,9 @@ void LOutput::LOutputPrivate::backendUninitializeGL()
     output->imp()->state = LOutput::Uninitialized;
     updateLayerSurfacesMapping();
     compositor()->imp()->destroyPendingRenderBuffers(&output->imp()->threadId);
+    compositor()->imp()->threadsMap[output->imp()->threadId].renderTargetPool.clear();
+    compositor()->imp()->threadsMap[output->imp()->threadId].frameArena.clear();
+    LFrameArena::bind(nullptr);
 
     if (callLock)
         compositor()->imp()->unlock();
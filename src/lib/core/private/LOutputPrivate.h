@@ -1,7 +1,9 @@
 #ifndef LOUTPUTPRIVATE_H
 #define LOUTPUTPRIVATE_H
 
+#include <private/LScreenshotReadback.h>
 #include <LOutputFramebuffer.h>
+#include <LDMABuffer.h>
 #include <LRenderBuffer.h>
 #include <LOutput.h>
 #include <LBitset.h>
@@ -12,6 +14,7 @@
 #include <list>
 #include <mutex>
 #include <functional>
+#include <EGL/egl.h>
 
 using namespace Louvre;
 
@@ -113,7 +116,11 @@ LPRIVATE_CLASS_NO_COPY(LOutput)
     // Thread sync stuff
     std::atomic<bool> callLock;
     std::atomic<bool> callLockACK;
+    std::atomic<bool> frameSnapshots { false }; // See LOutput::enableFrameSnapshots()
     std::thread::id threadId;
+
+    // Index of the rendering thread in LCompositorPrivate::threadSlots, kept until the output is removed
+    UInt32 threadSlot { UINT32_MAX };
     std::mutex repaintFilterMutex;
     LGammaTable gammaTable {0};
 
@@ -130,6 +137,20 @@ LPRIVATE_CLASS_NO_COPY(LOutput)
     std::vector<LScreenshotRequest*> screenshotRequests;
     void validateScreenshotRequests() noexcept;
     void handleScreenshotRequests(bool withCursor) noexcept;
+    LScreenshotReadback screenshotReadback;
+
+    /* DMA buffers imported by screen copy requests, reused while the client keeps them alive.
+     * Must be created and destroyed from the output thread (framebuffers are not shared) */
+    struct ScreenshotDMATarget
+    {
+        LWeak<LDMABuffer> buffer;
+        EGLImage image { EGL_NO_IMAGE };
+        GLuint renderbuffer { 0 };
+        GLuint framebuffer { 0 };
+    };
+    std::list<ScreenshotDMATarget> screenshotDMATargets;
+    ScreenshotDMATarget *screenshotDMATarget(LDMABuffer *buffer) noexcept;
+    void destroyScreenshotDMATargets(bool all) noexcept;
     UInt8 screenshotCursorTimeout { 0 };
 
     struct ScanoutBuffer
@@ -157,6 +178,7 @@ LPRIVATE_CLASS_NO_COPY(LOutput)
     void *graphicBackendData {nullptr};
     void backendInitializeGL();
     void backendPaintGL();
+    void replayFrameSnapshot();
     void backendResizeGL();
     void backendUninitializeGL();
     void backendPageFlipped();
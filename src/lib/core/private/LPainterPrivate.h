@@ -3,6 +3,19 @@
 
 #define LPAINTER_TRACK_UNIFORMS 1
 
+// Draw multi-box regions with a single draw call, 0 falls back to one draw per box
+#define LPAINTER_BATCH_REGIONS 1
+
+// Draw with programs specialized for the current uniforms, 0 always uses the generic (branching) programs
+#define LPAINTER_SHADER_VARIANTS 1
+
+// Opaque color regions with up to this many boxes are filled with glClear() instead of a draw, 0 disables it
+#define LPAINTER_CLEAR_MAX_BOXES 4
+
+#ifndef LOUVRE_PROFILING
+#define LOUVRE_PROFILING 0
+#endif
+
 #include <private/LTexturePrivate.h>
 #include <private/LOutputPrivate.h>
 #include <LOutputFramebuffer.h>
@@ -10,6 +23,9 @@
 #include <LRect.h>
 #include <GL/gl.h>
 #include <GLES2/gl2.h>
+#include <time.h>
+#include <cstring>
+#include <vector>
 
 using namespace Louvre;
 
@@ -19,7 +35,8 @@ enum ShaderMode : GLint
 {
     LegacyMode = 0,
     TextureMode = 1,
-    ColorMode = 2
+    ColorMode = 2,
+    BatchedTextureMode = 3
 };
 
 struct Uniforms
@@ -68,6 +85,9 @@ struct UserState
 LRectF srcRect;
 bool needsBlendFuncUpdate { true };
 
+// See LPainter::setClearColor(), restored after filling boxes with glClear()
+LRGBAF clearColor { 0.f, 0.f, 0.f, 0.f };
+
 static inline GLfloat square[]
 {
     //  VERTEX     FRAGMENT
@@ -77,7 +97,8 @@ static inline GLfloat square[]
     1.0f,  1.0f,   1.f, 1.f  // TR
 };
 
-GLuint vertexShader, fragmentShader, fragmentShaderExternal, fragmentShaderScaler, fragmentShaderScalerExternal;
+// Reused across drawRegion() calls: 6 vertices per box, each (x, y, u, v)
+std::vector<GLfloat> batchVertices;
 
 struct ShaderState
 {
@@ -122,9 +143,24 @@ struct CPUFormats
 } cpuFormats;
 
 void updateCPUFormats() noexcept;
+
+// Accumulated per painter (thread), see LPainter::stats()
+LPainter::Stats stats {};
+
+static UInt64 profilerNs() noexcept
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return UInt64(ts.tv_sec) * 1000000000 + UInt64(ts.tv_nsec);
+}
+
 void setupProgram() noexcept;
+static void getUniformLocations(GLuint program, Uniforms &programUniforms) noexcept;
 void setupProgramScaler() noexcept;
 
+// Restores the GL state LPainter relies on, see LPainter::bindProgram()
+void resetGLState() noexcept;
+
 void shaderSetPremultipliedAlpha(bool premultipliedAlpha) noexcept
 {
     if (currentState->premultipliedAlpha != premultipliedAlpha)
@@ -217,44 +253,153 @@ void shaderSetAlpha(Float32 a) noexcept
 
 // GL params
 
+// Makes the program current, its uniforms are synced with the values of the previous one
+void useProgram(GLuint program, Uniforms *programUniforms, ShaderState *programState) noexcept
+{
+    ShaderState *prevState { currentState };
+    currentProgram = program;
+    currentUniforms = programUniforms;
+    currentState = programState;
+    glUseProgram(currentProgram);
+
+    if (prevState == currentState)
+        return;
+
+    shaderSetTexSize(prevState->texSize);
+    shaderSetSrcRect(prevState->srcRect);
+    shaderSetActiveTexture(prevState->activeTexture);
+    shaderSetColorFactorEnabled(prevState->colorFactorEnabled);
+    shaderSetAlpha(prevState->alpha);
+    shaderSetMode(prevState->mode);
+    shaderSetColor(prevState->color);
+    shaderSetTexColorEnabled(prevState->texColorEnabled);
+    shaderSetPremultipliedAlpha(prevState->premultipliedAlpha);
+    shaderSetHas90Deg(prevState->has90deg);
+}
+
+// Uploads all uniforms of the current program, regardless of the tracked state
+void uploadUniforms() noexcept;
+
 void switchTarget(GLenum target) noexcept
 {
-    if (textureTarget != target)
+    if (textureTarget == target)
+        return;
+
+    textureTarget = target;
+
+    // Otherwise the program is selected by the next draw, see bindVariant()
+#if LPAINTER_SHADER_VARIANTS == 0
+    if (target == GL_TEXTURE_2D)
+        useProgram(programObject, &uniforms, &state);
+    else
+        useProgram(programObjectExternal, &uniformsExternal, &stateExternal);
+#endif
+}
+
+/* Shader variants
+ *
+ * Programs compiled on first use for a given combination of the uniforms the generic shaders branch on.
+ * Uniforms are still set through the shaderSet*() functions, the program matching the current state is
+ * bound right before each draw by bindVariant(). */
+
+enum ShaderVariantKey : UInt8
+{
+    // LegacyMode, TextureMode (also used for BatchedTextureMode) or ColorMode
+    VariantModeMask      = 0b11,
+    VariantHas90Deg      = 1 << 2,
+    VariantTexColor      = 1 << 3,
+    VariantPremultiplied = 1 << 4,
+    VariantColorFactor   = 1 << 5,
+    VariantAlpha         = 1 << 6,
+    VariantExternal      = 1 << 7
+};
+
+struct ShaderVariant
+{
+    GLuint program { 0 };
+    Uniforms uniforms;
+    ShaderState state;
+    bool failed { false };
+};
+
+ShaderVariant variants[256];
+
+// Only the bits that change the output of the shaders are set, the rest map to the same variant
+static UInt8 makeVariantKey(ShaderMode mode, bool has90deg, bool external, Float32 alpha,
+                            bool texColorEnabled, bool premultipliedAlpha, bool colorFactorEnabled) noexcept
+{
+    if (mode == ColorMode)
+        return ColorMode;
+
+    UInt8 key { mode == LegacyMode ? UInt8(LegacyMode) : UInt8(TextureMode) };
+
+    if (key == TextureMode && has90deg)
+        key |= VariantHas90Deg;
+
+    if (external)
+        key |= VariantExternal;
+
+    if (alpha != 1.f)
+        key |= VariantAlpha;
+
+    if (texColorEnabled)
+        key |= VariantTexColor;
+    else
     {
-        if (target == GL_TEXTURE_2D)
-        {
-            currentProgram = programObject;
-            currentUniforms = &uniforms;
-            glUseProgram(currentProgram);
-            currentState = &state;
-            shaderSetColorFactorEnabled(stateExternal.colorFactorEnabled);
-            shaderSetAlpha(stateExternal.alpha);
-            shaderSetMode(stateExternal.mode);
-            shaderSetColor(stateExternal.color);
-            shaderSetTexColorEnabled(stateExternal.texColorEnabled);
-            shaderSetPremultipliedAlpha(stateExternal.premultipliedAlpha);
-            shaderSetHas90Deg(stateExternal.has90deg);
-        }
-        else
-        {
-            currentProgram = programObjectExternal;
-            currentUniforms = &uniformsExternal;
-            glUseProgram(currentProgram);
-            currentState = &stateExternal;
-            shaderSetColorFactorEnabled(state.colorFactorEnabled);
-            shaderSetAlpha(state.alpha);
-            shaderSetMode(state.mode);
-            shaderSetColor(state.color);
-            shaderSetTexColorEnabled(state.texColorEnabled);
-            shaderSetPremultipliedAlpha(state.premultipliedAlpha);
-            shaderSetHas90Deg(state.has90deg);
-        }
+        if (premultipliedAlpha)
+            key |= VariantPremultiplied;
 
-        textureTarget = target;
+        if (colorFactorEnabled)
+            key |= VariantColorFactor;
     }
+
+    return key;
 }
 
-void setViewport(Int32 x, Int32 y, Int32 w, Int32 h) noexcept
+UInt8 variantKey() const noexcept
+{
+    return makeVariantKey(currentState->mode,
+                          currentState->has90deg,
+                          textureTarget == GL_TEXTURE_EXTERNAL_OES,
+                          currentState->alpha,
+                          currentState->texColorEnabled,
+                          currentState->premultipliedAlpha,
+                          currentState->colorFactorEnabled);
+}
+
+// Links the variant and makes it current, returns false on failure
+bool compileVariant(UInt8 key) noexcept;
+
+// Must be called before each draw
+void bindVariant() noexcept
+{
+#if LPAINTER_SHADER_VARIANTS == 1
+    ShaderVariant &variant { variants[variantKey()] };
+
+    if (variant.program)
+    {
+        if (variant.program != currentProgram)
+            useProgram(variant.program, &variant.uniforms, &variant.state);
+
+        return;
+    }
+
+    if (!variant.failed && compileVariant(variantKey()))
+        return;
+
+    // Fallback to the generic programs
+    if (textureTarget == GL_TEXTURE_2D)
+    {
+        if (currentProgram != programObject)
+            useProgram(programObject, &uniforms, &state);
+    }
+    else if (currentProgram != programObjectExternal)
+        useProgram(programObjectExternal, &uniformsExternal, &stateExternal);
+#endif
+}
+
+// Converts a rect in compositor-global coords into framebuffer pixels
+void toFramebufferPixels(Int32 &x, Int32 &y, Int32 &w, Int32 &h) noexcept
 {
     x -= fb->rect().x();
     y -= fb->rect().y();
@@ -346,6 +491,13 @@ void setViewport(Int32 x, Int32 y, Int32 w, Int32 h) noexcept
     y = floorf(Float32(y) * fbScale);
     w = x2 - x;
     h = y2 - y;
+}
+
+void setViewport(Int32 x, Int32 y, Int32 w, Int32 h) noexcept
+{
+    toFramebufferPixels(x, y, w, h);
+    const Int32 x2 { x + w };
+    const Int32 y2 { y + h };
 
     glScissor(x, y, w, h);
     glViewport(x, y, w, h);
@@ -360,133 +512,628 @@ void setViewport(Int32 x, Int32 y, Int32 w, Int32 h) noexcept
     }
 }
 
-void updateBlendingParams() noexcept
+/* Appends two triangles per box to dst, each vertex (x, y, u, v) in NDC relative to the given
+ * viewport (framebuffer pixels), with the same pixel snapping setViewport() applies per box.
+ * Returns the number of vertices added */
+GLsizei appendQuads(std::vector<GLfloat> &dst, const LBox *boxes, Int32 n, Int32 vpX, Int32 vpY, Int32 vpW, Int32 vpH, bool textured) noexcept
 {
-    needsBlendFuncUpdate = false;
-    shaderSetMode(userState.mode);
+    const Float32 ndcX { 2.f / Float32(vpW) };
+    const Float32 ndcY { 2.f / Float32(vpH) };
+    const std::size_t offset { dst.size() };
+    dst.resize(offset + std::size_t(n) * 24);
+    GLfloat *v { dst.data() + offset };
+    GLsizei count { 0 };
+
+    for (Int32 i = 0; i < n; i++)
+    {
+        Int32 x { boxes[i].x1 };
+        Int32 y { boxes[i].y1 };
+        Int32 w { boxes[i].x2 - boxes[i].x1 };
+        Int32 h { boxes[i].y2 - boxes[i].y1 };
+        toFramebufferPixels(x, y, w, h);
+
+        if (w <= 0 || h <= 0)
+            continue;
+
+        const GLfloat x1 { Float32(x - vpX) * ndcX - 1.f };
+        const GLfloat y1 { Float32(y - vpY) * ndcY - 1.f };
+        const GLfloat x2 { Float32(x + w - vpX) * ndcX - 1.f };
+        const GLfloat y2 { Float32(y + h - vpY) * ndcY - 1.f };
+        GLfloat u1 { 0.f }, v1 { 0.f }, u2 { 0.f }, v2 { 0.f };
+
+        if (textured)
+        {
+            u1 = (Float32(x) - srcRect.x()) / srcRect.w();
+            v1 = (Float32(y) - srcRect.y()) / srcRect.h();
+            u2 = (Float32(x + w) - srcRect.x()) / srcRect.w();
+            v2 = (Float32(y + h) - srcRect.y()) / srcRect.h();
+        }
+
+        const GLfloat quad[]
+        {
+            x1, y1, u1, v1,
+            x2, y1, u2, v1,
+            x2, y2, u2, v2,
+            x1, y1, u1, v1,
+            x2, y2, u2, v2,
+            x1, y2, u1, v2
+        };
+
+        memcpy(v, quad, sizeof(quad));
+        v += 24;
+        count += 6;
+    }
+
+    dst.resize(offset + std::size_t(count) * 4);
+    return count;
+}
+
+// Submits all boxes as a single GL_TRIANGLES call, the viewport covers the whole framebuffer
+void drawBoxesBatched(const LBox *boxes, Int32 n) noexcept
+{
+    Int32 vpX { fb->rect().x() };
+    Int32 vpY { fb->rect().y() };
+    Int32 vpW { fb->rect().w() };
+    Int32 vpH { fb->rect().h() };
+    toFramebufferPixels(vpX, vpY, vpW, vpH);
+
+    if (vpW <= 0 || vpH <= 0)
+        return;
+
+    glScissor(vpX, vpY, vpW, vpH);
+    glViewport(vpX, vpY, vpW, vpH);
+
+    const bool textured { currentState->mode == TextureMode };
+    batchVertices.clear();
+    const GLsizei count { appendQuads(batchVertices, boxes, n, vpX, vpY, vpW, vpH, textured) };
+
+    if (count == 0)
+        return;
+
+    if (textured)
+        shaderSetMode(BatchedTextureMode);
+
+    bindVariant();
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, batchVertices.data());
+    glDrawArrays(GL_TRIANGLES, 0, count);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, square);
+
+    if (textured)
+        shaderSetMode(TextureMode);
+
+    stats.drawCalls++;
+}
+
+struct BlendingParams
+{
+    ShaderMode mode;
+    LBlendFunc blendFunc;
+    LRGBF color;
+    Float32 alpha;
+    bool texColorEnabled;
+    bool premultipliedAlpha;
+    bool colorFactorEnabled;
+
+    // Color mode with alpha 1, equivalent to a glClear() with the color
+    bool opaqueFill;
+};
+
+BlendingParams currentBlending {};
+
+// Translates the user state into shader uniforms and the blend func, without touching GL
+BlendingParams resolveBlendingParams() const noexcept
+{
+    static constexpr LBlendFunc defaultBlendFunc { GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA };
+    static constexpr LBlendFunc premultipliedBlendFunc { GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA };
+
+    BlendingParams p;
+    p.mode = userState.mode;
+    p.alpha = userState.alpha * userState.colorFactor.a;
+    p.texColorEnabled = false;
+    p.premultipliedAlpha = false;
+    p.opaqueFill = false;
+    p.colorFactorEnabled =
+        userState.colorFactor.r != 1.f ||
+        userState.colorFactor.g != 1.f ||
+        userState.colorFactor.b != 1.f ||
+        userState.colorFactor.a != 1.f;
 
     if (userState.mode == TextureMode)
     {
         /* Texture with replaced color */
         if (userState.customTextureColor)
         {
-            shaderSetTexColorEnabled(true);
-            LRGBF color { userState.color };
-            const Float32 alpha { userState.alpha * userState.colorFactor.a};
-            color.r *= userState.colorFactor.r;
-            color.g *= userState.colorFactor.g;
-            color.b *= userState.colorFactor.b;
-
-            if (userState.autoBlendFunc)
-            {
-                glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-            }
-            else
-            {
-                glBlendFuncSeparate(userState.customBlendFunc.sRGBFactor,
-                                    userState.customBlendFunc.dRGBFactor,
-                                    userState.customBlendFunc.sAlphaFactor,
-                                    userState.customBlendFunc.dAlphaFactor);
-            }
-
-            shaderSetColor(color);
-            shaderSetAlpha(alpha);
+            p.texColorEnabled = true;
+            p.color = userState.color;
+            p.color.r *= userState.colorFactor.r;
+            p.color.g *= userState.colorFactor.g;
+            p.color.b *= userState.colorFactor.b;
+            p.blendFunc = userState.autoBlendFunc ? defaultBlendFunc : userState.customBlendFunc;
+        }
+
+        /* Texture has premultiplied alpha */
+        else if (userState.texture.get() && userState.texture->premultipliedAlpha() && userState.autoBlendFunc)
+        {
+            p.premultipliedAlpha = true;
+            p.color.r = userState.colorFactor.r * p.alpha;
+            p.color.g = userState.colorFactor.g * p.alpha;
+            p.color.b = userState.colorFactor.b * p.alpha;
+            p.blendFunc = premultipliedBlendFunc;
         }
 
         /* Normal texture */
         else
         {
-            shaderSetTexColorEnabled(false);
-
-            /* Texture has premultiplied alpha */
-            if (userState.texture.get() && userState.texture->premultipliedAlpha())
-            {
-                if (userState.autoBlendFunc)
-                {
-                    LRGBF colorFactor;
-                    const Float32 alpha { userState.alpha * userState.colorFactor.a };
-                    colorFactor.r = userState.colorFactor.r * alpha;
-                    colorFactor.g = userState.colorFactor.g * alpha;
-                    colorFactor.b = userState.colorFactor.b * alpha;
-                    shaderSetPremultipliedAlpha(true);
-                    glBlendFuncSeparate(GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-                    shaderSetColor(colorFactor);
-                    shaderSetAlpha(alpha);
-                }
-                else
-                {
-                    const LRGBF colorFactor {
-                        userState.colorFactor.r,
-                        userState.colorFactor.g,
-                        userState.colorFactor.b
-                    };
-                    const Float32 alpha { userState.alpha * userState.colorFactor.a };
-                    shaderSetPremultipliedAlpha(false);
-                    glBlendFuncSeparate(userState.customBlendFunc.sRGBFactor,
-                                        userState.customBlendFunc.dRGBFactor,
-                                        userState.customBlendFunc.sAlphaFactor,
-                                        userState.customBlendFunc.dAlphaFactor);
-                    shaderSetColor(colorFactor);
-                    shaderSetAlpha(alpha);
-                }
-            }
-            else
-            {
-                const LRGBF colorFactor {
-                    userState.colorFactor.r,
-                    userState.colorFactor.g,
-                    userState.colorFactor.b
-                };
-                const Float32 alpha { userState.alpha * userState.colorFactor.a };
-                shaderSetPremultipliedAlpha(false);
-
-                if (userState.autoBlendFunc)
-                {
-                    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-                }
-                else
-                {
-                    glBlendFuncSeparate(userState.customBlendFunc.sRGBFactor,
-                                        userState.customBlendFunc.dRGBFactor,
-                                        userState.customBlendFunc.sAlphaFactor,
-                                        userState.customBlendFunc.dAlphaFactor);
-                }
-
-                shaderSetColor(colorFactor);
-                shaderSetAlpha(alpha);
-            }
+            p.color = { userState.colorFactor.r, userState.colorFactor.g, userState.colorFactor.b };
+            p.blendFunc = userState.autoBlendFunc ? defaultBlendFunc : userState.customBlendFunc;
         }
     }
 
     /* Solid color mode */
     else
     {
-        LRGBF color { userState.color };
-        Float32 alpha { userState.alpha };
-
-        alpha *= userState.colorFactor.a;
-        color.r *= userState.colorFactor.r;
-        color.g *= userState.colorFactor.g;
-        color.b *= userState.colorFactor.b;
+        p.color = userState.color;
+        p.color.r *= userState.colorFactor.r;
+        p.color.g *= userState.colorFactor.g;
+        p.color.b *= userState.colorFactor.b;
 
         if (userState.autoBlendFunc)
         {
-            color.r *= alpha;
-            color.g *= alpha;
-            color.b *= alpha;
-            glBlendFuncSeparate(GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+            p.color.r *= p.alpha;
+            p.color.g *= p.alpha;
+            p.color.b *= p.alpha;
+            p.blendFunc = premultipliedBlendFunc;
+            p.opaqueFill = p.alpha >= 1.f;
         }
         else
+            p.blendFunc = userState.customBlendFunc;
+    }
+
+    return p;
+}
+
+void applyBlendingParams(const BlendingParams &p) noexcept
+{
+    shaderSetMode(p.mode);
+    shaderSetTexColorEnabled(p.texColorEnabled);
+    shaderSetPremultipliedAlpha(p.premultipliedAlpha);
+    shaderSetColorFactorEnabled(p.colorFactorEnabled);
+    glBlendFuncSeparate(p.blendFunc.sRGBFactor,
+                        p.blendFunc.dRGBFactor,
+                        p.blendFunc.sAlphaFactor,
+                        p.blendFunc.dAlphaFactor);
+    shaderSetColor(p.color);
+    shaderSetAlpha(p.alpha);
+}
+
+void updateBlendingParams() noexcept
+{
+    needsBlendFuncUpdate = false;
+    currentBlending = resolveBlendingParams();
+    applyBlendingParams(currentBlending);
+}
+
+bool canClear(const BlendingParams &p, Int32 n) const noexcept
+{
+    return p.opaqueFill && n <= LPAINTER_CLEAR_MAX_BOXES;
+}
+
+// Fills the boxes (compositor-global coords) with glClear(), the scissor box is left undefined
+void clearBoxes(const LBox *boxes, Int32 n, const LRGBF &color) noexcept
+{
+    glClearColor(color.r, color.g, color.b, 1.f);
+
+    for (Int32 i = 0; i < n; i++)
+    {
+        Int32 x { boxes[i].x1 };
+        Int32 y { boxes[i].y1 };
+        Int32 w { boxes[i].x2 - boxes[i].x1 };
+        Int32 h { boxes[i].y2 - boxes[i].y1 };
+        toFramebufferPixels(x, y, w, h);
+
+        if (w <= 0 || h <= 0)
+            continue;
+
+        glScissor(x, y, w, h);
+        glClear(GL_COLOR_BUFFER_BIT);
+        stats.clearCalls++;
+    }
+
+    glClearColor(clearColor.r, clearColor.g, clearColor.b, clearColor.a);
+}
+
+/* Frame snapshots (LOutput::enableFrameSnapshots())
+ *
+ * While recording, everything drawn into the output framebuffer through the LPainter API is resolved
+ * into plain GL values (texture IDs, vertices, uniforms) and stored in a command list, which is later
+ * replayed without holding the compositor lock. Drawing into other framebuffers (e.g. nested LSceneViews)
+ * is still executed immediately. */
+
+struct SnapshotCommand
+{
+    enum Type : UInt8
+    {
+        BindProgram,
+        BindFramebuffer,
+        Viewport,
+        Blending,
+        EnableBlend,
+        DisableBlend,
+        BlendFunc,
+        BindTexture,
+        Draw,
+        ClearColor,
+        Clear
+    } type;
+
+    GLuint id { 0 };
+    GLenum target { 0 };
+    bool flag { false };
+    GLint first { 0 };
+    GLsizei count { 0 };
+    LBox box {};
+    LRGBAF color {};
+    BlendingParams blending {};
+};
+
+struct FrameSnapshot
+{
+    std::vector<SnapshotCommand> commands;
+    std::vector<GLfloat> vertices;
+    LBox viewport {};
+    bool recording { false };
+    bool deferring { false };
+} snapshot;
+
+void beginFrameSnapshot() noexcept
+{
+    snapshot.commands.clear();
+    snapshot.vertices.clear();
+    snapshot.viewport = {};
+    snapshot.recording = true;
+    snapshot.deferring = false;
+}
+
+void endFrameSnapshot() noexcept
+{
+    snapshot.recording = false;
+    snapshot.deferring = false;
+    needsBlendFuncUpdate = true;
+}
+
+void setDeferring(bool deferring) noexcept
+{
+    if (snapshot.deferring == deferring)
+        return;
+
+    snapshot.deferring = deferring;
+
+    // Each side has its own view of the GL state
+    needsBlendFuncUpdate = true;
+}
+
+void enableBlending(bool enabled) noexcept
+{
+    if (snapshot.deferring)
+        snapshot.commands.push_back({ .type = enabled ? SnapshotCommand::EnableBlend : SnapshotCommand::DisableBlend });
+    else if (enabled)
+        glEnable(GL_BLEND);
+    else
+        glDisable(GL_BLEND);
+}
+
+void recordViewport(const LBox &box) noexcept
+{
+    if (snapshot.viewport.x1 == box.x1 && snapshot.viewport.y1 == box.y1 &&
+        snapshot.viewport.x2 == box.x2 && snapshot.viewport.y2 == box.y2)
+        return;
+
+    snapshot.viewport = box;
+    snapshot.commands.push_back({ .type = SnapshotCommand::Viewport, .box = box });
+}
+
+void recordBoxes(const LBox *boxes, Int32 n) noexcept
+{
+    if (needsBlendFuncUpdate)
+    {
+        needsBlendFuncUpdate = false;
+        snapshot.commands.push_back({ .type = SnapshotCommand::Blending, .blending = resolveBlendingParams() });
+    }
+
+    Int32 vpX { fb->rect().x() };
+    Int32 vpY { fb->rect().y() };
+    Int32 vpW { fb->rect().w() };
+    Int32 vpH { fb->rect().h() };
+    toFramebufferPixels(vpX, vpY, vpW, vpH);
+
+    if (vpW <= 0 || vpH <= 0)
+        return;
+
+    // The user state is never LegacyMode and replays apply it, so the quads never need legacy UVs
+    const bool textured { userState.mode == TextureMode };
+    const GLint first ( snapshot.vertices.size() / 4 );
+    const GLsizei count { appendQuads(snapshot.vertices, boxes, n, vpX, vpY, vpW, vpH, textured) };
+
+    if (count == 0)
+        return;
+
+    recordViewport({vpX, vpY, vpX + vpW, vpY + vpH});
+    snapshot.commands.push_back({ .type = SnapshotCommand::Draw, .flag = textured, .first = first, .count = count });
+}
+
+void replayFrameSnapshot() noexcept
+{
+    resetGLState();
+
+    for (const SnapshotCommand &cmd : snapshot.commands)
+    {
+        switch (cmd.type)
         {
-            glBlendFuncSeparate(userState.customBlendFunc.sRGBFactor,
-                                userState.customBlendFunc.dRGBFactor,
-                                userState.customBlendFunc.sAlphaFactor,
-                                userState.customBlendFunc.dAlphaFactor);
+        case SnapshotCommand::BindProgram:
+            resetGLState();
+            break;
+        case SnapshotCommand::BindFramebuffer:
+            glBindFramebuffer(GL_FRAMEBUFFER, cmd.id);
+            break;
+        case SnapshotCommand::Viewport:
+            glScissor(cmd.box.x1, cmd.box.y1, cmd.box.x2 - cmd.box.x1, cmd.box.y2 - cmd.box.y1);
+            glViewport(cmd.box.x1, cmd.box.y1, cmd.box.x2 - cmd.box.x1, cmd.box.y2 - cmd.box.y1);
+            break;
+        case SnapshotCommand::Blending:
+            applyBlendingParams(cmd.blending);
+            break;
+        case SnapshotCommand::EnableBlend:
+            glEnable(GL_BLEND);
+            break;
+        case SnapshotCommand::DisableBlend:
+            glDisable(GL_BLEND);
+            break;
+        case SnapshotCommand::BlendFunc:
+            glBlendFuncSeparate(cmd.blending.blendFunc.sRGBFactor,
+                                cmd.blending.blendFunc.dRGBFactor,
+                                cmd.blending.blendFunc.sAlphaFactor,
+                                cmd.blending.blendFunc.dAlphaFactor);
+            break;
+        case SnapshotCommand::BindTexture:
+            switchTarget(cmd.target);
+            glActiveTexture(GL_TEXTURE0);
+            shaderSetActiveTexture(0);
+            shaderSetHas90Deg(cmd.flag);
+            glBindTexture(cmd.target, cmd.id);
+            glTexParameteri(cmd.target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(cmd.target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(cmd.target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(cmd.target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            break;
+        case SnapshotCommand::Draw:
+            if (cmd.flag)
+                shaderSetMode(BatchedTextureMode);
+            bindVariant();
+            glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, &snapshot.vertices[cmd.first * 4]);
+            glDrawArrays(GL_TRIANGLES, 0, cmd.count);
+            stats.drawCalls++;
+            break;
+        case SnapshotCommand::ClearColor:
+            clearColor = cmd.color;
+            glClearColor(cmd.color.r, cmd.color.g, cmd.color.b, cmd.color.a);
+            break;
+        case SnapshotCommand::Clear:
+            glDisable(GL_BLEND);
+            glScissor(cmd.box.x1, cmd.box.y1, cmd.box.x2 - cmd.box.x1, cmd.box.y2 - cmd.box.y1);
+            glViewport(cmd.box.x1, cmd.box.y1, cmd.box.x2 - cmd.box.x1, cmd.box.y2 - cmd.box.y1);
+            glClear(GL_COLOR_BUFFER_BIT);
+            glEnable(GL_BLEND);
+            break;
         }
+    }
+
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, square);
+    shaderSetMode(TextureMode);
+    needsBlendFuncUpdate = true;
+}
+
+/* Sorted draw passes (opt-in with LOUVRE_SORTED_DRAW_PASSES=1)
+ *
+ * LSceneView wraps its opaque and translucent passes with beginDrawPass() and endDrawPass(). Draws issued in
+ * between are resolved into vertices and state (as in frame snapshots) and submitted when the pass ends.
+ * Opaque draws never overlap, so they are sorted by (program, texture). Translucent draws keep their order.
+ * In both cases consecutive draws with the same state are merged and redundant state changes are skipped.
+ * Opaque color draws with few boxes are stored as glClear() boxes instead (see canClear()).
+ * Calls that may be mixed with the user's own GL commands (bindProgram(), bindFramebuffer(), setViewport()
+ * and clearScreen()) submit the pending draws first. */
+
+struct PassDraw
+{
+    BlendingParams blending;
+    GLuint texture;
+    GLenum target;
+    bool has90deg;
+    UInt8 variantKey;
+
+    // Filled with glClear(), first and count refer to DrawPass::clearBoxes
+    bool clear;
+    GLint first;
+    GLsizei count;
+};
+
+// Range of merged draws in DrawPass::replayVertices
+struct PassBatch
+{
+    UInt32 draw;
+    GLint first;
+    GLsizei count;
+};
+
+struct DrawPass
+{
+    std::vector<PassDraw> draws;
+    std::vector<GLfloat> vertices;
+    std::vector<LBox> clearBoxes;
+    std::vector<UInt32> order;
+    std::vector<PassBatch> batches;
+    std::vector<GLfloat> replayVertices;
+    LBox viewport {};
 
-        shaderSetColor(color);
-        shaderSetAlpha(alpha);
+    // User state while recording
+    BlendingParams blending {};
+    GLuint texture { 0 };
+    GLenum target { GL_TEXTURE_2D };
+    bool has90deg { false };
+
+    // State changes the recorded commands would have issued
+    Int32 lastVariantKey { -1 };
+    UInt32 programChanges { 0 };
+    UInt32 textureBinds { 0 };
+    UInt32 blendingChanges { 0 };
+
+    bool enabled { false };
+    bool recording { false };
+    bool opaque { false };
+} pass;
+
+// Blending must be already disabled for opaque passes
+void beginDrawPass(bool opaque) noexcept
+{
+    if (!pass.enabled || pass.recording || snapshot.deferring || !fb)
+        return;
+
+    pass.recording = true;
+    pass.opaque = opaque;
+    pass.draws.clear();
+    pass.vertices.clear();
+    pass.clearBoxes.clear();
+    pass.texture = userState.texture.get() ? userState.texture->id(output) : 0;
+    pass.target = textureTarget;
+    pass.has90deg = currentState->has90deg;
+    pass.lastVariantKey = -1;
+    pass.programChanges = 0;
+    pass.textureBinds = 0;
+    pass.blendingChanges = 0;
+    needsBlendFuncUpdate = true;
+}
+
+// Sorts, merges and submits the recorded draws
+void endDrawPass() noexcept;
+
+void recordPassBoxes(const LBox *boxes, Int32 n) noexcept
+{
+    if (needsBlendFuncUpdate)
+    {
+        needsBlendFuncUpdate = false;
+        pass.blending = resolveBlendingParams();
+        pass.blendingChanges++;
     }
+
+    Int32 vpX { fb->rect().x() };
+    Int32 vpY { fb->rect().y() };
+    Int32 vpW { fb->rect().w() };
+    Int32 vpH { fb->rect().h() };
+    toFramebufferPixels(vpX, vpY, vpW, vpH);
+
+    if (vpW <= 0 || vpH <= 0)
+        return;
+
+    pass.viewport = {vpX, vpY, vpX + vpW, vpY + vpH};
+
+    if (canClear(pass.blending, n))
+    {
+        const GLint first ( pass.clearBoxes.size() );
+
+        for (Int32 i = 0; i < n; i++)
+        {
+            Int32 x { boxes[i].x1 };
+            Int32 y { boxes[i].y1 };
+            Int32 w { boxes[i].x2 - boxes[i].x1 };
+            Int32 h { boxes[i].y2 - boxes[i].y1 };
+            toFramebufferPixels(x, y, w, h);
+
+            if (w > 0 && h > 0)
+                pass.clearBoxes.push_back({x, y, x + w, y + h});
+        }
+
+        const GLsizei count ( pass.clearBoxes.size() - first );
+
+        if (count > 0)
+            pass.draws.push_back({
+                .blending = pass.blending,
+                .texture = 0,
+                .target = GL_TEXTURE_2D,
+                .has90deg = false,
+                .variantKey = ColorMode,
+                .clear = true,
+                .first = first,
+                .count = count });
+
+        return;
+    }
+
+    // Resolved from the user state, never LegacyMode (see recordBoxes())
+    const bool textured { pass.blending.mode == TextureMode };
+    const GLint first ( pass.vertices.size() / 4 );
+    const GLsizei count { appendQuads(pass.vertices, boxes, n, vpX, vpY, vpW, vpH, textured) };
+
+    if (count == 0)
+        return;
+
+    PassDraw draw
+    {
+        .blending = pass.blending,
+        .texture = textured ? pass.texture : 0,
+        .target = textured ? pass.target : GLenum(GL_TEXTURE_2D),
+        .has90deg = textured && pass.has90deg,
+        .variantKey = 0,
+        .clear = false,
+        .first = first,
+        .count = count
+    };
+
+    // UVs are part of the vertices
+    if (textured)
+        draw.blending.mode = BatchedTextureMode;
+
+    draw.variantKey = makeVariantKey(draw.blending.mode,
+                                     draw.has90deg,
+                                     draw.target == GL_TEXTURE_EXTERNAL_OES,
+                                     draw.blending.alpha,
+                                     draw.blending.texColorEnabled,
+                                     draw.blending.premultipliedAlpha,
+                                     draw.blending.colorFactorEnabled);
+
+    if (pass.lastVariantKey != draw.variantKey)
+    {
+        pass.lastVariantKey = draw.variantKey;
+        pass.programChanges++;
+    }
+
+    pass.draws.push_back(draw);
+}
+
+// The blend func is ignored in opaque passes, blending is disabled
+static bool sameBlendingParams(const BlendingParams &a, const BlendingParams &b, bool compareBlendFunc) noexcept
+{
+    if (a.mode != b.mode ||
+        a.color != b.color ||
+        a.alpha != b.alpha ||
+        a.texColorEnabled != b.texColorEnabled ||
+        a.premultipliedAlpha != b.premultipliedAlpha ||
+        a.colorFactorEnabled != b.colorFactorEnabled)
+        return false;
+
+    return !compareBlendFunc ||
+        (a.blendFunc.sRGBFactor == b.blendFunc.sRGBFactor &&
+         a.blendFunc.dRGBFactor == b.blendFunc.dRGBFactor &&
+         a.blendFunc.sAlphaFactor == b.blendFunc.sAlphaFactor &&
+         a.blendFunc.dAlphaFactor == b.blendFunc.dAlphaFactor);
+}
+
+bool canMergePassDraws(const PassDraw &a, const PassDraw &b) const noexcept
+{
+    return !a.clear && !b.clear &&
+           a.variantKey == b.variantKey &&
+           a.texture == b.texture &&
+           a.target == b.target &&
+           a.has90deg == b.has90deg &&
+           sameBlendingParams(a.blending, b.blending, !pass.opaque);
 }
 };
 
@@ -3,6 +3,8 @@
 
 #include <LSurface.h>
 #include <LPointer.h>
+#include <LPointerMoveEvent.h>
+#include <LTimer.h>
 #include <LBitset.h>
 
 using namespace Louvre;
@@ -15,11 +17,24 @@ LPRIVATE_CLASS(LPointer)
         NaturalScrollY           = static_cast<UInt32>(1) << 1,
         PendingSwipeEndEvent     = static_cast<UInt32>(1) << 2,
         PendingPinchEndEvent     = static_cast<UInt32>(1) << 3,
-        PendingHoldEndEvent      = static_cast<UInt32>(1) << 4
+        PendingHoldEndEvent      = static_cast<UInt32>(1) << 4,
+        MotionCoalescing         = static_cast<UInt32>(1) << 5,
+        PendingMotion            = static_cast<UInt32>(1) << 6,
+        DispatchingMotion        = static_cast<UInt32>(1) << 7
     };
 
     void sendLeaveEvent(LSurface *surface) noexcept;
 
+    // Accumulates the absolute motion of the event (see LPointer::enableMotionCoalescing())
+    void coalesceMotion(const LPointerMoveEvent &event) noexcept;
+
+    // Notifies the accumulated motion, must be called before notifying other pointer events
+    void dispatchPendingMotion() noexcept;
+
+    LPointerMoveEvent pendingMotion;
+    LTimer pendingMotionTimer;
+    UInt32 lastMotionDispatchMs { 0 };
+
     LWeak<LSurface> focus;
     LWeak<LSurface> draggingSurface;
     std::vector<LPointerButtonEvent::Button> pressedButtons;
@@ -0,0 +1,249 @@
+#include <private/LProgramCache.h>
+#include <LOpenGL.h>
+#include <LUtils.h>
+#include <LLog.h>
+#include <EGL/egl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+
+using namespace Louvre;
+
+// Increase if the file layout changes
+#define LPROGRAMCACHE_FILE_VERSION 1
+
+struct ProgramBinaryHeader
+{
+    char magic[4];
+    UInt32 version;
+    UInt32 format;
+    UInt32 size;
+};
+
+GLuint LProgramCache::link(const char *vertexSource, const char *fragmentSource) noexcept
+{
+    const char *exts { (const char*)glGetString(GL_EXTENSIONS) };
+    GLint formats { 0 };
+
+    if (LOpenGL::hasExtension(exts, "GL_OES_get_program_binary"))
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &formats);
+
+    /* Held while compiling, so painters of other outputs initialized at the same time
+     * wait and reuse the binary instead of compiling the same sources */
+    std::lock_guard<std::mutex> lock { m_mutex };
+    initialize();
+
+    if (formats <= 0 || !m_glGetProgramBinaryOES || !m_glProgramBinaryOES)
+    {
+        misses++;
+        return compile(vertexSource, fragmentSource);
+    }
+
+    // Binaries are only valid for the same driver
+    UInt64 key { 14695981039346656037ULL };
+    key = hash(key, (const char*)glGetString(GL_VENDOR));
+    key = hash(key, (const char*)glGetString(GL_RENDERER));
+    key = hash(key, (const char*)glGetString(GL_VERSION));
+    key = hash(key, (const char*)glGetString(GL_SHADING_LANGUAGE_VERSION));
+    key = hash(key, vertexSource);
+    key = hash(key, fragmentSource);
+
+    auto it { m_binaries.find(key) };
+
+    if (it == m_binaries.end() && m_diskEnabled)
+    {
+        Binary binary;
+
+        if (read(key, binary))
+            it = m_binaries.emplace(key, std::move(binary)).first;
+    }
+
+    GLuint program;
+    GLint linked { 0 };
+
+    if (it != m_binaries.end())
+    {
+        program = glCreateProgram();
+        m_glProgramBinaryOES(program, it->second.format, it->second.data.data(), it->second.data.size());
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+        if (linked)
+        {
+            hits++;
+            return program;
+        }
+
+        // Rejected by the driver (e.g. updated without changing its version string), replaced below
+        glDeleteProgram(program);
+        m_binaries.erase(it);
+    }
+
+    misses++;
+    program = compile(vertexSource, fragmentSource);
+
+    if (!program)
+        return 0;
+
+    GLint length { 0 };
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH_OES, &length);
+
+    if (length <= 0)
+        return program;
+
+    Binary binary;
+    binary.data.resize(length);
+    GLsizei written { 0 };
+    m_glGetProgramBinaryOES(program, length, &written, &binary.format, binary.data.data());
+
+    if (written <= 0)
+        return program;
+
+    binary.data.resize(written);
+
+    if (m_diskEnabled)
+        write(key, binary);
+
+    m_binaries[key] = std::move(binary);
+    return program;
+}
+
+void LProgramCache::initialize() noexcept
+{
+    if (m_initialized)
+        return;
+
+    m_initialized = true;
+    m_glGetProgramBinaryOES = (PFNGLGETPROGRAMBINARYOESPROC) eglGetProcAddress("glGetProgramBinaryOES");
+    m_glProgramBinaryOES = (PFNGLPROGRAMBINARYOESPROC) eglGetProcAddress("glProgramBinaryOES");
+
+    const char *env { getenv("LOUVRE_PROGRAM_CACHE") };
+
+    if (env && atoi(env) == 0)
+        return;
+
+    std::filesystem::path base { getenvString("XDG_CACHE_HOME") };
+
+    if (base.empty())
+    {
+        base = getenvString("HOME");
+
+        if (base.empty())
+            return;
+
+        base /= ".cache";
+    }
+
+    m_dir = base / "louvre" / "programs";
+    std::error_code ec;
+    std::filesystem::create_directories(m_dir, ec);
+
+    if (ec)
+    {
+        LLog::warning("[LProgramCache::initialize] Failed to create %s, program binaries won't be stored on disk.", m_dir.c_str());
+        return;
+    }
+
+    m_diskEnabled = true;
+}
+
+bool LProgramCache::read(UInt64 key, Binary &binary) noexcept
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    const std::filesystem::path path { m_dir / name };
+    FILE *fp { fopen(path.c_str(), "rb") };
+
+    if (!fp)
+        return false;
+
+    ProgramBinaryHeader header;
+    bool ret { false };
+
+    if (fread(&header, sizeof(header), 1, fp) == 1 &&
+        memcmp(header.magic, "LPBC", 4) == 0 &&
+        header.version == LPROGRAMCACHE_FILE_VERSION &&
+        header.size > 0)
+    {
+        binary.format = header.format;
+        binary.data.resize(header.size);
+        ret = fread(binary.data.data(), header.size, 1, fp) == 1;
+    }
+
+    fclose(fp);
+
+    if (!ret)
+    {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+
+    return ret;
+}
+
+void LProgramCache::write(UInt64 key, const Binary &binary) noexcept
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    const std::filesystem::path path { m_dir / name };
+
+    // Renamed once complete, other compositor instances may be reading the same dir
+    std::filesystem::path tmpPath { path };
+    tmpPath += ".tmp" + std::to_string(getpid());
+
+    FILE *fp { fopen(tmpPath.c_str(), "wb") };
+
+    if (!fp)
+        return;
+
+    ProgramBinaryHeader header { { 'L', 'P', 'B', 'C' }, LPROGRAMCACHE_FILE_VERSION, binary.format, UInt32(binary.data.size()) };
+    const bool ok {
+        fwrite(&header, sizeof(header), 1, fp) == 1 &&
+        fwrite(binary.data.data(), binary.data.size(), 1, fp) == 1 };
+
+    std::error_code ec;
+
+    if (fclose(fp) == 0 && ok)
+        std::filesystem::rename(tmpPath, path, ec);
+    else
+        std::filesystem::remove(tmpPath, ec);
+}
+
+UInt64 LProgramCache::hash(UInt64 h, const char *str) noexcept
+{
+    // FNV-1a, including the null terminator so consecutive strings can't be confused
+    if (str)
+        for (; *str; str++)
+            h = (h ^ UInt8(*str)) * 1099511628211ULL;
+
+    return h * 1099511628211ULL;
+}
+
+GLuint LProgramCache::compile(const char *vertexSource, const char *fragmentSource) noexcept
+{
+    const GLuint vShader { LOpenGL::compileShader(GL_VERTEX_SHADER, vertexSource) };
+    const GLuint fShader { LOpenGL::compileShader(GL_FRAGMENT_SHADER, fragmentSource) };
+    GLuint program { 0 };
+    GLint linked { 0 };
+
+    if (vShader && fShader)
+    {
+        program = glCreateProgram();
+        glAttachShader(program, vShader);
+        glAttachShader(program, fShader);
+        glBindAttribLocation(program, 0, "vertexPosition");
+        glLinkProgram(program);
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    }
+
+    // Freed along with the program
+    glDeleteShader(vShader);
+    glDeleteShader(fShader);
+
+    if (!linked && program)
+    {
+        glDeleteProgram(program);
+        program = 0;
+    }
+
+    return program;
+}
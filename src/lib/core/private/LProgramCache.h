@@ -0,0 +1,58 @@
+#ifndef LPROGRAMCACHE_H
+#define LPROGRAMCACHE_H
+
+#include <LNamespaces.h>
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#include <filesystem>
+#include <unordered_map>
+#include <mutex>
+#include <vector>
+
+namespace Louvre
+{
+    /* Program binaries (GL_OES_get_program_binary) of the LPainter programs, shared by all rendering threads
+     * and stored under $XDG_CACHE_HOME/louvre/programs, so only the first context of the first run compiles
+     * the shaders from source. Each context still gets its own program objects, because uniform values are
+     * part of the program state and each painter updates them from its own thread. */
+    class LProgramCache
+    {
+    public:
+        LProgramCache() = default;
+        LProgramCache(const LProgramCache&) = delete;
+        LProgramCache &operator=(const LProgramCache&) = delete;
+
+        /* Any thread with a current context. Returns a linked program or 0 on failure.
+         * Attribute 0 is bound to "vertexPosition" as expected by LPainter */
+        GLuint link(const char *vertexSource, const char *fragmentSource) noexcept;
+
+        // Programs created from a cached binary or compiled from source
+        UInt32 hits { 0 };
+        UInt32 misses { 0 };
+
+    private:
+        struct Binary
+        {
+            GLenum format { 0 };
+            std::vector<UInt8> data;
+        };
+
+        std::mutex m_mutex;
+        std::unordered_map<UInt64, Binary> m_binaries;
+        PFNGLGETPROGRAMBINARYOESPROC m_glGetProgramBinaryOES { nullptr };
+        PFNGLPROGRAMBINARYOESPROC m_glProgramBinaryOES { nullptr };
+        bool m_initialized { false };
+        bool m_diskEnabled { false };
+        std::filesystem::path m_dir;
+
+        // Called with the mutex locked
+        void initialize() noexcept;
+        bool read(UInt64 key, Binary &binary) noexcept;
+        void write(UInt64 key, const Binary &binary) noexcept;
+
+        static UInt64 hash(UInt64 h, const char *str) noexcept;
+        static GLuint compile(const char *vertexSource, const char *fragmentSource) noexcept;
+    };
+}
+
+#endif // LPROGRAMCACHE_H
@@ -0,0 +1,120 @@
+#include <private/LRenderTargetPool.h>
+#include <private/LTexturePrivate.h>
+#include <LLog.h>
+#include <cstdlib>
+
+using namespace Louvre;
+
+static UInt64 targetBytes(const LSize &sizeB) noexcept
+{
+    return UInt64(sizeB.w()) * UInt64(sizeB.h()) * 4;
+}
+
+bool LRenderTargetPool::acquire(const LSize &sizeB, Target &target) noexcept
+{
+    // Most recently used first
+    for (auto it = m_idle.rbegin(); it != m_idle.rend(); it++)
+    {
+        if (it->sizeB == sizeB)
+        {
+            target = *it;
+            idleBytes -= targetBytes(sizeB);
+            m_idle.erase(std::next(it).base());
+            hits++;
+            return true;
+        }
+    }
+
+    misses++;
+    trim();
+
+    target.sizeB = sizeB;
+    glGenFramebuffers(1, &target.framebufferId);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.framebufferId);
+    glGenTextures(1, &target.textureId);
+    LTexture::LTexturePrivate::setTextureParams(target.textureId, GL_TEXTURE_2D, GL_REPEAT, GL_REPEAT, GL_LINEAR, GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, sizeB.w(), sizeB.h(), 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.textureId, 0);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        LLog::error("[LRenderTargetPool::acquire] glCheckFramebufferStatus failed.");
+        destroy(target);
+        target = Target();
+        return false;
+    }
+
+    return true;
+}
+
+void LRenderTargetPool::release(const Target &target) noexcept
+{
+    if (target.framebufferId == 0)
+        return;
+
+    m_idle.push_back(target);
+    idleBytes += targetBytes(target.sizeB);
+}
+
+void LRenderTargetPool::trim() noexcept
+{
+    const UInt64 max { budget() };
+
+    while (!m_idle.empty() && idleBytes > max)
+    {
+        idleBytes -= targetBytes(m_idle.front().sizeB);
+        destroy(m_idle.front());
+        m_idle.erase(m_idle.begin());
+        evictions++;
+    }
+}
+
+void LRenderTargetPool::clear() noexcept
+{
+    while (!m_idle.empty())
+    {
+        destroy(m_idle.back());
+        m_idle.pop_back();
+    }
+
+    idleBytes = 0;
+
+    if (m_scratchFramebuffer)
+    {
+        glDeleteFramebuffers(1, &m_scratchFramebuffer);
+        m_scratchFramebuffer = 0;
+    }
+}
+
+GLuint LRenderTargetPool::scratchFramebuffer() noexcept
+{
+    if (!m_scratchFramebuffer)
+        glGenFramebuffers(1, &m_scratchFramebuffer);
+
+    return m_scratchFramebuffer;
+}
+
+UInt64 LRenderTargetPool::budget() noexcept
+{
+    static Int64 max { -1 };
+
+    if (max == -1)
+    {
+        // MiB
+        const char *env { getenv("LOUVRE_RENDER_TARGET_POOL_SIZE") };
+        max = env ? atoi(env) : 64;
+
+        if (max < 0)
+            max = 64;
+
+        max *= 1024 * 1024;
+    }
+
+    return max;
+}
+
+void LRenderTargetPool::destroy(const Target &target) noexcept
+{
+    glDeleteFramebuffers(1, &target.framebufferId);
+    glDeleteTextures(1, &target.textureId);
+}
@@ -0,0 +1,61 @@
+#ifndef LRENDERTARGETPOOL_H
+#define LRENDERTARGETPOOL_H
+
+#include <LNamespaces.h>
+#include <LSize.h>
+#include <GLES2/gl2.h>
+#include <vector>
+
+namespace Louvre
+{
+    /* Per-thread cache of framebuffer + texture pairs released by LRenderBuffers, so resizing
+     * or recreating offscreen scenes reuses GPU storage instead of allocating it each frame.
+     * Idle targets are evicted in LRU order once they exceed LOUVRE_RENDER_TARGET_POOL_SIZE. */
+    class LRenderTargetPool
+    {
+    public:
+        struct Target
+        {
+            GLuint framebufferId { 0 };
+            GLuint textureId { 0 };
+            LSize sizeB;
+        };
+
+        LRenderTargetPool() = default;
+        LRenderTargetPool(const LRenderTargetPool&) = delete;
+        LRenderTargetPool &operator=(const LRenderTargetPool&) = delete;
+
+        // Owner thread only, returns false if the framebuffer could not be created
+        bool acquire(const LSize &sizeB, Target &target) noexcept;
+
+        // Any thread (with the compositor locked), GL objects are not touched
+        void release(const Target &target) noexcept;
+
+        // Owner thread only, destroys idle targets exceeding the budget
+        void trim() noexcept;
+
+        // Owner thread only, destroys all idle targets
+        void clear() noexcept;
+
+        /* Framebuffer reused for temporary attachments (e.g. LTexture::copy()).
+         * Textures must be detached before it is unbound */
+        GLuint scratchFramebuffer() noexcept;
+
+        UInt64 hits { 0 };
+        UInt64 misses { 0 };
+        UInt64 evictions { 0 };
+
+        // Memory held by idle targets in bytes
+        UInt64 idleBytes { 0 };
+
+        static UInt64 budget() noexcept;
+
+    private:
+        // Least recently used first
+        std::vector<Target> m_idle;
+        GLuint m_scratchFramebuffer { 0 };
+        void destroy(const Target &target) noexcept;
+    };
+}
+
+#endif // LRENDERTARGETPOOL_H
@@ -0,0 +1,44 @@
+#ifndef LSCENELAYER_H
+#define LSCENELAYER_H
+
+#include <LRenderBuffer.h>
+#include <LRegion.h>
+
+// Frames of an output a subtree must remain unchanged before being promoted, doubled after each demotion
+#define LSCENE_LAYER_STABLE_FRAMES 8
+#define LSCENE_LAYER_MAX_DEMOTIONS 5
+
+// Min number of mapped renderable views in a subtree to be worth caching
+#define LSCENE_LAYER_MIN_VIEWS 4
+
+// Max layers per output
+#define LSCENE_LAYER_MAX 8
+
+namespace Louvre
+{
+    /* Cached content of a view subtree for a single rendering thread (see LScene::enableAutoLayers()).
+     * Referenced by the LView::ViewThreadData of the subtree root, created by LSceneView::updateLayer() and
+     * destroyed by LSceneView::destroyLayer() */
+    class LSceneLayer
+    {
+    public:
+        LSceneLayer() noexcept : buffer(LSize(1, 1)) {}
+        LSceneLayer(const LSceneLayer&) = delete;
+        LSceneLayer &operator=(const LSceneLayer&) = delete;
+
+        // Content of the subtree over a transparent background, with the same pos and scale as the output
+        LRenderBuffer buffer;
+
+        // Cached regions drawn in the opaque and translucent passes, in global coords
+        LRegion opaque;
+        LRegion translucent;
+
+        // Opaque region of the views above the subtree in the current frame
+        LRegion overlay;
+
+        // False until overlay is set, layers are composited starting from the frame after their promotion
+        bool ready { false };
+    };
+}
+
+#endif // LSCENELAYER_H
@@ -1,4 +1,5 @@
 #include <private/LScenePrivate.h>
+#include <private/LCompositorPrivate.h>
 #include <LSceneTouchPoint.h>
 #include <LOutput.h>
 #include <LCompositor.h>
@@ -8,15 +9,343 @@
 #include <LCursor.h>
 #include <LUtils.h>
 #include <LLog.h>
+#include <algorithm>
+#include <cmath>
 
 using LVS = LView::LViewState;
 using LSS = LScene::LScenePrivate::State;
 
+static inline UInt64 inputIndexCellKey(Int32 x, Int32 y) noexcept
+{
+    return (static_cast<UInt64>(static_cast<UInt32>(x)) << 32) | static_cast<UInt32>(y);
+}
+
+void LScene::LScenePrivate::updateInputIndex()
+{
+    const UInt32 serial { compositor()->imp()->viewsInputSerial };
+
+    if (inputIndexSerial != serial)
+    {
+        inputIndexSerial = serial;
+        inputIndexEntries.clear();
+        inputIndexCells.clear();
+        inputIndexUnbounded.clear();
+        inputIndexViewsOrder.clear();
+
+        for (LView *dirty : inputIndexDirty)
+            dirty->m_state.remove(LVS::InputBoundsChanged);
+
+        inputIndexDirty.clear();
+        indexView(&view, false);
+        return;
+    }
+
+    if (inputIndexDirty.empty())
+        return;
+
+    // Views still modifiable without notification are added again to inputIndexDirty
+    inputIndexDirtyTmp.swap(inputIndexDirty);
+
+    for (LView *dirty : inputIndexDirtyTmp)
+        dirty->m_state.remove(LVS::InputBoundsChanged);
+
+    for (LView *dirty : inputIndexDirtyTmp)
+    {
+        bool dynamic { false };
+
+        for (LView *parent { dirty->parent() }; parent && !dynamic; parent = parent->parent())
+            dynamic = parent->repaintCalled();
+
+        reindexView(dirty, dynamic);
+    }
+
+    inputIndexDirtyTmp.clear();
+}
+
+void LScene::LScenePrivate::indexView(LView *view, bool dynamic)
+{
+    // Changes made after repaint() are not notified until the view is rendered again, this also affects children
+    if (view->repaintCalled())
+    {
+        dynamic = true;
+        view->invalidateInputBounds();
+    }
+
+    const std::vector<LView*> &views { view->childrenArray() };
+
+    for (std::vector<LView*>::const_reverse_iterator it = views.crbegin(); it != views.crend(); it++)
+        indexView(*it, dynamic);
+
+    const UInt32 index { static_cast<UInt32>(inputIndexEntries.size()) };
+    inputIndexViewsOrder[view] = index;
+    inputIndexEntries.push_back({view, {}, 0, 0, 0, 0, InputIndexEntry::None, false});
+    placeInputIndexEntry(index, dynamic);
+}
+
+void LScene::LScenePrivate::reindexView(LView *view, bool dynamic)
+{
+    const auto order { inputIndexViewsOrder.find(view) };
+
+    // Views added to the scene trigger a rebuild, see LView::setParent()
+    if (order == inputIndexViewsOrder.end())
+        return;
+
+    const UInt32 index { order->second };
+
+    if (view->repaintCalled())
+    {
+        dynamic = true;
+        view->invalidateInputBounds();
+    }
+
+    // Children may be positioned or clipped relative to the view
+    for (LView *child : view->childrenArray())
+        reindexView(child, dynamic);
+
+    placeInputIndexEntry(index, dynamic);
+}
+
+void LScene::LScenePrivate::placeInputIndexEntry(UInt32 index, bool dynamic)
+{
+    removeInputIndexEntry(index);
+
+    InputIndexEntry &entry { inputIndexEntries[index] };
+    LView *view { entry.view };
+    entry.dynamic = false;
+
+    if (!view->mapped() || !(view->pointerEventsEnabled() || view->touchEventsEnabled() || view->keyboardEventsEnabled()))
+        return;
+
+    // Cursor and drag & drop icon surfaces follow the cursor
+    if (view->type() == LView::SurfaceType)
+    {
+        const LSurface *surface { static_cast<LSurfaceView*>(view)->surface() };
+
+        if (surface && (surface->cursorRole() || surface->dndIcon()))
+            dynamic = true;
+    }
+
+    if (!dynamic && !inputBounds(view, entry.box))
+        return;
+
+    entry.dynamic = dynamic;
+
+    if (dynamic)
+    {
+        entry.placement = InputIndexEntry::Unbounded;
+        inputIndexUnbounded.push_back(index);
+        return;
+    }
+
+    entry.cx1 = entry.box.x1 >> inputIndexCellShift;
+    entry.cy1 = entry.box.y1 >> inputIndexCellShift;
+    entry.cx2 = (entry.box.x2 - 1) >> inputIndexCellShift;
+    entry.cy2 = (entry.box.y2 - 1) >> inputIndexCellShift;
+
+    if (static_cast<Int64>(entry.cx2 - entry.cx1 + 1) * static_cast<Int64>(entry.cy2 - entry.cy1 + 1) > inputIndexMaxCells)
+    {
+        entry.placement = InputIndexEntry::Unbounded;
+        inputIndexUnbounded.push_back(index);
+        return;
+    }
+
+    entry.placement = InputIndexEntry::Cells;
+
+    for (Int32 y = entry.cy1; y <= entry.cy2; y++)
+        for (Int32 x = entry.cx1; x <= entry.cx2; x++)
+            inputIndexCells[inputIndexCellKey(x, y)].push_back(index);
+}
+
+void LScene::LScenePrivate::removeInputIndexEntry(UInt32 index)
+{
+    InputIndexEntry &entry { inputIndexEntries[index] };
+
+    if (entry.placement == InputIndexEntry::Unbounded)
+        LVectorRemoveOneUnordered(inputIndexUnbounded, index);
+    else if (entry.placement == InputIndexEntry::Cells)
+    {
+        for (Int32 y = entry.cy1; y <= entry.cy2; y++)
+        {
+            for (Int32 x = entry.cx1; x <= entry.cx2; x++)
+            {
+                const auto cell { inputIndexCells.find(inputIndexCellKey(x, y)) };
+
+                if (cell == inputIndexCells.end())
+                    continue;
+
+                LVectorRemoveOneUnordered(cell->second, index);
+
+                if (cell->second.empty())
+                    inputIndexCells.erase(cell);
+            }
+        }
+    }
+
+    entry.placement = InputIndexEntry::None;
+}
+
+bool LScene::LScenePrivate::inputBounds(LView *view, LBox &box)
+{
+    // Must contain every point accepted by pointIsOverView(), a 1 px margin covers rounding and inclusive edges
+    const LPoint pos { view->pos() };
+    const LRegion *inputRegion { view->inputRegion() };
+    Float32 x1, y1, x2, y2;
+
+    if (inputRegion)
+    {
+        const LBox &extents { inputRegion->extents() };
+        x1 = extents.x1;
+        y1 = extents.y1;
+        x2 = extents.x2;
+        y2 = extents.y2;
+    }
+    else
+    {
+        const LSize size { view->size() };
+        x1 = pos.x();
+        y1 = pos.y();
+        x2 = pos.x() + size.w();
+        y2 = pos.y() + size.h();
+    }
+
+    if ((view->scalingEnabled() || view->parentScalingEnabled()) && view->scalingVector() != LSizeF(1.f, 1.f))
+    {
+        const LSizeF scaling { view->scalingVector() };
+
+        if (scaling.area() == 0.f)
+            return false;
+
+        x1 = pos.x() + x1 * scaling.w();
+        x2 = pos.x() + x2 * scaling.w();
+        y1 = pos.y() + y1 * scaling.h();
+        y2 = pos.y() + y2 * scaling.h();
+
+        if (x1 > x2)
+            std::swap(x1, x2);
+
+        if (y1 > y2)
+            std::swap(y1, y2);
+    }
+    else if (inputRegion)
+    {
+        x1 += pos.x();
+        x2 += pos.x();
+        y1 += pos.y();
+        y2 += pos.y();
+    }
+
+    box.x1 = static_cast<Int32>(std::floor(x1)) - 1;
+    box.y1 = static_cast<Int32>(std::floor(y1)) - 1;
+    box.x2 = static_cast<Int32>(std::ceil(x2)) + 1;
+    box.y2 = static_cast<Int32>(std::ceil(y2)) + 1;
+
+    const auto clip { [&box](const LRect &rect)
+    {
+        box.x1 = std::max(box.x1, rect.x() - 1);
+        box.y1 = std::max(box.y1, rect.y() - 1);
+        box.x2 = std::min(box.x2, rect.x() + rect.w() + 1);
+        box.y2 = std::min(box.y2, rect.y() + rect.h() + 1);
+    }};
+
+    if (view->clippingEnabled())
+        clip(view->clippingRect());
+
+    for (LView *v { view }; v->parent(); v = v->parent())
+        if (v->parentClippingEnabled())
+            clip(LRect(v->parent()->pos(), v->parent()->size()));
+
+    for (LSceneView *parentScene { view->parentSceneView() }; parentScene && !parentScene->isLScene(); parentScene = parentScene->parentSceneView())
+        clip(parentScene->m_fb->rect());
+
+    return box.x1 < box.x2 && box.y1 < box.y2;
+}
+
+void LScene::LScenePrivate::inputCandidatesAt(const LPointF &pos, bool includePointerFocus, std::vector<LView*> &candidates)
+{
+    updateInputIndex();
+    inputIndexQuery.clear();
+    candidates.clear();
+
+    const Int32 x { static_cast<Int32>(std::floor(pos.x())) };
+    const Int32 y { static_cast<Int32>(std::floor(pos.y())) };
+
+    const auto test { [this, x, y](UInt32 index)
+    {
+        const InputIndexEntry &entry { inputIndexEntries[index] };
+
+        if (entry.dynamic || (x >= entry.box.x1 && x < entry.box.x2 && y >= entry.box.y1 && y < entry.box.y2))
+            inputIndexQuery.push_back(index);
+    }};
+
+    const auto cell { inputIndexCells.find(inputIndexCellKey(x >> inputIndexCellShift, y >> inputIndexCellShift)) };
+
+    if (cell != inputIndexCells.end())
+        for (UInt32 index : cell->second)
+            test(index);
+
+    for (UInt32 index : inputIndexUnbounded)
+        test(index);
+
+    // Entries are stored front to back, cells are not sorted after incremental updates
+    std::sort(inputIndexQuery.begin(), inputIndexQuery.end());
+
+    for (UInt32 index : inputIndexQuery)
+        candidates.push_back(inputIndexEntries[index].view);
+
+    if (!includePointerFocus)
+        return;
+
+    // Views that may need to receive a leave event
+    const size_t hits { candidates.size() };
+
+    for (LView *view : pointerFocus)
+        if (std::find(candidates.begin(), candidates.begin() + hits, view) == candidates.begin() + hits)
+            candidates.push_back(view);
+
+    if (candidates.size() != hits)
+    {
+        // Lookups must not insert, reindexView() uses the map to find indexed views
+        const auto order { [this](const LView *view) -> UInt32
+        {
+            const auto it { inputIndexViewsOrder.find(view) };
+            return it == inputIndexViewsOrder.end() ? UINT32_MAX : it->second;
+        }};
+
+        std::sort(candidates.begin(), candidates.end(), [&order](const LView *a, const LView *b)
+        {
+            return order(a) < order(b);
+        });
+    }
+}
+
+LView *LScene::LScenePrivate::indexedViewAt(const LPoint &pos, LView::Type type, LBitset<InputFilter> flags)
+{
+    inputCandidatesAt(pos, false, viewAtCandidates);
+
+    for (LView *view : viewAtCandidates)
+    {
+        if (type != LView::UndefinedType && view->type() != type)
+            continue;
+
+        if (!((flags.check(InputFilter::Touch) && view->touchEventsEnabled()) ||
+              (flags.check(InputFilter::Pointer) && view->pointerEventsEnabled()) ||
+              (flags.check(InputFilter::Keyboard) && view->keyboardEventsEnabled())))
+            continue;
+
+        if (pointIsOverView(view, pos, InputFilter::FilterDisabled))
+            return view;
+    }
+
+    return nullptr;
+}
+
 LView *LScene::LScenePrivate::viewAt(LView *view, const LPoint &pos, LView::Type type, LBitset<InputFilter> flags)
 {
     LView *v { nullptr };
 
-    for (std::list<LView*>::const_reverse_iterator it = view->children().crbegin(); it != view->children().crend(); it++)
+    const std::vector<LView*> &views { view->childrenArray() };
+
+    for (std::vector<LView*>::const_reverse_iterator it = views.crbegin(); it != views.crend(); it++)
     {
         v = viewAt(*it, pos, type, flags);
 
@@ -111,12 +440,128 @@ bool LScene::LScenePrivate::pointClippedByParentScene(LView *view, const LPoint
     return pointClippedByParentScene(parentScene, point);
 }
 
+void LScene::LScenePrivate::handlePointerMove()
+{
+    if (inputIndexEnabled)
+        handleIndexedPointerMove();
+    else
+    {
+        state.remove(LSS::ChildrenListChanged);
+        handlePointerMove(&view);
+    }
+
+    for (LView *view : pointerMoveDone)
+        view->m_state.remove(LVS::PointerMoveDone);
+
+    pointerMoveDone.clear();
+}
+
+void LScene::LScenePrivate::handleIndexedPointerMove()
+{
+    // If a list is modified by an event handler start again, PointerMoveDone prevents resending events
+listChangedErr:
+    state.remove(LSS::ChildrenListChanged);
+    inputCandidatesAt(cursor()->pos(), true, pointerMoveCandidates);
+
+    for (LView *view : pointerMoveCandidates)
+    {
+        if (!state.check(LSS::PointerIsBlocked) && pointIsOverView(view, cursor()->pos(), InputFilter::Pointer))
+        {
+            if (view->blockPointerEnabled())
+                state.add(LSS::PointerIsBlocked);
+
+            if (!view->m_state.check(LVS::PointerMoveDone))
+            {
+                view->m_state.add(LVS::PointerMoveDone);
+                pointerMoveDone.push_back(view);
+
+                if (view->m_state.check(LVS::PointerIsOver))
+                {
+                    LVectorRemoveOne(pointerFocus, view);
+                    pointerFocus.push_back(view);
+                    currentPointerMoveEvent.localPos = viewLocalPos(view, cursor()->pos());
+                    view->pointerMoveEvent(currentPointerMoveEvent);
+
+                    if (state.check(LSS::ChildrenListChanged))
+                        goto listChangedErr;
+                }
+                else
+                {
+                    view->m_state.add(LVS::PointerIsOver);
+                    pointerFocus.push_back(view);
+                    currentPointerEnterEvent.localPos = viewLocalPos(view, cursor()->pos());
+                    view->pointerEnterEvent(currentPointerEnterEvent);
+
+                    if (state.check(LSS::ChildrenListChanged))
+                        goto listChangedErr;
+                }
+            }
+        }
+        else if (!view->m_state.check(LVS::PointerMoveDone))
+        {
+            view->m_state.add(LVS::PointerMoveDone);
+            pointerMoveDone.push_back(view);
+
+            if (view->m_state.check(LVS::PointerIsOver))
+            {
+                view->m_state.remove(LVS::PointerIsOver);
+
+                if (view->m_state.check(LVS::PendingSwipeEnd))
+                {
+                    view->m_state.remove(LVS::PendingSwipeEnd);
+                    pointerSwipeEndEvent.setCancelled(true);
+                    pointerSwipeEndEvent.setMs(currentPointerMoveEvent.ms());
+                    pointerSwipeEndEvent.setUs(currentPointerMoveEvent.us());
+                    pointerSwipeEndEvent.setSerial(LTime::nextSerial());
+                    view->pointerSwipeEndEvent(pointerSwipeEndEvent);
+
+                    if (state.check(LSS::ChildrenListChanged))
+                        goto listChangedErr;
+                }
+
+                if (view->m_state.check(LVS::PendingPinchEnd))
+                {
+                    view->m_state.remove(LVS::PendingPinchEnd);
+                    pointerPinchEndEvent.setCancelled(true);
+                    pointerPinchEndEvent.setMs(currentPointerMoveEvent.ms());
+                    pointerPinchEndEvent.setUs(currentPointerMoveEvent.us());
+                    pointerPinchEndEvent.setSerial(LTime::nextSerial());
+                    view->pointerPinchEndEvent(pointerPinchEndEvent);
+
+                    if (state.check(LSS::ChildrenListChanged))
+                        goto listChangedErr;
+                }
+
+                if (view->m_state.check(LVS::PendingHoldEnd))
+                {
+                    view->m_state.remove(LVS::PendingHoldEnd);
+                    pointerHoldEndEvent.setCancelled(true);
+                    pointerHoldEndEvent.setMs(currentPointerMoveEvent.ms());
+                    pointerHoldEndEvent.setUs(currentPointerMoveEvent.us());
+                    pointerHoldEndEvent.setSerial(LTime::nextSerial());
+                    view->pointerHoldEndEvent(pointerHoldEndEvent);
+
+                    if (state.check(LSS::ChildrenListChanged))
+                        goto listChangedErr;
+                }
+
+                LVectorRemoveOne(pointerFocus, view);
+                view->pointerLeaveEvent(currentPointerLeaveEvent);
+
+                if (state.check(LSS::ChildrenListChanged))
+                    goto listChangedErr;
+            }
+        }
+    }
+}
+
+// Traverses the whole scene, used if LOUVRE_SCENE_INPUT_INDEX is disabled
 bool LScene::LScenePrivate::handlePointerMove(LView *view)
 {
     if (state.check(LSS::ChildrenListChanged))
         goto listChangedErr;
 
-    for (std::list<LView*>::const_reverse_iterator it = view->children().crbegin(); it != view->children().crend(); it++)
+    for (LView::ChildrenList::const_reverse_iterator it = view->childrenList().crbegin(); it != view->childrenList().crend(); it++)
         if (!handlePointerMove(*it))
             return false;
 
@@ -128,6 +573,7 @@ bool LScene::LScenePrivate::handlePointerMove(LView *view)
         if (!view->m_state.check(LVS::PointerMoveDone))
         {
             view->m_state.add(LVS::PointerMoveDone);
+            pointerMoveDone.push_back(view);
 
             if (view->m_state.check(LVS::PointerIsOver))
             {
@@ -154,6 +600,7 @@ bool LScene::LScenePrivate::handlePointerMove(LView *view)
     else if (!view->m_state.check(LVS::PointerMoveDone))
     {
         view->m_state.add(LVS::PointerMoveDone);
+        pointerMoveDone.push_back(view);
 
         if (view->m_state.check(LVS::PointerIsOver))
         {
@@ -228,7 +675,7 @@ bool LScene::LScenePrivate::handleTouchDown(LView *view)
     if (state.check(ChildrenListChanged))
         goto listChangedErr;
 
-    for (std::list<LView*>::const_reverse_iterator it = view->children().crbegin(); it != view->children().crend(); it++)
+    for (LView::ChildrenList::const_reverse_iterator it = view->childrenList().crbegin(); it != view->childrenList().crend(); it++)
         if (!handleTouchDown(*it))
             return false;
 
@@ -12,6 +12,7 @@
 #include <LScene.h>
 #include <LBitset.h>
 #include <LSeat.h>
+#include <unordered_map>
 #include <mutex>
 
 using namespace Louvre;
@@ -40,6 +41,7 @@ LPRIVATE_CLASS(LScene)
         HandlingKeyboardKeyEvent            = static_cast<UInt32>(1) << 17,
         HandlingTouchEvent                  = static_cast<UInt32>(1) << 18,
         AutoRepaint                         = static_cast<UInt32>(1) << 19,
+        AutoLayers                          = static_cast<UInt32>(1) << 20,
     };
 
     LBitset<State> state { AutoRepaint };
@@ -63,10 +65,72 @@ LPRIVATE_CLASS(LScene)
     LPointF touchGlobalPos;
     LSceneTouchPoint *currentTouchPoint;
 
+    /* Uniform grid over the global input area of mapped views with input events enabled,
+     * so pointer events only test the views under the cursor instead of traversing the whole tree.
+     * It is rebuilt when the views tree or stacking order changes (LCompositor::LCompositorPrivate::viewsInputSerial),
+     * views in inputIndexDirty (see LView::invalidateInputBounds()) only update the cells of their subtree */
+    struct InputIndexEntry
+    {
+        LView *view;
+        LBox box;
+
+        // Cells range covering box, valid if placement == Cells
+        Int32 cx1, cy1, cx2, cy2;
+
+        enum : UInt8
+        {
+            None,
+            Cells,
+            Unbounded
+        } placement;
+
+        // Views that could have been modified without notification (see LView::repaint()), always tested
+        bool dynamic;
+    };
+
+    // 256 px cells, views covering more cells are always tested
+    static constexpr Int32 inputIndexCellShift { 8 };
+    static constexpr Int32 inputIndexMaxCells { 64 };
+
+    bool inputIndexEnabled { true };
+    UInt32 inputIndexSerial { 0 };
+
+    // One entry per view in traversal order (front to back), cells and inputIndexUnbounded hold their indices
+    std::vector<InputIndexEntry> inputIndexEntries;
+    std::unordered_map<UInt64, std::vector<UInt32>> inputIndexCells;
+    std::vector<UInt32> inputIndexUnbounded;
+
+    // Entry index of every view in the scene, also used to sort candidates not in the index (e.g. unmapped views with pointer focus)
+    std::unordered_map<const LView*, UInt32> inputIndexViewsOrder;
+
+    // Views flagged with LView::InputBoundsChanged
+    std::vector<LView*> inputIndexDirty;
+    std::vector<LView*> inputIndexDirtyTmp;
+
+    std::vector<UInt32> inputIndexQuery;
+    std::vector<LView*> pointerMoveCandidates;
+    std::vector<LView*> viewAtCandidates;
+
+    // Views flagged with LView::PointerMoveDone during the current pointer move event
+    std::vector<LView*> pointerMoveDone;
+
+    void updateInputIndex();
+    void indexView(LView *view, bool dynamic);
+    void reindexView(LView *view, bool dynamic);
+    void placeInputIndexEntry(UInt32 index, bool dynamic);
+    void removeInputIndexEntry(UInt32 index);
+    bool inputBounds(LView *view, LBox &box);
+
+    // Fills candidates with the indexed views that may contain pos (and optionally pointerFocus) sorted front to back
+    void inputCandidatesAt(const LPointF &pos, bool includePointerFocus, std::vector<LView*> &candidates);
+
     bool pointClippedByParent(LView *parent, const LPoint &point);
     bool pointClippedByParentScene(LView *view, const LPoint &point);
     LView *viewAt(LView *view, const LPoint &pos, LView::Type type, LBitset<LScene::InputFilter> flags);
+    LView *indexedViewAt(const LPoint &pos, LView::Type type, LBitset<LScene::InputFilter> flags);
     LPoint viewLocalPos(LView *view, const LPoint &pos);
+    void handlePointerMove();
+    void handleIndexedPointerMove();
     bool handlePointerMove(LView *view);
     bool handleTouchDown(LView *view);
 
@@ -0,0 +1,192 @@
+#include <protocols/ScreenCopy/RScreenCopyFrame.h>
+#include <private/LScreenshotReadback.h>
+#include <LScreenshotRequest.h>
+#include <LOutput.h>
+#include <LTime.h>
+#include <LLog.h>
+#include <wayland-server.h>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+using namespace Louvre;
+
+bool LScreenshotReadback::available() noexcept
+{
+    if (m_state != Unknown)
+        return m_state == Available;
+
+    const char *env { getenv("LOUVRE_ASYNC_SCREENCOPY") };
+
+    if (env && atoi(env) == 0)
+    {
+        m_state = Unavailable;
+        return false;
+    }
+
+    const char *version { (const char*)glGetString(GL_VERSION) };
+    Int32 major { 0 };
+
+    if (version)
+        sscanf(version, "OpenGL ES %d", &major);
+
+    m_state = major >= 3 ? Available : Unavailable;
+
+    if (m_state == Unavailable)
+        LLog::debug("[LScreenshotReadback::available] OpenGL ES 3.0 not supported, screen copies will be read synchronously.");
+
+    return m_state == Available;
+}
+
+bool LScreenshotReadback::read(LScreenshotRequest *request, const LRect &rectB, Int32 screenH, GLenum format) noexcept
+{
+    Slot *slot { nullptr };
+
+    for (Slot &s : m_slots)
+    {
+        if (!s.fence && !s.request)
+        {
+            slot = &s;
+            break;
+        }
+    }
+
+    if (!slot)
+        return false;
+
+    const GLsizeiptr size { GLsizeiptr(rectB.w()) * GLsizeiptr(rectB.h()) * 4 };
+
+    if (!slot->pbo)
+        glGenBuffers(1, &slot->pbo);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+
+    if (slot->capacity < size)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+        slot->capacity = size;
+    }
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_PACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_PACK_SKIP_ROWS, 0);
+    glReadPixels(rectB.x(),
+                 screenH - (rectB.y() + rectB.h()),
+                 rectB.w(),
+                 rectB.h(),
+                 format,
+                 GL_UNSIGNED_BYTE,
+                 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    if (!slot->fence)
+        return false;
+
+    slot->request = request;
+    slot->sizeB = rectB.size();
+    slot->time = LTime::ns();
+    return true;
+}
+
+void LScreenshotReadback::process(LOutput *output) noexcept
+{
+    bool pending { false };
+
+    for (Slot &slot : m_slots)
+    {
+        if (!slot.fence)
+            continue;
+
+        if (glClientWaitSync(slot.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        {
+            pending = true;
+            continue;
+        }
+
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        if (slot.request)
+            finish(slot);
+    }
+
+    if (pending)
+        output->repaint();
+}
+
+void LScreenshotReadback::cancel(LScreenshotRequest *request) noexcept
+{
+    for (Slot &slot : m_slots)
+        if (slot.request == request)
+            slot.request = nullptr;
+}
+
+void LScreenshotReadback::destroy() noexcept
+{
+    for (Slot &slot : m_slots)
+    {
+        if (slot.request)
+        {
+            slot.request->resource().failed();
+            slot.request = nullptr;
+        }
+
+        if (slot.fence)
+        {
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+        }
+
+        if (slot.pbo)
+        {
+            glDeleteBuffers(1, &slot.pbo);
+            slot.pbo = 0;
+            slot.capacity = 0;
+        }
+    }
+
+    m_state = Unknown;
+}
+
+void LScreenshotReadback::finish(Slot &slot) noexcept
+{
+    auto &res { slot.request->resource() };
+    slot.request = nullptr;
+
+    wl_shm_buffer *shmBuffer { res.buffer() ? wl_shm_buffer_get(res.buffer()) : nullptr };
+
+    if (!shmBuffer)
+    {
+        res.failed();
+        return;
+    }
+
+    const GLsizeiptr rowSize { GLsizeiptr(slot.sizeB.w()) * 4 };
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    const UInt8 *src { static_cast<const UInt8*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, rowSize * slot.sizeB.h(), GL_MAP_READ_BIT)) };
+
+    if (!src)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        res.failed();
+        return;
+    }
+
+    const Int32 stride { wl_shm_buffer_get_stride(shmBuffer) };
+    wl_shm_buffer_begin_access(shmBuffer);
+    UInt8 *dst { static_cast<UInt8*>(wl_shm_buffer_get_data(shmBuffer)) };
+
+    if (stride == rowSize)
+        memcpy(dst, src, rowSize * slot.sizeB.h());
+    else
+        for (Int32 y = 0; y < slot.sizeB.h(); y++)
+            memcpy(&dst[y * stride], &src[y * rowSize], rowSize);
+
+    wl_shm_buffer_end_access(shmBuffer);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    res.ready(slot.time);
+}
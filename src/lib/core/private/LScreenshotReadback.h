@@ -0,0 +1,63 @@
+#ifndef LSCREENSHOTREADBACK_H
+#define LSCREENSHOTREADBACK_H
+
+#include <LNamespaces.h>
+#include <LRect.h>
+#include <GLES3/gl3.h>
+#include <array>
+#include <ctime>
+
+namespace Louvre
+{
+    /* Reads SHM screen copy requests into a ring of pixel pack buffers and copies them into the
+     * client buffers on a later frame of the same output, once their fences are signaled, so the
+     * render thread doesn't wait for the GPU to finish the frame.
+     * Used by LScreenshotRequest::copy(), can be disabled with LOUVRE_ASYNC_SCREENCOPY=0.
+     * All methods must be called from the output's rendering thread, except cancel(). */
+    class LScreenshotReadback
+    {
+    public:
+        LScreenshotReadback() = default;
+        LScreenshotReadback(const LScreenshotReadback&) = delete;
+        LScreenshotReadback &operator=(const LScreenshotReadback&) = delete;
+
+        // Requires an OpenGL ES 3.0 context
+        bool available() noexcept;
+
+        /* Reads rectB from the bound framebuffer, the request is completed by process().
+         * Returns false if all buffers are in use */
+        bool read(LScreenshotRequest *request, const LRect &rectB, Int32 screenH, GLenum format) noexcept;
+
+        // Completes finished readbacks and schedules a repaint of the output if any is still pending
+        void process(LOutput *output) noexcept;
+
+        // Called when the request is destroyed
+        void cancel(LScreenshotRequest *request) noexcept;
+
+        // Fails pending requests and destroys the buffers
+        void destroy() noexcept;
+
+    private:
+        enum State
+        {
+            Unknown,
+            Available,
+            Unavailable
+        } m_state { Unknown };
+
+        struct Slot
+        {
+            GLuint pbo { 0 };
+            GLsizeiptr capacity { 0 };
+            GLsync fence { nullptr };
+            LScreenshotRequest *request { nullptr };
+            LSize sizeB;
+            timespec time;
+        };
+
+        std::array<Slot, 3> m_slots;
+        void finish(Slot &slot) noexcept;
+    };
+}
+
+#endif // LSCREENSHOTREADBACK_H
@@ -11,6 +11,7 @@
 #include <private/LTexturePrivate.h>
 #include <private/LOutputPrivate.h>
 #include <private/LKeyboardPrivate.h>
+#include <LSurfaceView.h>
 #include <LOutputMode.h>
 #include <LClient.h>
 #include <LTime.h>
@@ -101,6 +102,7 @@ void LSurface::LSurfacePrivate::setMapped(bool state)
     if (stateFlags.check(Mapped) != state)
     {
         stateFlags.setFlag(Mapped, state);
+        invalidateViewsBounds();
 
         if (!state)
         {
@@ -138,6 +140,30 @@ void LSurface::LSurfacePrivate::setMapped(bool state)
     }
 }
 
+void LSurface::LSurfacePrivate::posChanged() noexcept
+{
+    invalidateViewsBounds();
+}
+
+void LSurface::LSurfacePrivate::invalidateViewsBounds() noexcept
+{
+    for (LSurfaceView *view : views)
+    {
+        view->invalidateSubtreeBounds();
+        view->invalidateInputBounds();
+    }
+
+    // Children roles are positioned relative to this surface
+    for (LSurface *child : surfaceResource->surface()->children())
+        child->imp()->invalidateViewsBounds();
+}
+
+void LSurface::LSurfacePrivate::invalidateViewsContent() noexcept
+{
+    for (LSurfaceView *view : views)
+        view->invalidateSubtreeBounds();
+}
+
 void LSurface::LSurfacePrivate::setPendingRole(LBaseSurfaceRole *role) noexcept
 {
     pending.role = role;
@@ -249,17 +275,19 @@ bool LSurface::LSurfacePrivate::bufferToTexture() noexcept
         changesToNotify.add(BufferScaleChanged);
     }
 
+    // Present the previous SHM upload before replacing it
+    finishTextureUpload();
+
     if (current.bufferRes)
     {
+        // Set again below if it's still a single pixel buffer
+        const bool wasSolidColor { stateFlags.check(SolidColor) };
+        const LRGBAF prevSolidColor { solidColor };
+        stateFlags.remove(SolidColor);
+
         // SHM
         if (wl_shm_buffer_get(current.bufferRes))
         {
-            if (!stateFlags.check(BufferReleased))
-            {
-                wl_buffer_send_release(current.bufferRes);
-                stateFlags.add(BufferReleased);
-            }
-
             if (texture && texture != textureBackup && texture->m_pendingDelete)
                 delete texture;
 
@@ -283,6 +311,8 @@ bool LSurface::LSurfacePrivate::bufferToTexture() noexcept
                 currentDamage.clear();
                 currentDamage.addRect(LRect(0, size));
                 texture->setDataFromMainMemory(LSize(widthB, heightB), stride, format, pixels);
+                textureUploadStaleRegion.clear();
+                textureUploadStaleRegion.addRect(LRect(0, LSize(widthB, heightB)));
             }
             else if (!pendingDamageB.empty() || !pendingDamage.empty())
             {
@@ -299,49 +329,45 @@ bool LSurface::LSurfacePrivate::bufferToTexture() noexcept
                     Int32 xOffset = roundf(srcRect.x() * Float32(current.bufferScale)) - 2;
                     Int32 yOffset = roundf(srcRect.y() * Float32(current.bufferScale)) - 2;
 
-                    while (!pendingDamage.empty())
-                    {
-                        LRect &r = pendingDamage.back();
-                        onlyPending.addRect((r.x() * xInvScale + xOffset),
-                                            (r.y() * yInvScale + yOffset),
-                                            (r.w() * xInvScale + 4 ),
-                                            (r.h() * yInvScale + 4 ));
-                        pendingDamage.pop_back();
-                    }
+                    for (const LRect &r : pendingDamage)
+                        pushDamageBox(r.x() * xInvScale + xOffset, r.y() * yInvScale + yOffset, r.w() * xInvScale + 4, r.h() * yInvScale + 4);
 
-                    while (!pendingDamageB.empty())
-                    {
-                        LRect &r = pendingDamageB.back();
-                        onlyPending.addRect(
-                            r.x() - 1,
-                            r.y() - 1,
-                            r.w() + 2,
-                            r.h() + 2);
-                        pendingDamageB.pop_back();
-                    }
+                    pendingDamage.clear();
 
-                    onlyPending.transform(sizeB, current.transform);
+                    for (const LRect &r : pendingDamageB)
+                        pushDamageBox(r.x() - 1, r.y() - 1, r.w() + 2, r.h() + 2);
+
+                    pendingDamageB.clear();
+                    onlyPending.addBoxes(damageBoxes.data(), damageBoxes.size());
+                    damageBoxes.clear();
 
-                    Int32 n;
-                    const LBox *boxes = onlyPending.boxes(&n);
+                    onlyPending.transform(sizeB, current.transform);
 
-                    if (n > 0 && texture->writeBegin())
+                    if (!submitTextureUpload(shm_buffer, onlyPending, format))
                     {
-                        const UInt32 pixelSize { LTexture::formatBytesPerPixel(format) };
-                        LRect rect;
-                        for (Int32 i = 0; i < n; i++)
+                        Int32 n;
+                        const LBox *boxes = onlyPending.boxes(&n);
+
+                        if (n > 0 && texture->writeBegin())
                         {
-                            rect.setX(boxes->x1);
-                            rect.setY(boxes->y1);
-                            rect.setW(boxes->x2 - boxes->x1);
-                            rect.setH(boxes->y2 - boxes->y1);
-                            texture->writeUpdate(rect,
-                                                stride,
-                                                &pixels[rect.x()*pixelSize + rect.y()*stride]);
-
-                            boxes++;
+                            const UInt32 pixelSize { LTexture::formatBytesPerPixel(format) };
+                            LRect rect;
+                            for (Int32 i = 0; i < n; i++)
+                            {
+                                rect.setX(boxes->x1);
+                                rect.setY(boxes->y1);
+                                rect.setW(boxes->x2 - boxes->x1);
+                                rect.setH(boxes->y2 - boxes->y1);
+                                texture->writeUpdate(rect,
+                                                    stride,
+                                                    &pixels[rect.x()*pixelSize + rect.y()*stride]);
+
+                                boxes++;
+                            }
+                            texture->writeEnd();
                         }
-                        texture->writeEnd();
+
+                        textureUploadStaleRegion.addRegion(onlyPending);
                     }
 
                     onlyPending.transform(sizeB, Louvre::requiredTransform(current.transform, LTransform::Normal));
@@ -352,51 +378,47 @@ bool LSurface::LSurfacePrivate::bufferToTexture() noexcept
                 }
                 else
                 {
-                    while (!pendingDamage.empty())
-                    {
-                        LRect &r = pendingDamage.back();
-                        onlyPending.addRect((r.x() - 2)*current.bufferScale,
-                                            (r.y() - 2)*current.bufferScale,
-                                            (r.w() + 4 )*current.bufferScale,
-                                            (r.h() + 4 )*current.bufferScale);
-                        pendingDamage.pop_back();
-                    }
+                    for (const LRect &r : pendingDamage)
+                        pushDamageBox((r.x() - 2)*current.bufferScale, (r.y() - 2)*current.bufferScale, (r.w() + 4)*current.bufferScale, (r.h() + 4)*current.bufferScale);
 
-                    while (!pendingDamageB.empty())
-                    {
-                        LRect &r = pendingDamageB.back();
-                        onlyPending.addRect(
-                            r.x() - 2,
-                            r.y() - 2,
-                            r.w() + 4,
-                            r.h() + 4);
-                        pendingDamageB.pop_back();
-                    }
+                    pendingDamage.clear();
+
+                    for (const LRect &r : pendingDamageB)
+                        pushDamageBox(r.x() - 2, r.y() - 2, r.w() + 4, r.h() + 4);
+
+                    pendingDamageB.clear();
+                    onlyPending.addBoxes(damageBoxes.data(), damageBoxes.size());
+                    damageBoxes.clear();
 
                     onlyPending.clip(LRect(0, sizeB));
                     currentDamageB.addRegion(onlyPending);
                     onlyPending.transform(sizeB, current.transform);
 
-                    Int32 n;
-                    const LBox *boxes = onlyPending.boxes(&n);
-
-                    if (n > 0 && texture->writeBegin())
+                    if (!submitTextureUpload(shm_buffer, onlyPending, format))
                     {
-                        const UInt32 pixelSize { LTexture::formatBytesPerPixel(format) };
-                        LRect rect;
-                        for (Int32 i = 0; i < n; i++)
+                        Int32 n;
+                        const LBox *boxes = onlyPending.boxes(&n);
+
+                        if (n > 0 && texture->writeBegin())
                         {
-                            rect.setX(boxes->x1);
-                            rect.setY(boxes->y1);
-                            rect.setW(boxes->x2 - boxes->x1);
-                            rect.setH(boxes->y2 - boxes->y1);
-                            texture->writeUpdate(rect,
-                                                stride,
-                                                &pixels[rect.x()*pixelSize + rect.y()*stride]);
-
-                            boxes++;
+                            const UInt32 pixelSize { LTexture::formatBytesPerPixel(format) };
+                            LRect rect;
+                            for (Int32 i = 0; i < n; i++)
+                            {
+                                rect.setX(boxes->x1);
+                                rect.setY(boxes->y1);
+                                rect.setW(boxes->x2 - boxes->x1);
+                                rect.setH(boxes->y2 - boxes->y1);
+                                texture->writeUpdate(rect,
+                                                    stride,
+                                                    &pixels[rect.x()*pixelSize + rect.y()*stride]);
+
+                                boxes++;
+                            }
+                            texture->writeEnd();
                         }
-                        texture->writeEnd();
+
+                        textureUploadStaleRegion.addRegion(onlyPending);
                     }
 
                     LRegion::multiply(&currentDamage, &currentDamageB, 1.f/Float32(current.bufferScale));
@@ -404,11 +426,24 @@ bool LSurface::LSurfacePrivate::bufferToTexture() noexcept
             }
             else
             {
+                if (!stateFlags.check(BufferReleased))
+                {
+                    wl_buffer_send_release(current.bufferRes);
+                    stateFlags.add(BufferReleased);
+                }
+
                 wl_shm_buffer_end_access(shm_buffer);
                 wl_client_flush(wl_resource_get_client(current.bufferRes));
                 return true;
             }
 
+            // Released by finishTextureUpload() instead if submitted
+            if (!stateFlags.check(BufferReleased))
+            {
+                wl_buffer_send_release(current.bufferRes);
+                stateFlags.add(BufferReleased);
+            }
+
             wl_shm_buffer_end_access(shm_buffer);
             wl_client_flush(wl_resource_get_client(current.bufferRes));
         }
@@ -475,25 +510,38 @@ bool LSurface::LSurfacePrivate::bufferToTexture() noexcept
             if (!updateDimensions(widthB, heightB))
                 return false;
 
-            LSinglePixelBuffer &singlePixelBuffer { *static_cast<LSinglePixelBuffer*>(wl_resource_get_user_data(current.bufferRes)) };
+            const LSinglePixelBuffer::UPixel32 &pixel { static_cast<LSinglePixelBuffer*>(wl_resource_get_user_data(current.bufferRes))->pixel() };
+            constexpr UInt64 max { std::numeric_limits<UInt32>::max() };
+            solidColor.a = Float32(Float64(pixel.a) / Float64(max));
 
-            UInt8 buffer[4]
+            // Components are premultiplied
+            if (pixel.a == 0)
+                solidColor.r = solidColor.g = solidColor.b = 0.f;
+            else
             {
-                static_cast<UInt8>(
-                    (static_cast<UInt64>(singlePixelBuffer.pixel().b) * static_cast<UInt64>(255))
-                    /static_cast<UInt64>(std::numeric_limits<UInt32>::max())),
-                static_cast<UInt8>(
-                    (static_cast<UInt64>(singlePixelBuffer.pixel().g) * static_cast<UInt64>(255))
-                    /static_cast<UInt64>(std::numeric_limits<UInt32>::max())),
-                static_cast<UInt8>(
-                    (static_cast<UInt64>(singlePixelBuffer.pixel().r) * static_cast<UInt64>(255))
-                    /static_cast<UInt64>(std::numeric_limits<UInt32>::max())),
-                static_cast<UInt8>(
-                    (static_cast<UInt64>(singlePixelBuffer.pixel().a) * static_cast<UInt64>(255))
-                    /static_cast<UInt64>(std::numeric_limits<UInt32>::max())),
-            };
-
-            texture->setDataFromMainMemory(LSize(1, 1), 4, DRM_FORMAT_ARGB8888, buffer);
+                solidColor.r = Float32(std::min(Float64(pixel.r) / Float64(pixel.a), 1.0));
+                solidColor.g = Float32(std::min(Float64(pixel.g) / Float64(pixel.a), 1.0));
+                solidColor.b = Float32(std::min(Float64(pixel.b) / Float64(pixel.a), 1.0));
+            }
+
+            stateFlags.add(SolidColor);
+
+            // Clients usually commit the same buffer each frame, the texture is only kept for users of LSurface::texture()
+            if (!wasSolidColor || prevSolidColor != solidColor || !texture->initialized())
+            {
+                UInt8 buffer[4]
+                {
+                    static_cast<UInt8>((static_cast<UInt64>(pixel.b) * static_cast<UInt64>(255)) / max),
+                    static_cast<UInt8>((static_cast<UInt64>(pixel.g) * static_cast<UInt64>(255)) / max),
+                    static_cast<UInt8>((static_cast<UInt64>(pixel.r) * static_cast<UInt64>(255)) / max),
+                    static_cast<UInt8>((static_cast<UInt64>(pixel.a) * static_cast<UInt64>(255)) / max),
+                };
+
+                texture->setDataFromMainMemory(LSize(1, 1), 4, DRM_FORMAT_ARGB8888, buffer);
+            }
+
+            textureUploadStaleRegion.clear();
+            textureUploadStaleRegion.addRect(0, 0, 1, 1);
             updateDamage();
         }
         else
@@ -502,6 +550,10 @@ bool LSurface::LSurfacePrivate::bufferToTexture() noexcept
             wl_resource_post_error(surfaceResource->resource(), 0, "Unknown buffer type.");
             return false;
         }
+
+        // Fully opaque single pixel buffers don't need an opaque region, see RSurface::apply_commit()
+        if ((wasSolidColor && prevSolidColor.a >= 1.f) != (stateFlags.check(SolidColor) && solidColor.a >= 1.f))
+            changesToNotify.add(OpaqueRegionChanged);
     }
     else
     {
@@ -520,11 +572,136 @@ bool LSurface::LSurfacePrivate::bufferToTexture() noexcept
     texture->m_surface.reset(surfaceResource->surface());
     pendingDamageB.clear();
     pendingDamage.clear();
-    damageId = LTime::nextSerial();
-    stateFlags.add(Damaged);
+
+    // Otherwise done by finishTextureUpload() once the new content can be presented
+    if (!textureUpload)
+    {
+        damageId = LTime::nextSerial();
+        stateFlags.add(Damaged);
+        invalidateViewsContent();
+    }
+
     return true;
 }
 
+bool LSurface::LSurfacePrivate::submitTextureUpload(wl_shm_buffer *shmBuffer, const LRegion &damage, UInt32 format) noexcept
+{
+    LTextureUploader &uploader { compositor()->imp()->textureUploader };
+
+    if (!uploader.available())
+        return false;
+
+    if (!textureUploadTarget)
+        textureUploadTarget = new LTexture(true);
+
+    const LSize bufferSize { wl_shm_buffer_get_width(shmBuffer), wl_shm_buffer_get_height(shmBuffer) };
+
+    textureUpload = new LTextureUploader::Upload();
+    LTextureUploader::Upload &upload { *textureUpload };
+    upload.surface = surfaceResource->surface();
+    upload.texture = textureUploadTarget;
+    upload.create = !textureUploadTarget->initialized()
+        || textureUploadTarget->sizeB() != bufferSize
+        || textureUploadTarget->format() != format;
+
+    if (upload.create)
+        textureUploadTarget->reset();
+
+    upload.buffer = current.bufferRes;
+    upload.release = !stateFlags.check(BufferReleased);
+    upload.bufferDestroyListener.notify = [](wl_listener *listener, void *)
+    {
+        // Wait for the copy before libwayland frees the wl_shm_buffer
+        LTextureUploader::Upload *upload { (LTextureUploader::Upload *)listener };
+        upload->buffer = nullptr;
+        upload->surface->imp()->finishTextureUpload();
+    };
+    wl_resource_add_destroy_listener(current.bufferRes, &upload.bufferDestroyListener);
+
+    upload.shmBuffer = shmBuffer;
+    upload.pool = wl_shm_buffer_ref_pool(shmBuffer);
+    upload.pixels = static_cast<const UInt8*>(wl_shm_buffer_get_data(shmBuffer));
+    upload.sizeB = bufferSize;
+    upload.stride = wl_shm_buffer_get_stride(shmBuffer);
+    upload.format = format;
+    upload.damage = damage;
+    upload.region = damage;
+
+    if (!upload.create)
+    {
+        upload.region.addRegion(textureUploadStaleRegion);
+        upload.region.clip(LRect(0, bufferSize));
+    }
+
+    stateFlags.add(BufferReleased);
+    uploader.submit(textureUpload);
+    return true;
+}
+
+void LSurface::LSurfacePrivate::finishTextureUpload(bool notify) noexcept
+{
+    if (!textureUpload)
+        return;
+
+    LTextureUploader::Upload *upload { textureUpload };
+    textureUpload = nullptr;
+    compositor()->imp()->textureUploader.wait(upload);
+
+    if (upload->buffer)
+    {
+        wl_list_remove(&upload->bufferDestroyListener.link);
+
+        if (upload->release)
+            wl_buffer_send_release(upload->buffer);
+
+        wl_client_flush(wl_resource_get_client(upload->buffer));
+    }
+
+    wl_shm_pool_unref(upload->pool);
+
+    if (upload->succeeded)
+    {
+        if (upload->create)
+        {
+            upload->texture->m_format = upload->format;
+            upload->texture->m_sizeB = upload->sizeB;
+            upload->texture->m_sourceType = LTexture::CPU;
+        }
+
+        // The texture presented until now becomes the next upload target
+        if (texture == textureBackup)
+            texture = textureUploadTarget;
+
+        std::swap(textureBackup, textureUploadTarget);
+        textureBackup->m_surface.reset(upload->surface);
+        textureUploadStaleRegion = upload->damage;
+
+        /* A frame snapshot being replayed may still sample it without the compositor lock,
+         * don't let the uploader write into it (its GL objects are released once the replay ends) */
+        if (compositor()->imp()->frameSnapshotsInFlight.load() != 0)
+        {
+            delete textureUploadTarget;
+            textureUploadTarget = nullptr;
+        }
+    }
+    else
+    {
+        LLog::error("[LSurfacePrivate::finishTextureUpload] Failed to upload SHM buffer.");
+        textureUploadTarget->reset();
+    }
+
+    delete upload;
+
+    // Deferred from bufferToTexture(), also on failure so that frame callbacks aren't held forever
+    if (notify && !stateFlags.check(Destroyed))
+    {
+        damageId = LTime::nextSerial();
+        stateFlags.add(Damaged);
+        invalidateViewsContent();
+        surfaceResource->surface()->damageChanged();
+    }
+}
+
 void LSurface::LSurfacePrivate::sendPresentationFeedback(LOutput *output) noexcept
 {
     if (presentationFeedbackResources.empty())
@@ -572,6 +749,24 @@ void LSurface::LSurfacePrivate::sendPresentationFeedback(LOutput *output) noexce
     }
 }
 
+void LSurface::LSurfacePrivate::queueConfiguration() noexcept
+{
+    if (stateFlags.check(PendingConfiguration | Destroyed))
+        return;
+
+    stateFlags.add(PendingConfiguration);
+    compositor()->imp()->surfacesPendingConfiguration.push_back(surfaceResource->surface());
+}
+
+void LSurface::LSurfacePrivate::queuePresentationFeedback() noexcept
+{
+    if (stateFlags.check(PendingPresentationFeedback | Destroyed))
+        return;
+
+    stateFlags.add(PendingPresentationFeedback);
+    compositor()->imp()->surfacesPendingPresentationFeedback.push_back(surfaceResource->surface());
+}
+
 void LSurface::LSurfacePrivate::sendPreferredScale() noexcept
 {
     if (outputs.empty())
@@ -696,26 +891,17 @@ void LSurface::LSurfacePrivate::updateDamage() noexcept
             Int32 xOffset = roundf(srcRect.x() * Float32(current.bufferScale)) - 2;
             Int32 yOffset = roundf(srcRect.y() * Float32(current.bufferScale)) - 2;
 
-            while (!pendingDamage.empty())
-            {
-                LRect &r = pendingDamage.back();
-                currentDamageB.addRect((r.x() * xInvScale + xOffset),
-                                       (r.y() * yInvScale + yOffset),
-                                       (r.w() * xInvScale + 4 ),
-                                       (r.h() * yInvScale + 4 ));
-                pendingDamage.pop_back();
-            }
+            for (const LRect &r : pendingDamage)
+                pushDamageBox(r.x() * xInvScale + xOffset, r.y() * yInvScale + yOffset, r.w() * xInvScale + 4, r.h() * yInvScale + 4);
 
-            while (!pendingDamageB.empty())
-            {
-                LRect &r = pendingDamageB.back();
-                currentDamageB.addRect(
-                    r.x() - 1,
-                    r.y() - 1,
-                    r.w() + 2,
-                    r.h() + 2);
-                pendingDamageB.pop_back();
-            }
+            pendingDamage.clear();
+
+            for (const LRect &r : pendingDamageB)
+                pushDamageBox(r.x() - 1, r.y() - 1, r.w() + 2, r.h() + 2);
+
+            pendingDamageB.clear();
+            currentDamageB.addBoxes(damageBoxes.data(), damageBoxes.size());
+            damageBoxes.clear();
 
             currentDamageB.clip(LRect(0, sizeB));
             currentDamage = currentDamageB;
@@ -724,26 +910,17 @@ void LSurface::LSurfacePrivate::updateDamage() noexcept
         }
         else
         {
-            while (!pendingDamage.empty())
-            {
-                LRect &r = pendingDamage.back();
-                currentDamageB.addRect((r.x() - 1 )*current.bufferScale,
-                                       (r.y() - 1 )*current.bufferScale,
-                                       (r.w() + 2 )*current.bufferScale,
-                                       (r.h() + 2 )*current.bufferScale);
-                pendingDamage.pop_back();
-            }
+            for (const LRect &r : pendingDamage)
+                pushDamageBox((r.x() - 1)*current.bufferScale, (r.y() - 1)*current.bufferScale, (r.w() + 2)*current.bufferScale, (r.h() + 2)*current.bufferScale);
 
-            while (!pendingDamageB.empty())
-            {
-                LRect &r = pendingDamageB.back();
-                currentDamageB.addRect(
-                    r.x() - 1,
-                    r.y() - 1,
-                    r.w() + 2,
-                    r.h() + 2);
-                pendingDamageB.pop_back();
-            }
+            pendingDamage.clear();
+
+            for (const LRect &r : pendingDamageB)
+                pushDamageBox(r.x() - 1, r.y() - 1, r.w() + 2, r.h() + 2);
+
+            pendingDamageB.clear();
+            currentDamageB.addBoxes(damageBoxes.data(), damageBoxes.size());
+            damageBoxes.clear();
 
             currentDamageB.clip(LRect(0, sizeB));
             LRegion::multiply(&currentDamage, &currentDamageB, 1.f/Float32(current.bufferScale));
@@ -5,6 +5,7 @@
 #include <protocols/Viewporter/RViewport.h>
 #include <protocols/Wayland/RSurface.h>
 #include <private/LCompositorPrivate.h>
+#include <private/LTextureUploader.h>
 #include <LSurfaceView.h>
 #include <LSurface.h>
 #include <LBitset.h>
@@ -55,6 +56,9 @@ LPRIVATE_CLASS(LSurface)
         VSync                       = static_cast<UInt16>(1) << 10,
         ChildrenListChanged         = static_cast<UInt16>(1) << 11,
         ParentCommitNotified        = static_cast<UInt16>(1) << 12,
+        PendingConfiguration        = static_cast<UInt16>(1) << 13,
+        PendingPresentationFeedback = static_cast<UInt16>(1) << 14,
+        SolidColor                  = static_cast<UInt16>(1) << 15
     };
 
     LBitset<StateFlags> stateFlags
@@ -89,6 +93,9 @@ LPRIVATE_CLASS(LSurface)
     LSize size                              { 1, 1 };
     LSize sizeB                             { 1, 1 };
     LPoint pos;
+
+    // rolePos() after the last commit, see RSurface::apply_commit()
+    LPoint inputRolePos;
     LTexture *texture                       { nullptr };
     LRegion currentDamage;
     LRegion currentTranslucentRegion;
@@ -101,6 +108,14 @@ LPRIVATE_CLASS(LSurface)
 
     std::vector<LRect> pendingDamageB;
     std::vector<LRect> pendingDamage;
+
+    // Pending damage converted to buffer coords, added to the regions at once with LRegion::addBoxes()
+    std::vector<LBox> damageBoxes;
+    void pushDamageBox(Int32 x, Int32 y, Int32 w, Int32 h) noexcept
+    {
+        damageBoxes.push_back({ x, y, x + w, y + h });
+    }
+
     LRegion currentDamageB;
 
     Wayland::RSurface *surfaceResource      { nullptr };
@@ -108,6 +123,17 @@ LPRIVATE_CLASS(LSurface)
     LWeak<LSurfaceView> lastTouchEventView;
 
     LTexture *textureBackup;
+
+    // Color of the current single pixel buffer (non-premultiplied), valid while SolidColor is set
+    LRGBAF solidColor;
+
+    /* SHM buffers are copied into this texture by the compositor's LTextureUploader while
+     * textureBackup keeps being presented, both are swapped once the upload finishes */
+    LTexture *textureUploadTarget           { nullptr };
+    LTextureUploader::Upload *textureUpload { nullptr };
+
+    // Parts of textureUploadTarget that are older than textureBackup (texture coords)
+    LRegion textureUploadStaleRegion;
     LSurface *parent                        { nullptr };
     LSurface *pendingParent                 { nullptr };
     std::vector<LSurfaceView*> views;
@@ -132,14 +158,27 @@ LPRIVATE_CLASS(LSurface)
     LSurface *prevSurfaceInLayers() noexcept;
     void setLayer(LSurfaceLayer layer);
     void sendPresentationFeedback(LOutput *output) noexcept;
+
+    // Add the surface to the LCompositorPrivate lists flushed by sendPendingConfigurations() and sendPresentationTime()
+    void queueConfiguration() noexcept;
+    void queuePresentationFeedback() noexcept;
     void setPendingParent(LSurface *pendParent) noexcept;
     void setParent(LSurface *parent);
     void removeChild(LSurface *child);
     void setMapped(bool state);
+    void posChanged() noexcept;
+
+    // The role pos, size or input region may have changed, see LView::invalidateSubtreeBounds() and LView::invalidateInputBounds()
+    void invalidateViewsBounds() noexcept;
+
+    // New damage or frame callbacks, views must be visited by the next LSceneView::render() even in culled subtrees
+    void invalidateViewsContent() noexcept;
     void setPendingRole(LBaseSurfaceRole *role) noexcept;
     void applyPendingRole();
     void applyPendingChildren();
     bool bufferToTexture() noexcept;
+    bool submitTextureUpload(wl_shm_buffer *shmBuffer, const LRegion &damage, UInt32 format) noexcept;
+    void finishTextureUpload(bool notify = true) noexcept;
     void sendPreferredScale() noexcept;
     bool isInChildrenOrPendingChildren(LSurface *child) noexcept;
     bool hasRoleOrPendingRole() noexcept;
@@ -0,0 +1,203 @@
+#include <private/LTextureUploader.h>
+#include <private/LCompositorPrivate.h>
+#include <private/LSurfacePrivate.h>
+#include <LTexture.h>
+#include <LLog.h>
+#include <sys/eventfd.h>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace Louvre;
+
+bool LTextureUploader::available() noexcept
+{
+    if (m_state != Stopped)
+        return m_state == Running;
+
+    const char *env { getenv("LOUVRE_ASYNC_SHM_UPLOADS") };
+
+    if (env && atoi(env) == 0)
+    {
+        m_state = Unavailable;
+        return false;
+    }
+
+    m_eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (m_eventFd < 0)
+    {
+        m_state = Unavailable;
+        return false;
+    }
+
+    m_eventSource = compositor()->addFdListener(m_eventFd, this, &finishedUploads);
+    m_thread = std::thread(&LTextureUploader::run, this);
+
+    std::unique_lock<std::mutex> lock { m_mutex };
+    m_cond.wait(lock, [this]{ return m_state != Stopped; });
+
+    if (m_state == Running)
+    {
+        LLog::debug("[LTextureUploader::available] SHM uploads thread started.");
+        return true;
+    }
+
+    lock.unlock();
+    m_thread.join();
+    compositor()->removeFdListener(m_eventSource);
+    m_eventSource = nullptr;
+    close(m_eventFd);
+    m_eventFd = -1;
+    LLog::debug("[LTextureUploader::available] Shared contexts not supported by the graphic backend, SHM buffers will be uploaded synchronously.");
+    return false;
+}
+
+void LTextureUploader::stop() noexcept
+{
+    if (m_state != Running)
+    {
+        m_state = Stopped;
+        return;
+    }
+
+    m_mutex.lock();
+    m_exit = true;
+    m_mutex.unlock();
+    m_cond.notify_all();
+    m_thread.join();
+
+    // Uploads that never ran are reported as failed when waited
+    for (Upload *upload : m_queue)
+        upload->done = true;
+
+    m_queue.clear();
+    m_exit = false;
+    m_state = Stopped;
+    compositor()->removeFdListener(m_eventSource);
+    m_eventSource = nullptr;
+    close(m_eventFd);
+    m_eventFd = -1;
+}
+
+void LTextureUploader::submit(Upload *upload) noexcept
+{
+    m_mutex.lock();
+    m_queue.push_back(upload);
+    m_mutex.unlock();
+    m_cond.notify_all();
+}
+
+void LTextureUploader::wait(Upload *upload) noexcept
+{
+    std::unique_lock<std::mutex> lock { m_mutex };
+    m_cond.wait(lock, [upload]{ return upload->done; });
+
+    auto it { std::find(m_finished.begin(), m_finished.end(), upload) };
+
+    if (it != m_finished.end())
+        m_finished.erase(it);
+}
+
+void LTextureUploader::run() noexcept
+{
+    const bool ok { compositor()->imp()->graphicBackend->backendCreateSharedContext() };
+
+    m_mutex.lock();
+    m_state = ok ? Running : Unavailable;
+    m_mutex.unlock();
+    m_cond.notify_all();
+
+    if (!ok)
+        return;
+
+    Upload *upload;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock { m_mutex };
+            m_cond.wait(lock, [this]{ return m_exit || !m_queue.empty(); });
+
+            if (m_exit)
+                break;
+
+            upload = m_queue.front();
+            m_queue.erase(m_queue.begin());
+        }
+
+        process(upload);
+
+        m_mutex.lock();
+        upload->done = true;
+        m_finished.push_back(upload);
+        m_mutex.unlock();
+        m_cond.notify_all();
+        eventfd_write(m_eventFd, 1);
+    }
+
+    compositor()->imp()->graphicBackend->backendDestroySharedContext();
+}
+
+void LTextureUploader::process(Upload *upload) noexcept
+{
+    // Each thread has its own SIGBUS handler data
+    wl_shm_buffer_begin_access(upload->shmBuffer);
+
+    if (upload->create)
+        upload->succeeded = compositor()->imp()->graphicBackend->textureCreateFromCPUBuffer(
+            upload->texture, upload->sizeB, upload->stride, upload->format, upload->pixels);
+    else if (upload->texture->writeBegin())
+    {
+        const UInt32 pixelSize { LTexture::formatBytesPerPixel(upload->format) };
+        Int32 n;
+        const LBox *box { upload->region.boxes(&n) };
+        LRect rect;
+
+        for (Int32 i = 0; i < n; i++, box++)
+        {
+            rect.setX(box->x1);
+            rect.setY(box->y1);
+            rect.setW(box->x2 - box->x1);
+            rect.setH(box->y2 - box->y1);
+            upload->texture->writeUpdate(rect, upload->stride,
+                &upload->pixels[rect.x()*pixelSize + rect.y()*upload->stride]);
+        }
+
+        upload->succeeded = upload->texture->writeEnd();
+    }
+
+    wl_shm_buffer_end_access(upload->shmBuffer);
+
+    // Outputs sample the texture from their own contexts
+    if (upload->succeeded)
+        compositor()->imp()->graphicBackend->textureSetFence(upload->texture);
+}
+
+int LTextureUploader::finishedUploads(int fd, unsigned int /*mask*/, void *data) noexcept
+{
+    LTextureUploader &uploader { *static_cast<LTextureUploader*>(data) };
+    eventfd_t value;
+    eventfd_read(fd, &value);
+
+    Upload *upload;
+
+    /* Taken one at a time, handlers may destroy other surfaces, whose uploads
+     * are then finished and removed from m_finished by wait() */
+    while (true)
+    {
+        uploader.m_mutex.lock();
+
+        if (uploader.m_finished.empty())
+        {
+            uploader.m_mutex.unlock();
+            break;
+        }
+
+        upload = uploader.m_finished.front();
+        uploader.m_finished.erase(uploader.m_finished.begin());
+        uploader.m_mutex.unlock();
+        upload->surface->imp()->finishTextureUpload();
+    }
+
+    return 0;
+}
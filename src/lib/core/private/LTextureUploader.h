@@ -0,0 +1,93 @@
+#ifndef LTEXTUREUPLOADER_H
+#define LTEXTUREUPLOADER_H
+
+#include <LNamespaces.h>
+#include <LRegion.h>
+#include <wayland-server.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Louvre
+{
+    /* Copies SHM buffers into textures from a worker thread bound to a context shared with
+     * the allocator context, so large commits don't stall the main thread.
+     * Used by LSurface::LSurfacePrivate::bufferToTexture(), can be disabled with LOUVRE_ASYNC_SHM_UPLOADS=0. */
+    class LTextureUploader
+    {
+    public:
+        struct Upload
+        {
+            // Must be the first member (see LSurface::LSurfacePrivate::submitTextureUpload())
+            wl_listener bufferDestroyListener;
+
+            LSurface *surface;
+
+            // Not visible to outputs until the surface swaps it in
+            LTexture *texture;
+
+            // Allocate the texture from the whole buffer instead of updating the boxes
+            bool create;
+
+            // Set to nullptr if destroyed by the client
+            wl_resource *buffer;
+            wl_shm_buffer *shmBuffer;
+
+            // Send wl_buffer.release once the copy finishes
+            bool release;
+
+            // Referenced until the upload is finished so that resizes are deferred
+            wl_shm_pool *pool;
+
+            const UInt8 *pixels;
+            LSize sizeB;
+            Int32 stride;
+            UInt32 format;
+
+            // Boxes copied into the texture (damage of this commit plus what the texture missed before)
+            LRegion region;
+
+            // Damage of this commit only
+            LRegion damage;
+
+            bool done { false };
+            bool succeeded { false };
+        };
+
+        LTextureUploader() = default;
+        LTextureUploader(const LTextureUploader&) = delete;
+        LTextureUploader &operator=(const LTextureUploader&) = delete;
+
+        // Starts the worker on first use, returns false if not supported by the graphic backend
+        bool available() noexcept;
+        void stop() noexcept;
+
+        // Main thread only
+        void submit(Upload *upload) noexcept;
+        void wait(Upload *upload) noexcept;
+
+    private:
+        enum State
+        {
+            Stopped,
+            Running,
+            Unavailable
+        } m_state { Stopped };
+
+        std::thread m_thread;
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+        std::vector<Upload*> m_queue;
+        std::vector<Upload*> m_finished;
+        Int32 m_eventFd { -1 };
+        wl_event_source *m_eventSource { nullptr };
+        bool m_exit { false };
+
+        void run() noexcept;
+        void process(Upload *upload) noexcept;
+        static int finishedUploads(int fd, unsigned int mask, void *data) noexcept;
+    };
+}
+
+#endif // LTEXTUREUPLOADER_H
@@ -421,6 +421,7 @@ void LPopupRole::configureRect(const LRect &rect) const noexcept
 
     if (!m_flags.check(HasConfigurationToSend))
     {
+        surface()->imp()->queueConfiguration();
         m_flags.add(HasConfigurationToSend);
         m_pendingConfiguration.serial = LTime::nextSerial();
     }
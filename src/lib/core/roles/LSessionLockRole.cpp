@@ -115,6 +115,7 @@ void LSessionLockRole::configure(const LSize &size) noexcept
 
     if (!m_hasPendingConf)
     {
+        surface()->imp()->queueConfiguration();
         m_hasPendingConf = true;
         m_pendingSerial = LTime::nextSerial();
     }
@@ -46,6 +46,7 @@ void LSubsurfaceRole::handleParentCommit()
     {
         m_hasPendingLocalPos = false;
         m_currentLocalPos = m_pendingLocalPos;
+        surface()->imp()->invalidateViewsBounds();
         localPosChanged();
     }
 
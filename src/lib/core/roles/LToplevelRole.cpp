@@ -453,6 +453,8 @@ void LToplevelRole::sendPendingConfiguration() noexcept
 
 void LToplevelRole::updateSerial() noexcept
 {
+    surface()->imp()->queueConfiguration();
+
     if (!m_flags.check(HasSizeOrStateToSend | HasDecorationModeToSend | HasBoundsToSend | HasCapabilitiesToSend))
     {
         m_pendingConfiguration.serial = LTime::nextSerial();
@@ -1,6 +1,7 @@
 #include <LSessionLockManager.h>
 #include <private/LScenePrivate.h>
 #include <private/LSurfacePrivate.h>
+#include <private/LOutputPrivate.h>
 #include <LSceneTouchPoint.h>
 #include <LToplevelMoveSession.h>
 #include <LToplevelResizeSession.h>
@@ -18,6 +19,7 @@
 #include <LTouchPoint.h>
 #include <LUtils.h>
 #include <unistd.h>
+#include <cstdlib>
 
 using LVS = LView::LViewState;
 using LSS = LScene::LScenePrivate::State;
@@ -28,6 +30,12 @@ LScene::LScene() : LPRIVATE_INIT_UNIQUE(LScene)
     LView *baseView = &imp()->view;
     baseView->m_scene = this;
     baseView->m_state.add(LVS::IsScene);
+
+    const char *env { getenv("LOUVRE_SCENE_INPUT_INDEX") };
+    imp()->inputIndexEnabled = !env || atoi(env) != 0;
+
+    env = getenv("LOUVRE_SCENE_AUTO_LAYERS");
+    imp()->state.setFlag(LSS::AutoLayers, env && atoi(env) == 1);
 }
 
 LScene::~LScene() { notifyDestruction(); }
@@ -42,6 +50,23 @@ bool LScene::autoRepaintEnabled() const noexcept
     return imp()->state.check(LSS::AutoRepaint);
 }
 
+void LScene::enableAutoLayers(bool enabled) noexcept
+{
+    if (enabled == autoLayersEnabled())
+        return;
+
+    imp()->state.setFlag(LSS::AutoLayers, enabled);
+
+    // Layers are created and destroyed while rendering
+    for (LOutput *o : compositor()->outputs())
+        o->repaint();
+}
+
+bool LScene::autoLayersEnabled() const noexcept
+{
+    return imp()->state.check(LSS::AutoLayers);
+}
+
 const std::vector<LView *> &LScene::pointerFocus() const
 {
     return imp()->pointerFocus;
@@ -114,9 +139,9 @@ void LScene::handleUninitializeGL(LOutput *output)
         return;
 
     imp()->mutex.lock();
-    auto it { imp()->view.m_sceneThreadsMap.find(output->threadId()) };
-    if (it != imp()->view.m_sceneThreadsMap.end())
-        imp()->view.m_sceneThreadsMap.erase(it);
+    const UInt32 slot { output->imp()->threadSlot };
+    if (slot < imp()->view.m_sceneThreadsData.size())
+        imp()->view.m_sceneThreadsData[slot].reset();
     imp()->mutex.unlock();
 }
 
@@ -126,6 +151,15 @@ void LScene::handlePointerMoveEvent(const LPointerMoveEvent &event, LBitset<Even
     if (imp()->state.check(LSS::HandlingPointerMoveEvent))
         return;
 
+    // The absolute motion is notified later, see LPointer::enableMotionCoalescing()
+    if (event.motion() == LPointerMoveEvent::RelativeOnly)
+    {
+        if (options & WaylandEvents)
+            seat()->pointer()->sendMoveEvent(event);
+
+        return;
+    }
+
     imp()->currentPointerMoveEvent = event;
 
     imp()->currentPointerEnterEvent.setDevice(event.device());
@@ -197,10 +231,9 @@ void LScene::handlePointerMoveEvent(const LPointerMoveEvent &event, LBitset<Even
 
     cursor()->repaintOutputs(true);
 
-    imp()->state.remove(LSS::ChildrenListChanged | LSS::PointerIsBlocked);
+    imp()->state.remove(LSS::PointerIsBlocked);
     imp()->state.add(LSS::HandlingPointerMoveEvent);
-    LView::removeFlagWithChildren(mainView(), LVS::PointerMoveDone);
-    imp()->handlePointerMove(mainView());
+    imp()->handlePointerMove();
     imp()->state.remove(LSS::HandlingPointerMoveEvent);
 
     if (!(options & WaylandEvents))
@@ -1399,5 +1432,8 @@ LSceneView *LScene::mainView() const
 
 LView *LScene::viewAt(const LPoint &pos, LView::Type type, LBitset<InputFilter> filter)
 {
-    return imp()->viewAt(mainView(), pos, type, filter);
+    if (filter == FilterDisabled || !imp()->inputIndexEnabled)
+        return imp()->viewAt(mainView(), pos, type, filter);
+
+    return imp()->indexedViewAt(pos, type, filter);
 }
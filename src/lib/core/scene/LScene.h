@@ -152,6 +152,31 @@ public:
      */
     bool autoRepaintEnabled() const noexcept;
 
+    /**
+     * @brief Enables or disables automatic layers.
+     *
+     * When enabled, subtrees of views that remain unchanged for several frames of an output, while other parts of the scene
+     * are repainted, are rendered once into a cached framebuffer and then composited with a single texture draw per damaged rect,
+     * instead of repainting each of their views.\n
+     * Subtrees are only cached if they have several mapped renderable views. Those that change frequently are demoted back
+     * and take progressively longer to be promoted again.\n
+     * Subtrees containing LSceneViews or views with a custom blend function (see LView::enableAutoBlendFunc()) are never cached,
+     * and layers are not used on outputs with a fractional scale.
+     *
+     * This is similar to manually placing views into an LSceneView, but layers are only kept while they are useful and
+     * their content is redrawn only when it changes.
+     *
+     * Disabled by default, can also be enabled by setting the **LOUVRE_SCENE_AUTO_LAYERS** environment variable to `1`.
+     */
+    void enableAutoLayers(bool enabled) noexcept;
+
+    /**
+     * @brief Checks if automatic layers are enabled.
+     *
+     * @see enableAutoLayers()
+     */
+    bool autoLayersEnabled() const noexcept;
+
     /**
      * @brief Vector of views with pointer focus.
      *
@@ -1,12 +1,67 @@
 #include <private/LCompositorPrivate.h>
 #include <private/LPainterPrivate.h>
+#include <private/LOutputPrivate.h>
+#include <private/LFrameArena.h>
+#include <private/LSceneLayer.h>
 #include <LSurfaceView.h>
 #include <LSceneView.h>
 #include <LScene.h>
 #include <LUtils.h>
+#include <cmath>
+#include <cstring>
 
 using namespace Louvre;
 
+// Identifies each LSceneView::forEachChild() call of the thread, children are stamped in their thread data
+static thread_local UInt32 childrenPassSerial { 0 };
+
+template<class Func>
+void LSceneView::forEachChild(LView *view, bool topToBottom, Func func) noexcept
+{
+    const UInt32 slot { LCompositor::LCompositorPrivate::currentThreadSlot() };
+    const UInt32 pass { ++childrenPassSerial };
+    UInt32 serial { view->childrenSerial() };
+    const std::vector<LView*> &views { view->childrenArray() };
+    const std::size_t count { views.size() };
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        LView *child { views[topToBottom ? count - 1 - i : i] };
+        child->threadData(slot).childrenPass = pass;
+        func(child);
+
+        // The array may now contain destroyed views
+        if (view->childrenSerial() != serial)
+            goto listChanged;
+    }
+
+    return;
+
+listChanged:
+    serial = view->childrenSerial();
+
+    for (LView *child { topToBottom ? view->childrenList().back() : view->childrenList().front() }; child;)
+    {
+        if (child->threadData(slot).childrenPass == pass)
+        {
+            child = topToBottom ? child->m_prevSibling : child->m_nextSibling;
+            continue;
+        }
+
+        child->threadData(slot).childrenPass = pass;
+        func(child);
+
+        // Start again, visited children are skipped
+        if (view->childrenSerial() != serial)
+        {
+            serial = view->childrenSerial();
+            child = topToBottom ? view->childrenList().back() : view->childrenList().front();
+        }
+        else
+            child = topToBottom ? child->m_prevSibling : child->m_nextSibling;
+    }
+}
+
 LSceneView::~LSceneView() noexcept
 {
     notifyDestruction();
@@ -22,10 +77,11 @@ LSceneView::~LSceneView() noexcept
 
 void LSceneView::damageAll(LOutput *output) noexcept
 {
-    if (!output)
+    // Not initialized
+    if (!output || output->imp()->threadSlot == UINT32_MAX)
         return;
 
-    ThreadData &td { m_sceneThreadsMap[output->threadId()] };
+    ThreadData &td { sceneThreadData(output->imp()->threadSlot) };
 
     if (isLScene())
         td.manuallyAddedDamage.addRect(output->rect());
@@ -43,10 +99,11 @@ void LSceneView::addDamage(LOutput *output, const LRegion &damage) noexcept
     if (!output)
         return;
 
-    ThreadData &td { m_sceneThreadsMap[output->threadId()] };
+    const UInt32 slot { output->imp()->threadSlot };
 
-    if (td.o)
-        td.manuallyAddedDamage.addRegion(damage);
+    // Only if already rendered by the output
+    if (slot < m_sceneThreadsData.size() && m_sceneThreadsData[slot] && m_sceneThreadsData[slot]->o)
+        m_sceneThreadsData[slot]->manuallyAddedDamage.addRegion(damage);
 
     if (!isLScene() && scene() && scene()->autoRepaintEnabled())
         output->repaint();
@@ -65,7 +122,7 @@ void LSceneView::render(const LRegion *exclude) noexcept
     if (!isLScene())
         static_cast<LRenderBuffer*>(m_fb)->setPos(pos());
 
-    m_currentThreadData.reset(&m_sceneThreadsMap[std::this_thread::get_id()]);
+    m_currentThreadData.reset(&sceneThreadData(LCompositor::LCompositorPrivate::currentThreadSlot()));
 
     if (!m_currentThreadData)
         return;
@@ -82,6 +139,28 @@ void LSceneView::render(const LRegion *exclude) noexcept
     clearTmpVariables(ctd);
     checkRectChange(ctd);
 
+    // Layers must match the framebuffer pixels exactly
+    ctd.autoLayers = scene() && scene()->autoLayersEnabled() && m_fb->scale() == std::floor(m_fb->scale());
+    ctd.layerHash = 0;
+    ctd.layerChanges = 0;
+    ctd.layerDraws = 0;
+    ctd.layerBlockers = 0;
+    ctd.layerDepth = 0;
+    ctd.layerCount = 0;
+    ctd.layerFills.clear();
+
+    /* Skipped subtrees keep the regions, occlusion and entered outputs of the last frame, which also depend on
+     * the framebuffer rect and the outputs layout. Layers of skipped subtrees would not be updated */
+    ctd.skipUnchanged = !ctd.autoLayers && !ctd.prevAutoLayers &&
+                        ctd.prevFbRect == m_fb->rect() &&
+                        ctd.prevOutputsLayoutSerial == compositor()->imp()->outputsLayoutSerial;
+    ctd.prevFbRect = m_fb->rect();
+    ctd.prevOutputsLayoutSerial = compositor()->imp()->outputsLayoutSerial;
+    ctd.prevAutoLayers = ctd.autoLayers;
+
+    if (isLScene())
+        compositor()->imp()->checkOutputsLayout();
+
     // Add manual damage
     if (!ctd.manuallyAddedDamage.empty())
     {
@@ -106,8 +185,27 @@ void LSceneView::render(const LRegion *exclude) noexcept
         }
     }
 
-    for (std::list<LView*>::const_reverse_iterator it = children().crbegin(); it != children().crend(); it++)
-        calcNewDamage(*it);
+#if LOUVRE_PROFILING == 1
+    // Nested scenes are rendered within the phases of the main one, only time the outermost
+    auto &stats { painter->imp()->stats };
+    UInt64 profilerStart { isLScene() ? LPainter::LPainterPrivate::profilerNs() : 0 };
+#endif
+
+    /* Unchanged subtrees with the same opaque region above them as in the last frame are skipped,
+     * so only changed views, their parents and siblings are visited, see calcNewDamage() */
+    forEachChild(this, true, [this](LView *child)
+    {
+        calcNewDamage(child, false);
+    });
+
+#if LOUVRE_PROFILING == 1
+    if (isLScene())
+    {
+        const UInt64 now { LPainter::LPainterPrivate::profilerNs() };
+        stats.calcNewDamageNs += now - profilerStart;
+        profilerStart = now;
+    }
+#endif
 
     Int32 age { m_fb->bufferAge() };
 
@@ -139,17 +237,71 @@ void LSceneView::render(const LRegion *exclude) noexcept
     else
         ctd.damageRingIndex++;
 
-    glDisable(GL_BLEND);
+#if LOUVRE_PROFILING == 1
+    if (isLScene())
+    {
+        const UInt64 now { LPainter::LPainterPrivate::profilerNs() };
+        stats.bufferAgeDamageNs += now - profilerStart;
+        profilerStart = now;
+    }
+#endif
 
-    for (std::list<LView*>::const_reverse_iterator it = children().crbegin(); it != children().crend(); it++)
-        drawOpaqueDamage(*it);
+    painter->imp()->enableBlending(false);
+    painter->imp()->beginDrawPass(true);
+
+    forEachChild(this, true, [this](LView *child)
+    {
+        drawOpaqueDamage(child);
+    });
+
+#if LOUVRE_PROFILING == 1
+    if (isLScene())
+    {
+        const UInt64 now { LPainter::LPainterPrivate::profilerNs() };
+        stats.drawOpaqueDamageNs += now - profilerStart;
+        profilerStart = now;
+    }
+#endif
 
     drawBackground(!isLScene() && m_clearColor.a >= 1.f);
 
-    glEnable(GL_BLEND);
+#if LOUVRE_PROFILING == 1
+    if (isLScene())
+    {
+        const UInt64 now { LPainter::LPainterPrivate::profilerNs() };
+        stats.drawBackgroundNs += now - profilerStart;
+        profilerStart = now;
+    }
+#endif
+
+    // Submits the opaque draws deferred by sorted passes
+    painter->imp()->endDrawPass();
+
+#if LOUVRE_PROFILING == 1
+    if (isLScene())
+    {
+        const UInt64 now { LPainter::LPainterPrivate::profilerNs() };
+        stats.drawOpaqueDamageNs += now - profilerStart;
+        profilerStart = now;
+    }
+#endif
+
+    painter->imp()->enableBlending(true);
+    painter->imp()->beginDrawPass(false);
+
+    forEachChild(this, false, [this](LView *child)
+    {
+        drawTranslucentDamage(child);
+    });
+
+    painter->imp()->endDrawPass();
 
-    for (std::list<LView*>::const_iterator it = children().cbegin(); it != children().cend(); it++)
-        drawTranslucentDamage(*it);
+#if LOUVRE_PROFILING == 1
+    if (isLScene())
+        stats.drawTranslucentDamageNs += LPainter::LPainterPrivate::profilerNs() - profilerStart;
+#endif
+
+    fillLayers();
 
     if (!isLScene())
     {
@@ -252,10 +404,201 @@ void LSceneView::paintEvent(const PaintEventParams &params) noexcept
     params.painter->drawRegion(*params.region);
 }
 
-void LSceneView::calcNewDamage(LView *view) noexcept
+static void boxUnion(LBox &box, const LBox &other) noexcept
+{
+    if (other.x1 >= other.x2 || other.y1 >= other.y2)
+        return;
+
+    if (box.x1 >= box.x2 || box.y1 >= box.y2)
+    {
+        box = other;
+        return;
+    }
+
+    box.x1 = std::min(box.x1, other.x1);
+    box.y1 = std::min(box.y1, other.y1);
+    box.x2 = std::max(box.x2, other.x2);
+    box.y2 = std::max(box.y2, other.y2);
+}
+
+static UInt64 layerHashCombine(UInt64 hash, UInt64 value) noexcept
+{
+    return (hash ^ value) * 0x100000001b3ULL;
+}
+
+static bool boxIntersectsRect(const LBox &box, const LRect &rect) noexcept
+{
+    return box.x1 < box.x2 && box.y1 < box.y2 &&
+           box.x1 < rect.x() + rect.w() && box.x2 > rect.x() &&
+           box.y1 < rect.y() + rect.h() && box.y2 > rect.y();
+}
+
+static bool regionIntersectsBox(const LRegion &region, const LBox &box) noexcept
+{
+    Int32 n;
+    const LBox *boxes { region.boxes(&n) };
+
+    for (Int32 i = 0; i < n; i++)
+        if (boxes[i].x1 < box.x2 && boxes[i].x2 > box.x1 && boxes[i].y1 < box.y2 && boxes[i].y2 > box.y1)
+            return true;
+
+    return false;
+}
+
+// Equal regions with boxes in a different order are reported as different
+static bool regionsEqual(const LRegion &a, const LRegion &b) noexcept
+{
+    Int32 n, bn;
+    const LBox *aBoxes { a.boxes(&n) };
+    const LBox *bBoxes { b.boxes(&bn) };
+    return n == bn && (n == 0 || std::memcmp(aBoxes, bBoxes, n * sizeof(LBox)) == 0);
+}
+
+// Checks if the region is covered by the opaque one without computing their difference
+static bool coveredBy(const LRegion &region, const LRegion &opaque) noexcept
+{
+    Int32 n, opaqueN;
+    const LBox *boxes { region.boxes(&n) };
+
+    if (n == 0)
+        return true;
+
+    const LBox *opaqueBoxes { opaque.boxes(&opaqueN) };
+
+    if (opaqueN == 0)
+        return false;
+
+    LFrameArena *arena { LFrameArena::current() };
+    LFrameArena::Marker marker { arena };
+    pixman_region32_t tmp;
+    pixman_region32_t *opaqueRegion { &tmp };
+
+    // Only inline regions need a temporary Pixman copy
+    if (LREGION_INLINE_BOXES == 0 || opaqueN > LREGION_INLINE_BOXES)
+        opaqueRegion = opaque.pixmanRegion();
+    else if (arena)
+        arena->initRegion(&tmp, opaqueBoxes, opaqueN);
+    else
+        pixman_region32_init_rects(&tmp, (const pixman_box32_t*)opaqueBoxes, opaqueN);
+
+    bool covered { true };
+
+    for (Int32 i = 0; i < n && covered; i++)
+        covered = pixman_region32_contains_rectangle(opaqueRegion, (pixman_box32_t*)&boxes[i]) == PIXMAN_REGION_IN;
+
+    if (opaqueRegion == &tmp)
+        pixman_region32_fini(&tmp);
+
+    return covered;
+}
+
+void LSceneView::calcNewDamage(LView *view, bool parentChanged) noexcept
 {
     auto &ctd { *m_currentThreadData };
 
+    // Quick view cache handle to reduce verbosity
+    LView::ViewCache &cache { view->m_cache };
+
+    cache.voD = &view->threadData(LCompositor::LCompositorPrivate::currentThreadSlot());
+    cache.rect.setPos(view->pos());
+    cache.rect.setSize(view->size());
+
+    // Changes of a view also invalidate the clipping of its children
+    const bool changed { parentChanged || cache.voD->changeSerial != view->m_changeSerial || cache.rect != cache.voD->prevRect };
+
+    /* Skip subtrees that didn't change, are outside the framebuffer and were already outside in the last frame
+     * (otherwise their previous region must be damaged). Surfaces with new damage or frame callbacks mark their
+     * views as changed, so their requestNextFrame() keeps being called, see LSurfacePrivate::invalidateViewsContent() */
+    cache.culled = !changed &&
+                   !cache.voD->boundsVisible &&
+                   !view->m_state.check(SubtreeChanged | SubtreeNoCulling) &&
+                   !boxIntersectsRect(view->m_subtreeBounds, m_fb->rect());
+
+    LView::ViewThreadData &voD { *cache.voD };
+    voD.culled = cache.culled;
+    cache.skipped = false;
+
+    if (cache.culled)
+    {
+        ctd.layerHash = layerHashCombine(ctd.layerHash, voD.subtreeHash);
+        return;
+    }
+
+    if (!ctd.autoLayers)
+    {
+        // Left from when they were enabled
+        if (voD.layer)
+            destroyLayer(voD);
+
+        // Single views already reuse their regions
+        if (view->children().empty())
+        {
+            calcViewDamage(view, changed);
+            return;
+        }
+
+        /* Nothing changed within the subtree and the views above cover the same region as in the last frame,
+         * so its views would get the same results. Restored by the draw passes only if damaged, see restoreSkipped() */
+        if (ctd.skipUnchanged && !changed && voD.subtreeSerial == view->m_subtreeSerial &&
+            !view->m_state.check(SubtreeNoCulling) && regionsEqual(voD.opaqueAbove, ctd.opaqueSum))
+        {
+            cache.skipped = true;
+            ctd.opaqueSum = voD.opaqueBelow;
+            return;
+        }
+
+        // Changes made by callbacks meanwhile are detected in the next frame
+        const UInt32 subtreeSerial { view->m_subtreeSerial };
+        voD.opaqueAbove = ctd.opaqueSum;
+        calcViewDamage(view, changed);
+        voD.opaqueBelow = ctd.opaqueSum;
+        voD.subtreeSerial = subtreeSerial;
+        return;
+    }
+
+    const UInt64 prevHash { ctd.layerHash };
+    const UInt32 prevChanges { ctd.layerChanges };
+    const UInt32 prevDraws { ctd.layerDraws };
+    const UInt32 prevBlockers { ctd.layerBlockers };
+    const bool insideLayer { ctd.layerDepth > 0 };
+    const bool hasLayer { voD.layer != nullptr };
+    ctd.layerHash = 0;
+
+    // Views above the subtree occlude the layer as they would occlude its views
+    if (hasLayer)
+    {
+        voD.layer->overlay = ctd.opaqueSum;
+        voD.layer->ready = true;
+        ctd.layerDepth++;
+    }
+
+    calcViewDamage(view, changed);
+
+    if (hasLayer)
+        ctd.layerDepth--;
+
+    const UInt64 hash { layerHashCombine(ctd.layerHash, reinterpret_cast<UInt64>(view)) };
+    const bool subtreeChanged { ctd.layerChanges != prevChanges || hash != voD.subtreeHash };
+    voD.subtreeHash = hash;
+    ctd.layerHash = layerHashCombine(prevHash, hash);
+    updateLayer(view, subtreeChanged, ctd.layerDraws - prevDraws, ctd.layerBlockers != prevBlockers, insideLayer);
+}
+
+void LSceneView::calcViewDamage(LView *view, bool changed) noexcept
+{
+    auto &ctd { *m_currentThreadData };
+    LView::ViewCache &cache { view->m_cache };
+
+    // The content of these can't be cached in a layer
+    if (view->type() == SceneType || !view->autoBlendFuncEnabled())
+        ctd.layerBlockers++;
+
+    cache.voD->changeSerial = view->m_changeSerial;
+    cache.voD->prevRect = cache.rect;
+
+    LBox bounds { 0, 0, 0, 0 };
+    bool noCulling { view->forceRequestNextFrameEnabled() };
+
     // Children first
     if (view->type() == SceneType)
     {
@@ -265,46 +608,61 @@ void LSceneView::calcNewDamage(LView *view) noexcept
             sceneView.render(nullptr);
         else
             sceneView.render(&ctd.opaqueSum);
+
+        // Always rendered, the content of its framebuffer would be outdated when visible again
+        noCulling = true;
     }
     else
     {
-        for (std::list<LView*>::const_reverse_iterator it = view->children().crbegin(); it != view->children().crend(); it++)
-            calcNewDamage(*it);
+        forEachChild(view, true, [&](LView *child)
+        {
+            calcNewDamage(child, changed);
+            boxUnion(bounds, child->m_subtreeBounds);
+            noCulling |= child->m_state.check(SubtreeNoCulling);
+        });
     }
 
-    // Quick view cache handle to reduce verbosity
-    LView::ViewCache &cache { view->m_cache };
-
     view->m_state.remove(RepaintCalled);
 
-    cache.voD = &view->m_threadsMap[std::this_thread::get_id()];
     cache.voD->o = ctd.o;
     cache.mapped = view->mapped();
-    cache.rect.setPos(view->pos());
-    cache.rect.setSize(view->size());
     cache.scalingVector = view->scalingVector();
     cache.scalingEnabled = (view->scalingEnabled() || view->parentScalingEnabled()) && cache.scalingVector != LSizeF(1.f, 1.f);
 
-    LRegion vRegion {cache.rect};
+    LRect vRect { cache.rect };
 
     if (view->clippingEnabled())
-        vRegion.clip(view->clippingRect());
+        vRect.clip(view->clippingRect());
 
     if (view->parent() && view->parentClippingEnabled())
-        vRegion.clip(view->parent()->pos(), view->parent()->size());
+        vRect.clip(LRect(view->parent()->pos(), view->parent()->size()));
+
+    // Update view intersected outputs, only once per change for all threads
+    LCompositor::LCompositorPrivate &c { *compositor()->imp() };
 
-    // Update view intersected outputs
-    for (LOutput *o : compositor()->outputs())
+    if (vRect != view->m_outputsRect || view->m_outputsSerial != c.outputsLayoutSerial || view->m_outputsChangeSerial != view->m_changeSerial)
     {
-        LRegion r { vRegion };
-        r.clip(o->rect());
+        view->m_outputsRect = vRect;
+        view->m_outputsSerial = c.outputsLayoutSerial;
+        view->m_outputsChangeSerial = view->m_changeSerial;
 
-        if (!r.empty())
-            view->enteredOutput(o);
-        else
-            view->leftOutput(o);
+        for (LOutput *o : c.outputs)
+        {
+            LRect r { vRect };
+
+            if (r.clip(o->rect()))
+                view->leftOutput(o);
+            else
+                view->enteredOutput(o);
+        }
     }
 
+    boxUnion(bounds, LBox { vRect.x(), vRect.y(), vRect.x() + vRect.w(), vRect.y() + vRect.h() });
+    view->m_subtreeBounds = bounds;
+    view->m_state.remove(SubtreeChanged);
+    view->m_state.setFlag(SubtreeNoCulling, noCulling);
+    cache.voD->boundsVisible = boxIntersectsRect(bounds, m_fb->rect());
+
     /*
     // TODO add api
     if (view->type() == LView::Type::Surface)
@@ -327,6 +685,9 @@ void LSceneView::calcNewDamage(LView *view) noexcept
     if (view->m_colorFactor.a <= 0.f || cache.rect.size().area() == 0 || cache.opacity <= 0.f || cache.scalingVector.w() == 0.f || cache.scalingVector.y() == 0.f || (view->clippingEnabled() && view->clippingRect().area() == 0))
         cache.mapped = false;
 
+    if (cache.mapped)
+        ctd.layerDraws++;
+
     const bool mappingChanged { cache.mapped != cache.voD->prevMapped };
 
     if (ctd.o && !mappingChanged && !cache.mapped)
@@ -352,6 +713,24 @@ void LSceneView::calcNewDamage(LView *view) noexcept
                              cache.voD->prevColorFactor.a != view->m_colorFactor.a;
     }
 
+    // Same clipping, opaque and translucent regions as in the previous frame, only occlusion may have changed
+    if (!changed && !mappingChanged && !rectChanged && !cache.voD->changedOrder && !opacityChanged && !cache.scalingEnabled && !colorFactorChanged &&
+        view->type() != SceneType && (!view->damage() || view->damage()->empty()))
+    {
+        cache.occluded = coveredBy(cache.voD->prevClipping, ctd.opaqueSum);
+        cache.voD->occluded = cache.occluded;
+
+        if (ctd.o && (!cache.occluded || view->forceRequestNextFrameEnabled()))
+            view->requestNextFrame(ctd.o);
+
+        cache.voD->opaqueOverlay = ctd.opaqueSum;
+        ctd.opaqueSum.addRegion(cache.voD->opaque);
+        return;
+    }
+
+    // The content of the view changed
+    ctd.layerChanges++;
+
     // If rect or order changed (set current rect and prev rect as damage)
     if (mappingChanged || rectChanged || cache.voD->changedOrder || opacityChanged || cache.scalingEnabled || colorFactorChanged)
     {
@@ -364,10 +743,7 @@ void LSceneView::calcNewDamage(LView *view) noexcept
             cache.voD->prevMapped = cache.mapped;
 
         if (rectChanged)
-        {
-            cache.voD->prevRect = cache.rect;
             cache.voD->prevLocalRect = cache.localRect;
-        }
 
         if (opacityChanged)
             cache.voD->prevOpacity = cache.opacity;
@@ -413,9 +789,7 @@ void LSceneView::calcNewDamage(LView *view) noexcept
      * newExposedClipping.subtractRegion(cache.voD->prevClipping);*/
 
     LRegion newExposedClipping;
-    pixman_region32_subtract(&newExposedClipping.m_region,
-                             &currentClipping.m_region,
-                             &cache.voD->prevClipping.m_region);
+    LRegion::subtract(&newExposedClipping, &currentClipping, &cache.voD->prevClipping);
 
     cache.damage.addRegion(newExposedClipping);
 
@@ -435,76 +809,98 @@ void LSceneView::calcNewDamage(LView *view) noexcept
     // Add clipped damage to new damage
     ctd.newDamage.addRegion(cache.damage);
 
+    LRegion &translucent { cache.voD->translucent };
+    LRegion &opaque { cache.voD->opaque };
+
     if (cache.opacity < 1.f || cache.scalingEnabled || view->colorFactor().a < 1.f)
     {
-        cache.translucent.clear();
-        cache.translucent.addRect(cache.rect);
-        cache.opaque.clear();
+        translucent.clear();
+        translucent.addRect(cache.rect);
+        opaque.clear();
     }
     else
     {
         // Store tansposed traslucent region
         if (view->translucentRegion())
         {
-            cache.translucent = *view->translucentRegion();
+            translucent = *view->translucentRegion();
 
             if (view->type() != SceneType)
-                cache.translucent.offset(cache.rect.pos());
+                translucent.offset(cache.rect.pos());
         }
         else
         {
-            cache.translucent.clear();
-            cache.translucent.addRect(cache.rect);
+            translucent.clear();
+            translucent.addRect(cache.rect);
         }
 
         // Store tansposed opaque region
         if (view->opaqueRegion())
         {
-            cache.opaque = *view->opaqueRegion();
+            opaque = *view->opaqueRegion();
 
             if (view->type() != SceneType)
-                cache.opaque.offset(cache.rect.pos());
+                opaque.offset(cache.rect.pos());
         }
         else
         {
-            cache.opaque = cache.translucent;
-            cache.opaque.inverse(cache.rect);
+            opaque = translucent;
+            opaque.inverse(cache.rect);
         }
     }
 
     // Clip opaque and translucent regions to current visible region
-    cache.opaque.intersectRegion(currentClipping);
-    cache.translucent.intersectRegion(currentClipping);
+    opaque.intersectRegion(currentClipping);
+    translucent.intersectRegion(currentClipping);
 
     // Check if view is ocludded
-    currentClipping.subtractRegion(ctd.opaqueSum);
-
-    cache.occluded = currentClipping.empty();
+    cache.occluded = coveredBy(currentClipping, ctd.opaqueSum);
+    cache.voD->occluded = cache.occluded;
 
     if (ctd.o && (!cache.occluded || view->forceRequestNextFrameEnabled()))
         view->requestNextFrame(ctd.o);
 
     // Store sum of previus opaque regions (this will later be clipped when painting opaque and translucent regions)
-    cache.opaqueOverlay = ctd.opaqueSum;
-    ctd.opaqueSum.addRegion(cache.opaque);
+    cache.voD->opaqueOverlay = ctd.opaqueSum;
+    ctd.opaqueSum.addRegion(opaque);
 }
 
 void LSceneView::drawOpaqueDamage(LView *view) noexcept
 {
     auto &ctd { *m_currentThreadData };
+    LView::ViewCache &cache { view->m_cache };
+
+    if (cache.culled)
+        return;
+
+    if (cache.skipped)
+    {
+        if (!regionIntersectsBox(ctd.newDamage, view->m_subtreeBounds))
+            return;
+
+        restoreSkipped(view, LCompositor::LCompositorPrivate::currentThreadSlot());
+    }
+
+    if (cache.voD->layer && cache.voD->layer->ready)
+    {
+        drawLayer(view, false);
+        return;
+    }
 
     // Children first
     if (view->type() != SceneType)
-        for (std::list<LView*>::const_reverse_iterator it = view->children().crbegin(); it != view->children().crend(); it++)
-            drawOpaqueDamage(*it);
-
-    LView::ViewCache &cache { view->m_cache };
+    {
+        forEachChild(view, true, [this](LView *child)
+        {
+            drawOpaqueDamage(child);
+        });
+    }
 
     if (!view->isRenderable() || !cache.mapped || cache.occluded || cache.opacity < 1.f || view->m_colorFactor.a < 1.f)
         return;
 
-    cache.opaque.intersectRegion(ctd.newDamage);
-    cache.opaque.subtractRegion(cache.opaqueOverlay);
+    LRegion::intersect(&m_paintRegion, &cache.voD->opaque, &ctd.newDamage);
+    m_paintRegion.subtractRegion(cache.voD->opaqueOverlay);
 
     ctd.p->enableAutoBlendFunc(view->autoBlendFuncEnabled());
 
@@ -515,7 +911,7 @@ void LSceneView::drawOpaqueDamage(LView *view) noexcept
 
     ctd.p->setAlpha(1.f);
     m_paintParams.painter = ctd.p;
-    m_paintParams.region = &cache.opaque;
+    m_paintParams.region = &m_paintRegion;
     view->paintEvent(m_paintParams);
 }
 
@@ -524,6 +920,16 @@ void LSceneView::drawTranslucentDamage(LView *view) noexcept
     auto &ctd { *m_currentThreadData };
     auto &cache { view->m_cache };
 
+    // Skipped subtrees are restored by drawOpaqueDamage() if damaged
+    if (cache.culled || cache.skipped)
+        return;
+
+    if (cache.voD->layer && cache.voD->layer->ready)
+    {
+        drawLayer(view, true);
+        return;
+    }
+
     if (!view->isRenderable() || !cache.mapped || cache.occluded)
         goto drawChildrenOnly;
 
@@ -538,18 +944,269 @@ void LSceneView::drawTranslucentDamage(LView *view) noexcept
         ctd.p->setColorFactor(1.f, 1.f, 1.f, 1.f);
 
     cache.occluded = true;
-    cache.translucent.intersectRegion(ctd.newDamage);
-    cache.translucent.subtractRegion(cache.opaqueOverlay);
+    LRegion::intersect(&m_paintRegion, &cache.voD->translucent, &ctd.newDamage);
+    m_paintRegion.subtractRegion(cache.voD->opaqueOverlay);
 
     ctd.p->setAlpha(cache.opacity);
     m_paintParams.painter = ctd.p;
-    m_paintParams.region = &cache.translucent;
+    m_paintParams.region = &m_paintRegion;
     view->paintEvent(m_paintParams);
 
 drawChildrenOnly:
     if (view->type() != SceneType)
-        for (std::list<LView*>::const_iterator it = view->children().cbegin(); it != view->children().cend(); it++)
-            drawTranslucentDamage(*it);
+        forEachChild(view, false, [this](LView *child)
+        {
+            drawTranslucentDamage(child);
+        });
+}
+
+void LSceneView::restoreSkipped(LView *view, UInt32 slot) noexcept
+{
+    LView::ViewCache &cache { view->m_cache };
+    cache.voD = &view->threadData(slot);
+    cache.culled = cache.voD->culled;
+    cache.occluded = cache.voD->occluded;
+    cache.mapped = cache.voD->prevMapped;
+    cache.opacity = cache.voD->prevOpacity;
+    cache.skipped = false;
+
+    if (cache.culled || view->type() == SceneType)
+        return;
+
+    for (LView *child : view->childrenArray())
+        restoreSkipped(child, slot);
 }
 
+void LSceneView::updateLayer(LView *view, bool changed, UInt32 draws, bool blocked, bool insideLayer) noexcept
+{
+    auto &ctd { *m_currentThreadData };
+    LView::ViewThreadData &voD { *view->m_cache.voD };
+
+    LRect rect { view->m_subtreeBounds.x1, view->m_subtreeBounds.y1,
+                 view->m_subtreeBounds.x2 - view->m_subtreeBounds.x1, view->m_subtreeBounds.y2 - view->m_subtreeBounds.y1 };
+    const bool empty { rect.clip(m_fb->rect()) };
+
+    voD.layerEligible = !blocked && !empty && draws >= LSCENE_LAYER_MIN_VIEWS;
 
+    if (changed || !voD.layerEligible)
+    {
+        // Subtrees that keep changing take longer to be promoted again
+        if (voD.layer)
+        {
+            destroyLayer(voD);
+
+            if (changed && voD.layerDemotions < LSCENE_LAYER_MAX_DEMOTIONS)
+                voD.layerDemotions++;
+        }
+
+        voD.stableFrames = 0;
+        return;
+    }
+
+    if (voD.stableFrames < UINT16_MAX)
+        voD.stableFrames++;
+
+    const UInt32 requiredFrames { UInt32(LSCENE_LAYER_STABLE_FRAMES) << voD.layerDemotions };
+
+    if (voD.layer)
+    {
+        // The framebuffer was moved or rescaled
+        if (voD.layer->buffer.rect() != rect || voD.layer->buffer.scale() != m_fb->scale())
+        {
+            destroyLayer(voD);
+            voD.stableFrames = 0;
+            return;
+        }
+
+        if (voD.layerDemotions > 0 && voD.stableFrames >= 4 * requiredFrames)
+            voD.layerDemotions = 0;
+
+        ctd.layerCount++;
+        return;
+    }
+
+    if (insideLayer || voD.stableFrames < requiredFrames || ctd.layerCount >= LSCENE_LAYER_MAX)
+        return;
+
+    // Wait if the parent is going to be promoted in this frame
+    if (view->parent())
+    {
+        const LView::ViewThreadData *parentData { view->parent()->findThreadData(LCompositor::LCompositorPrivate::currentThreadSlot()) };
+
+        if (parentData && parentData->layerEligible && !parentData->layer &&
+            UInt32(parentData->stableFrames) + 1 >= (UInt32(LSCENE_LAYER_STABLE_FRAMES) << parentData->layerDemotions))
+            return;
+    }
+
+    // Not ready until the next frame, so its content is painted once the draw passes are done, see fillLayers()
+    voD.layer = new LSceneLayer();
+    ctd.layerFills.push_back({ .view = view, .rect = rect });
+    ctd.layerCount++;
+}
+
+void LSceneView::collectLayerViews(LView *view, UInt32 slot) noexcept
+{
+    if (view->m_cache.culled)
+        return;
+
+    m_layerViews.push_back(view);
+
+    for (LView *child : view->childrenArray())
+    {
+        // Replaced by the new layer
+        destroyLayer(child->threadData(slot));
+        collectLayerViews(child, slot);
+    }
+}
+
+void LSceneView::fillLayers() noexcept
+{
+    auto &ctd { *m_currentThreadData };
+
+    // Parents first, layers of their subtrees are dropped by collectLayerViews()
+    for (auto it = ctd.layerFills.rbegin(); it != ctd.layerFills.rend(); it++)
+    {
+        LView *view { it->view };
+
+        if (!view || !view->m_cache.voD->layer)
+            continue;
+
+        // Changed by a callback during the draw passes, the cached regions of the subtree are outdated
+        if (view->m_state.check(SubtreeChanged))
+            destroyLayer(*view->m_cache.voD);
+        else
+            fillLayer(view, it->rect);
+    }
+
+    ctd.layerFills.clear();
+}
+
+void LSceneView::fillLayer(LView *view, const LRect &rect) noexcept
+{
+    auto &ctd { *m_currentThreadData };
+    LSceneLayer &layer { *view->m_cache.voD->layer };
+    LPainter *p { ctd.p };
+    const Int32 scale { static_cast<Int32>(m_fb->scale()) };
+
+    m_layerViews.clear();
+    collectLayerViews(view, LCompositor::LCompositorPrivate::currentThreadSlot());
+
+    if (m_layerOverlays.size() < m_layerViews.size())
+        m_layerOverlays.resize(m_layerViews.size());
+
+    layer.buffer.setScale(scale);
+    layer.buffer.setSizeB(LSize(rect.w() * scale, rect.h() * scale));
+    layer.buffer.setPos(rect.pos());
+    layer.opaque.clear();
+    layer.translucent.clear();
+
+    LFramebuffer *prevFb { p->boundFramebuffer() };
+    p->bindFramebuffer(&layer.buffer);
+    p->imp()->enableBlending(false);
+
+    // Transparent background
+    p->enableAutoBlendFunc(true);
+    p->setColorFactor(1.f, 1.f, 1.f, 1.f);
+    p->setColor({0.f, 0.f, 0.f});
+    p->setAlpha(0.f);
+    p->bindColorMode();
+    p->drawRect(rect);
+
+    m_paintParams.painter = p;
+    m_paintParams.region = &m_paintRegion;
+
+    // Same passes as render() but ignoring occlusion by views outside the subtree, which may change while it is cached
+    for (Int32 i = m_layerViews.size() - 1; i >= 0; i--)
+    {
+        LView *v { m_layerViews[i] };
+        const LView::ViewCache &cache { v->m_cache };
+        m_layerOverlays[i] = layer.opaque;
+
+        if (!v->isRenderable() || !cache.mapped)
+            continue;
+
+        if (cache.opacity >= 1.f && v->m_colorFactor.a >= 1.f)
+        {
+            LRegion::subtract(&m_paintRegion, &cache.voD->opaque, &layer.opaque);
+            m_paintRegion.clip(rect);
+
+            if (!m_paintRegion.empty())
+            {
+                if (v->m_state.check(ColorFactor))
+                    p->setColorFactor(v->m_colorFactor);
+                else
+                    p->setColorFactor(1.f, 1.f, 1.f, 1.f);
+
+                p->setAlpha(1.f);
+                v->paintEvent(m_paintParams);
+            }
+        }
+
+        layer.opaque.addRegion(cache.voD->opaque);
+        layer.translucent.addRegion(cache.voD->translucent);
+    }
+
+    p->imp()->enableBlending(true);
+
+    for (std::size_t i = 0; i < m_layerViews.size(); i++)
+    {
+        LView *v { m_layerViews[i] };
+        const LView::ViewCache &cache { v->m_cache };
+
+        if (!v->isRenderable() || !cache.mapped)
+            continue;
+
+        LRegion::subtract(&m_paintRegion, &cache.voD->translucent, &m_layerOverlays[i]);
+        m_paintRegion.clip(rect);
+
+        if (m_paintRegion.empty())
+            continue;
+
+        if (v->m_state.check(ColorFactor))
+            p->setColorFactor(v->m_colorFactor);
+        else
+            p->setColorFactor(1.f, 1.f, 1.f, 1.f);
+
+        p->setAlpha(cache.opacity);
+        v->paintEvent(m_paintParams);
+    }
+
+    layer.opaque.clip(rect);
+    layer.translucent.subtractRegion(layer.opaque);
+    layer.translucent.clip(rect);
+    layer.buffer.setFence();
+    p->bindFramebuffer(prevFb);
+}
+
+void LSceneView::drawLayer(LView *view, bool translucent) noexcept
+{
+    auto &ctd { *m_currentThreadData };
+    const LSceneLayer &layer { *view->m_cache.voD->layer };
+
+    LRegion::intersect(&m_paintRegion, translucent ? &layer.translucent : &layer.opaque, &ctd.newDamage);
+    m_paintRegion.subtractRegion(layer.overlay);
+
+    if (m_paintRegion.empty())
+        return;
+
+    ctd.p->bindTextureMode({
+        .texture = layer.buffer.texture(),
+        .pos = layer.buffer.pos(),
+        .srcRect = LRectF(LPointF(), layer.buffer.sizeB()) / layer.buffer.scale(),
+        .dstSize = layer.buffer.size(),
+        .srcTransform = LTransform::Normal,
+        .srcScale = layer.buffer.scale(),
+    });
+
+    ctd.p->enableAutoBlendFunc(true);
+    ctd.p->setColorFactor(1.f, 1.f, 1.f, 1.f);
+    ctd.p->setAlpha(1.f);
+    ctd.p->enableCustomTextureColor(false);
+    ctd.p->drawRegion(m_paintRegion);
+}
+
+void LSceneView::destroyLayer(LView::ViewThreadData &data) noexcept
+{
+    delete data.layer;
+    data.layer = nullptr;
+}
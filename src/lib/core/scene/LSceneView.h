@@ -7,6 +7,7 @@
 #include <LOutput.h>
 #include <LView.h>
 #include <LCursor.h>
+#include <memory>
 
 #define LSCENE_MAX_AGE 5
 
@@ -220,15 +221,54 @@ protected:
         LTransform transform;
         bool oversampling = false;
         bool fractionalScale = false;
+
+        // If unchanged subtrees can be skipped in the current frame, see calcNewDamage()
+        bool skipUnchanged { false };
+        LRect prevFbRect;
+        UInt32 prevOutputsLayoutSerial { 0 };
+        bool prevAutoLayers { false };
+
+        // Automatic layers (see updateLayer()), counters are accumulated while traversing the views
+        bool autoLayers { false };
+        UInt64 layerHash { 0 };
+        UInt32 layerChanges { 0 };
+        UInt32 layerDraws { 0 };
+        UInt32 layerBlockers { 0 };
+        UInt32 layerDepth { 0 };
+        UInt32 layerCount { 0 };
+
+        // Layers promoted while calculating the damage, filled by fillLayers() after the draw passes
+        struct LayerFill
+        {
+            LWeak<LView> view;
+            LRect rect;
+        };
+        std::vector<LayerFill> layerFills;
     };
 
-    std::unordered_map<std::thread::id, ThreadData> m_sceneThreadsMap;
+    // Indexed by the slot of the rendering thread, allocated separately so m_currentThreadData stays valid
+    std::vector<std::unique_ptr<ThreadData>> m_sceneThreadsData;
+    ThreadData &sceneThreadData(UInt32 slot) noexcept
+    {
+        if (slot >= m_sceneThreadsData.size())
+            m_sceneThreadsData.resize(slot + 1);
+
+        if (!m_sceneThreadsData[slot])
+            m_sceneThreadsData[slot] = std::make_unique<ThreadData>();
+
+        return *m_sceneThreadsData[slot];
+    }
     LWeak<ThreadData> m_currentThreadData;
     LFramebuffer *m_fb { nullptr };
     LRGBAF m_clearColor {0.f, 0.f, 0.f, 0.f};
     LPoint m_customPos;
     std::vector<LOutput*> m_outputs;
     PaintEventParams m_paintParams;
+    LRegion m_paintRegion;
+
+    // Reused by fillLayers()
+    std::vector<LView*> m_layerViews;
+    std::vector<LRegion> m_layerOverlays;
 
 private:
     friend class LScene;
@@ -238,9 +278,25 @@ private:
         m_fb(framebuffer)
     {}
 
-    void calcNewDamage(LView *view) noexcept;
+    /* Calls func for each child of view, from the top to the bottom of the stack if topToBottom is true.
+     * If a callback (enteredOutput(), requestNextFrame(), paintEvent(), etc) adds, removes or destroys
+     * children meanwhile, the cached array is dropped and the remaining ones are taken from the updated list */
+    template<class Func>
+    static void forEachChild(LView *view, bool topToBottom, Func func) noexcept;
+
+    void calcNewDamage(LView *view, bool parentChanged) noexcept;
+    void calcViewDamage(LView *view, bool changed) noexcept;
     void drawOpaqueDamage(LView *view) noexcept;
     void drawTranslucentDamage(LView *view) noexcept;
+    void restoreSkipped(LView *view, UInt32 slot) noexcept;
+
+    // Automatic layers, see LScene::enableAutoLayers()
+    void updateLayer(LView *view, bool changed, UInt32 draws, bool blocked, bool insideLayer) noexcept;
+    void fillLayers() noexcept;
+    void fillLayer(LView *view, const LRect &rect) noexcept;
+    void collectLayerViews(LView *view, UInt32 slot) noexcept;
+    void drawLayer(LView *view, bool translucent) noexcept;
+    static void destroyLayer(LView::ViewThreadData &data) noexcept;
 
     void parentClipping(LView *parent, LRegion *region) noexcept
     {
@@ -257,9 +313,7 @@ private:
     {
         auto &ctd {* m_currentThreadData.get() };
         LRegion backgroundDamage;
-        pixman_region32_subtract(&backgroundDamage.m_region,
-                                 &ctd.newDamage.m_region,
-                                 &ctd.opaqueSum.m_region);
+        LRegion::subtract(&backgroundDamage, &ctd.newDamage, &ctd.opaqueSum);
         ctd.p->setColor({.r = m_clearColor.r, .g = m_clearColor.g, .b = m_clearColor.b});
         ctd.p->setAlpha(m_clearColor.a);
         ctd.p->enableAutoBlendFunc(true);
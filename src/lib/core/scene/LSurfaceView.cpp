@@ -1,5 +1,6 @@
 #include <private/LPainterPrivate.h>
 #include <private/LSurfacePrivate.h>
+#include <private/LOutputPrivate.h>
 #include <LSubsurfaceRole.h>
 #include <LOutput.h>
 #include <LUtils.h>
@@ -93,13 +94,14 @@ const std::vector<LOutput *> &LSurfaceView::outputs() const noexcept
 
 void LSurfaceView::requestNextFrame(LOutput *output) noexcept
 {
-    if (!surface() || !output)
+    // Also if the output is not initialized
+    if (!surface() || !output || output->imp()->threadSlot == UINT32_MAX)
         return;
 
     if (forceRequestNextFrameEnabled())
     {
         surface()->requestNextFrame();
-        m_threadsMap[output->threadId()].lastRenderedDamageId = surface()->damageId();
+        threadData(output->imp()->threadSlot).lastRenderedDamageId = surface()->damageId();
         return;
     }
 
@@ -112,7 +114,12 @@ void LSurfaceView::requestNextFrame(LOutput *output) noexcept
     {
         // If the view is visible on another output and has not rendered the new damage
         // prevent clearing the damage immediately
-        if (o != output && (m_threadsMap[o->threadId()].lastRenderedDamageId < surface()->damageId()))
+        if (o == output)
+            continue;
+
+        const ViewThreadData *data { findThreadData(o->imp()->threadSlot) };
+
+        if (!data || data->lastRenderedDamageId < surface()->damageId())
         {
             clearDamage = false;
             o->repaint();
@@ -127,7 +134,7 @@ void LSurfaceView::requestNextFrame(LOutput *output) noexcept
             surface()->parent()->requestNextFrame(false);
     }
 
-    m_threadsMap[output->threadId()].lastRenderedDamageId = surface()->damageId();
+    threadData(output->imp()->threadSlot).lastRenderedDamageId = surface()->damageId();
 }
 
 const LRegion *LSurfaceView::damage() const noexcept
@@ -167,6 +174,23 @@ void LSurfaceView::paintEvent(const PaintEventParams &params) noexcept
     if (!surface())
         return;
 
+    // Single pixel buffers, drawn without sampling the texture (or with glClear() if opaque)
+    const LRGBAF *color { surface()->solidColor() };
+
+    if (color)
+    {
+        if (color->a <= 0.f)
+            return;
+
+        const Float32 alpha { params.painter->alpha() };
+        params.painter->setColor({color->r, color->g, color->b});
+        params.painter->setAlpha(alpha * color->a);
+        params.painter->bindColorMode();
+        params.painter->drawRegion(*params.region);
+        params.painter->setAlpha(alpha);
+        return;
+    }
+
     params.painter->bindTextureMode({
         .texture = surface()->texture(),
         .pos = pos(),
@@ -32,9 +32,10 @@ void LTextureView::setTranslucentRegion(const LRegion *region)
 
 void LTextureView::setTexture(LTexture *texture) noexcept
 {
-    if (texture == m_texture)
+    if (texture == m_texture && !m_atlasEntry)
         return;
 
+    m_atlasEntry.reset();
     m_texture.reset(texture);
 
     if (m_texture)
@@ -44,9 +45,24 @@ void LTextureView::setTexture(LTexture *texture) noexcept
     damageAll();
 }
 
+void LTextureView::setTexture(LTextureAtlas::Entry *entry) noexcept
+{
+    if (entry == m_atlasEntry)
+        return;
+
+    m_texture.reset();
+    m_atlasEntry.reset(entry);
+
+    if (m_atlasEntry)
+        m_textureSerial = m_atlasEntry->texture()->serial();
+
+    updateDimensions();
+    damageAll();
+}
+
 bool LTextureView::nativeMapped() const noexcept
 {
-    return m_texture != nullptr;
+    return texture() != nullptr;
 }
 
 const LPoint &LTextureView::nativePos() const noexcept
@@ -56,9 +72,11 @@ const LPoint &LTextureView::nativePos() const noexcept
 
 const LSize &LTextureView::nativeSize() const noexcept
 {
-    if (m_texture && m_texture->serial() != m_textureSerial)
+    const LTexture *tex { texture() };
+
+    if (tex && tex->serial() != m_textureSerial)
     {
-        m_textureSerial = m_texture->serial();
+        m_textureSerial = tex->serial();
         updateDimensions();
     }
 
@@ -112,16 +130,17 @@ const LRegion *LTextureView::inputRegion() const noexcept
 
 void LTextureView::paintEvent(const PaintEventParams &params) noexcept
 {
-    if (!m_texture)
+    if (!texture())
         return;
 
     params.painter->bindTextureMode({
-        .texture = m_texture,
+        .texture = texture(),
         .pos = pos(),
         .srcRect = srcRect(),
         .dstSize = size(),
         .srcTransform = transform(),
         .srcScale = bufferScale(),
+        .subRectB = m_atlasEntry ? m_atlasEntry->rectB() : LRect()
     });
 
     params.painter->enableCustomTextureColor(customColorEnabled());
@@ -133,33 +152,41 @@ void LTextureView::updateDimensions() const noexcept
 {
     if (dstSizeEnabled())
         m_dstSize = m_customDstSize;
-    else if (m_texture)
+    else if (texture())
     {
         if (Louvre::is90Transform(m_transform))
         {
-            m_dstSize.setW(roundf(Float32(m_texture->sizeB().h()) / m_bufferScale));
-            m_dstSize.setH(roundf(Float32(m_texture->sizeB().w()) / m_bufferScale));
+            m_dstSize.setW(roundf(Float32(textureSizeB().h()) / m_bufferScale));
+            m_dstSize.setH(roundf(Float32(textureSizeB().w()) / m_bufferScale));
         }
         else
         {
-            m_dstSize.setW(roundf(Float32(m_texture->sizeB().w()) / m_bufferScale));
-            m_dstSize.setH(roundf(Float32(m_texture->sizeB().h()) / m_bufferScale));
+            m_dstSize.setW(roundf(Float32(textureSizeB().w()) / m_bufferScale));
+            m_dstSize.setH(roundf(Float32(textureSizeB().h()) / m_bufferScale));
         }
     }
 
     if (srcRectEnabled())
         m_srcRect = m_customSrcRect;
-    else if (m_texture)
+    else if (texture())
     {
         if (Louvre::is90Transform(m_transform))
         {
-            m_srcRect.setW(Float32(m_texture->sizeB().h()) / m_bufferScale);
-            m_srcRect.setH(Float32(m_texture->sizeB().w()) / m_bufferScale);
+            m_srcRect.setW(Float32(textureSizeB().h()) / m_bufferScale);
+            m_srcRect.setH(Float32(textureSizeB().w()) / m_bufferScale);
         }
         else
         {
-            m_srcRect.setW(Float32(m_texture->sizeB().w()) / m_bufferScale);
-            m_srcRect.setH(Float32(m_texture->sizeB().h()) / m_bufferScale);
+            m_srcRect.setW(Float32(textureSizeB().w()) / m_bufferScale);
+            m_srcRect.setH(Float32(textureSizeB().h()) / m_bufferScale);
         }
     }
 }
+
+const LSize &LTextureView::textureSizeB() const noexcept
+{
+    if (m_atlasEntry)
+        return m_atlasEntry->sizeB();
+
+    return m_texture->sizeB();
+}
@@ -3,6 +3,7 @@
 
 #include <LView.h>
 #include <LWeak.h>
+#include <LTextureAtlas.h>
 
 /**
  * @brief View for displaying textures
@@ -24,6 +25,9 @@
  * As of Louvre version 1.2.0, you can define a source rect with applied transformations, adhering to the behavior outlined in the
  * [Viewporter](https://wayland.app/protocols/viewporter) protocol.
  *
+ * Entries of an LTextureAtlas can also be displayed using setTexture(LTextureAtlas::Entry*), in which case the view behaves as if
+ * the entry were the whole texture.
+ *
  * For additional methods and properties available, please refer to the documentation of the `LView` class.
  */
 class Louvre::LTextureView : public LView
@@ -44,6 +48,12 @@ public:
             damageAll();
         });
 
+        m_atlasEntry.setOnDestroyCallback([this](auto)
+        {
+            updateDimensions();
+            damageAll();
+        });
+
         setTexture(texture);
     }
 
@@ -129,16 +139,43 @@ public:
      */
     void setTexture(LTexture *texture) noexcept;
 
+    /**
+     * @brief Set an LTextureAtlas entry as the view's texture.
+     *
+     * The entry is displayed as if it were the whole texture, so the buffer scale, source rect and
+     * transform are relative to its size. Replaces the texture set with setTexture(LTexture*).
+     *
+     * @note If the entry is destroyed, this property is automatically set to `nullptr`.
+     *
+     * @param entry The entry to display or `nullptr` to unset it.
+     */
+    void setTexture(LTextureAtlas::Entry *entry) noexcept;
+
     /**
      * @brief Gets the current LTexture used by the LTextureView.
      *
+     * If an atlas entry is set, its page texture is returned.
+     *
      * @return A pointer to the current LTexture used by the view.
      */
     LTexture *texture() const noexcept
     {
+        if (m_atlasEntry)
+            return m_atlasEntry->texture();
+
         return m_texture.get();
     }
 
+    /**
+     * @brief Gets the current LTextureAtlas entry used by the LTextureView.
+     *
+     * @return The entry set with setTexture(LTextureAtlas::Entry*) or `nullptr`.
+     */
+    LTextureAtlas::Entry *atlasEntry() const noexcept
+    {
+        return m_atlasEntry.get();
+    }
+
     /**
      * @brief Enable or disable the custom destination size for the LTextureView.
      *
@@ -378,6 +415,7 @@ public:
 
 protected:
     LWeak<LTexture> m_texture;
+    LWeak<LTextureAtlas::Entry> m_atlasEntry;
     std::vector<LOutput*> m_outputs;
     std::unique_ptr<LRegion> m_inputRegion;
     std::unique_ptr<LRegion> m_translucentRegion;
@@ -391,6 +429,7 @@ protected:
     LTransform m_transform { LTransform::Normal };
     mutable UInt32 m_textureSerial { 0 };
     void updateDimensions() const noexcept;
+    const LSize &textureSizeB() const noexcept;
 };
 
 #endif // LTEXTUREVIEW_H
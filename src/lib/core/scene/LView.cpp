@@ -23,6 +23,9 @@ LView::~LView() noexcept
     while (!children().empty())
         children().front()->setParent(nullptr);
 
+    for (ViewThreadData &data : m_threadsData)
+        LSceneView::destroyLayer(data);
+
     LVectorRemoveOneUnordered(compositor()->imp()->views, this);
 }
 
@@ -32,6 +35,7 @@ void LView::enableKeyboardEvents(bool enabled) noexcept
         return;
 
     m_state.setFlag(KeyboardEvents, enabled);
+    invalidateInputBounds();
 
     if (scene())
     {
@@ -50,6 +54,7 @@ void LView::enableTouchEvents(bool enabled) noexcept
         return;
 
     m_state.setFlag(TouchEvents, enabled);
+    invalidateInputBounds();
 
     if (scene())
     {
@@ -78,6 +83,7 @@ void LView::enablePointerEvents(bool enabled) noexcept
         return;
 
     m_state.setFlag(PointerEvents, enabled);
+    invalidateInputBounds();
 
     if (!enabled)
     {
@@ -96,6 +102,11 @@ void LView::enablePointerEvents(bool enabled) noexcept
 
 void LView::repaint() const noexcept
 {
+    // Invalidates the input bounds and cached regions of the view
+    invalidateInputBounds();
+    m_changeSerial++;
+    invalidateSubtreeBounds();
+
     if (m_state.check(RepaintCalled) || !scene() || !scene()->autoRepaintEnabled())
         return;
 
@@ -115,13 +126,21 @@ void LView::setParent(LView *view) noexcept
     if (s)
         s->imp()->state.add(LScene::LScenePrivate::ChildrenListChanged);
 
+    compositor()->imp()->viewsInputSerial++;
+
     if (parent())
+    {
+        // Its opaque region is cached by the previous parents
+        parent()->invalidateSubtreeBounds();
         parent()->m_children.erase(m_parentLink);
+        parent()->m_childrenList.erase(this);
+    }
 
     if (view)
     {
         view->m_children.push_back(this);
         m_parentLink = std::prev(view->m_children.end());
+        view->m_childrenList.insertAfter(view->m_childrenList.back(), this);
 
         if (view->scene() != s)
             sceneChanged(view->scene());
@@ -136,6 +155,20 @@ void LView::setParent(LView *view) noexcept
 
     markAsChangedOrder();
     m_parent = view;
+
+    // Bounds of the new parents must include the view
+    m_state.remove(SubtreeChanged);
+    invalidateSubtreeBounds();
+    m_outputsSerial = 0;
+}
+
+void LView::invalidateInputBounds() const noexcept
+{
+    if (!scene() || !scene()->imp()->inputIndexEnabled || m_state.check(InputBoundsChanged))
+        return;
+
+    m_state.add(InputBoundsChanged);
+    scene()->imp()->inputIndexDirty.push_back(const_cast<LView*>(this));
 }
 
 void LView::insertAfter(LView *prev) noexcept
@@ -143,6 +176,9 @@ void LView::insertAfter(LView *prev) noexcept
     if (prev == this)
         return;
 
+    // The stacking order changes, LScene rebuilds its input index
+    compositor()->imp()->viewsInputSerial++;
+
     if (prev)
     {
         setParent(prev->parent());
@@ -152,17 +188,10 @@ void LView::insertAfter(LView *prev) noexcept
         if (!parent())
             return;
 
-        if (prev == parent()->children().back())
-        {
-            parent()->m_children.erase(m_parentLink);
-            parent()->m_children.push_back(this);
-            m_parentLink = std::prev(parent()->m_children.end());
-        }
-        else
-        {
-            parent()->m_children.erase(m_parentLink);
-            m_parentLink = parent()->m_children.insert(std::next(prev->m_parentLink), this);
-        }
+        parent()->m_children.erase(m_parentLink);
+        m_parentLink = parent()->m_children.insert(std::next(prev->m_parentLink), this);
+        parent()->m_childrenList.erase(this);
+        parent()->m_childrenList.insertAfter(prev, this);
     }
 
     // If prev == nullptr, insert to the front of current parent children list
@@ -179,20 +208,28 @@ void LView::insertAfter(LView *prev) noexcept
         parent()->m_children.erase(m_parentLink);
         parent()->m_children.push_front(this);
         m_parentLink = parent()->m_children.begin();
+        parent()->m_childrenList.erase(this);
+        parent()->m_childrenList.insertAfter(nullptr, this);
         markAsChangedOrder();
         repaint();
     }
 }
 
-void LView::removeThread(std::thread::id thread)
+void LView::growThreadsData(UInt32 slot) noexcept
 {
-    auto it { m_threadsMap.find(thread) };
+    m_threadsData.resize(std::max(std::size_t(slot) + 1, compositor()->imp()->threadSlots.size()));
+}
 
-    if (it != m_threadsMap.end())
+void LView::removeThread(UInt32 slot)
+{
+    if (slot < m_threadsData.size())
     {
-        if (it->second.o)
-            leftOutput(it->second.o);
-        m_threadsMap.erase(it);
+        if (m_threadsData[slot].o)
+            leftOutput(m_threadsData[slot].o);
+
+        LSceneView::destroyLayer(m_threadsData[slot]);
+        m_threadsData[slot] = ViewThreadData();
+        m_outputsSerial = 0;
     }
 
     if (type() != SceneType)
@@ -200,16 +237,16 @@ void LView::removeThread(std::thread::id thread)
 
     LSceneView *sceneView { static_cast<LSceneView*>(this) };
 
-    auto sit { sceneView->m_sceneThreadsMap.find(thread) };
-
-    if (sit != sceneView->m_sceneThreadsMap.end())
-        sceneView->m_sceneThreadsMap.erase(sit);
+    if (slot < sceneView->m_sceneThreadsData.size())
+        sceneView->m_sceneThreadsData[slot].reset();
 }
 
 void LView::markAsChangedOrder(bool includeChildren)
 {
-    for (auto &pair : m_threadsMap)
-        pair.second.changedOrder = true;
+    for (ViewThreadData &data : m_threadsData)
+        data.changedOrder = true;
+
+    invalidateSubtreeBounds();
 
     if (scene())
         damageScene(scene()->mainView(), false);
@@ -223,13 +260,13 @@ void LView::damageScene(LSceneView *scene, bool includeChildren)
 {
     if (scene)
     {
-        for (auto &pair : m_threadsMap)
+        for (const ViewThreadData &data : m_threadsData)
         {
-            if (!pair.second.prevMapped)
+            if (!data.prevMapped)
                 continue;
 
-            if (pair.second.o)
-                scene->addDamage(pair.second.o, pair.second.prevClipping);
+            if (data.o)
+                scene->addDamage(data.o, data.prevClipping);
         }
 
         if (includeChildren)
@@ -255,6 +292,18 @@ void LView::sceneChanged(LScene *newScene)
             m_state.remove(PointerIsOver | PendingHoldEnd | PendingPinchEnd | PendingSwipeEnd);
         }
 
+        if (m_state.check(PointerMoveDone))
+        {
+            LVectorRemoveOneUnordered(scene()->imp()->pointerMoveDone, this);
+            m_state.remove(PointerMoveDone);
+        }
+
+        if (m_state.check(InputBoundsChanged))
+        {
+            LVectorRemoveOneUnordered(scene()->imp()->inputIndexDirty, this);
+            m_state.remove(InputBoundsChanged);
+        }
+
         if (m_state.check(TouchEvents))
         {
             for (auto *tp : scene()->touchPoints())
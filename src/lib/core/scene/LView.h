@@ -11,6 +11,12 @@
 #include <vector>
 #include <list>
 #include <map>
+#include <iterator>
+
+namespace Louvre
+{
+    class LSceneLayer;
+}
 
 /**
  * @brief Base class for LScene views.
@@ -128,6 +134,138 @@ public:
         bool blending;
     };
 
+    /**
+     * @brief Intrusive list of children views.
+     *
+     * Holds the same views as children() in the same order, linked through the views themselves.\n
+     * Scenes traverse a contiguous copy of the list, rebuilt only after it changes, instead of following the links.\n
+     * It supports the same iteration as a `const std::list<LView*>`, and iterators remain valid unless the view they point to
+     * is removed from the list.
+     *
+     * @see childrenList()
+     */
+    class ChildrenList
+    {
+    public:
+        /// Bidirectional iterator, dereferences to the child view
+        class const_iterator
+        {
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = LView*;
+            using difference_type = std::ptrdiff_t;
+            using pointer = LView *const *;
+            using reference = LView*;
+
+            const_iterator() noexcept = default;
+            LView *operator*() const noexcept { return m_view; }
+            const_iterator &operator++() noexcept { m_view = m_view->m_nextSibling; return *this; }
+            const_iterator operator++(int) noexcept { const_iterator it { *this }; ++(*this); return it; }
+            const_iterator &operator--() noexcept { m_view = m_view ? m_view->m_prevSibling : m_list->m_back; return *this; }
+            const_iterator operator--(int) noexcept { const_iterator it { *this }; --(*this); return it; }
+            bool operator==(const const_iterator &other) const noexcept { return m_view == other.m_view; }
+            bool operator!=(const const_iterator &other) const noexcept { return m_view != other.m_view; }
+
+        private:
+            friend class ChildrenList;
+            const_iterator(const ChildrenList *list, LView *view) noexcept : m_list(list), m_view(view) {}
+            const ChildrenList *m_list { nullptr };
+            LView *m_view { nullptr };
+        };
+
+        using iterator = const_iterator;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+        using reverse_iterator = const_reverse_iterator;
+
+        ChildrenList() noexcept = default;
+        ChildrenList(const ChildrenList&) = delete;
+        ChildrenList &operator=(const ChildrenList&) = delete;
+
+        const_iterator begin() const noexcept { return { this, m_front }; }
+        const_iterator end() const noexcept { return { this, nullptr }; }
+        const_iterator cbegin() const noexcept { return begin(); }
+        const_iterator cend() const noexcept { return end(); }
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+        const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+        const_reverse_iterator crend() const noexcept { return rend(); }
+
+        /// First child (bottom of the stack), undefined if empty()
+        LView *front() const noexcept { return m_front; }
+
+        /// Last child (top of the stack), undefined if empty()
+        LView *back() const noexcept { return m_back; }
+
+        bool empty() const noexcept { return m_front == nullptr; }
+        std::size_t size() const noexcept { return m_size; }
+
+    private:
+        friend class LView;
+        LView *m_front { nullptr };
+        LView *m_back { nullptr };
+        std::size_t m_size { 0 };
+
+        // Incremented each time the list changes, see LView::childrenSerial()
+        UInt32 m_serial { 0 };
+        mutable std::vector<LView*> m_array;
+        mutable bool m_arrayChanged { false };
+
+        const std::vector<LView*> &array() const noexcept
+        {
+            if (m_arrayChanged)
+            {
+                m_array.clear();
+
+                for (LView *view = m_front; view; view = view->m_nextSibling)
+                    m_array.push_back(view);
+
+                m_arrayChanged = false;
+            }
+
+            return m_array;
+        }
+
+        // Inserts the view after prev, or at the front if prev is nullptr
+        void insertAfter(LView *prev, LView *view) noexcept
+        {
+            LView *next { prev ? prev->m_nextSibling : m_front };
+            view->m_prevSibling = prev;
+            view->m_nextSibling = next;
+
+            if (prev)
+                prev->m_nextSibling = view;
+            else
+                m_front = view;
+
+            if (next)
+                next->m_prevSibling = view;
+            else
+                m_back = view;
+
+            m_size++;
+            m_serial++;
+            m_arrayChanged = true;
+        }
+
+        void erase(LView *view) noexcept
+        {
+            if (view->m_prevSibling)
+                view->m_prevSibling->m_nextSibling = view->m_nextSibling;
+            else
+                m_front = view->m_nextSibling;
+
+            if (view->m_nextSibling)
+                view->m_nextSibling->m_prevSibling = view->m_prevSibling;
+            else
+                m_back = view->m_prevSibling;
+
+            view->m_prevSibling = view->m_nextSibling = nullptr;
+            m_size--;
+            m_serial++;
+            m_arrayChanged = true;
+        }
+    };
+
     /**
      * @brief Construct an LView object.
      *
@@ -366,6 +504,10 @@ public:
      *
      * This method triggers a repaint for all outputs where this view is currently visible.\n
      * Outputs are those returned by the LView::outputs() method.
+     *
+     * @note Custom views must also call it when their position, size, input, opaque or translucent regions change,
+     *       since LScene relies on it to find the views under the cursor without traversing the whole scene,
+     *       and to reuse the regions calculated in previous frames for views that did not change.
      */
     void repaint() const noexcept;
 
@@ -398,10 +540,18 @@ public:
     /**
      * @brief Children views.
      *
-     * @returns A reference to the list of child views.
+     * @returns A reference to the list of child views, ordered from bottom to top.
      */
     const std::list<LView*> &children() const noexcept { return m_children; }
 
+    /**
+     * @brief Children views as an intrusive list.
+     *
+     * Same views and order as children(), but reaching the previous or next sibling doesn't
+     * go through heap-allocated list nodes.
+     */
+    const ChildrenList &childrenList() const noexcept { return m_childrenList; }
+
     /**
      * @brief Toggles the parent position offset.
      *
@@ -793,13 +943,17 @@ public:
      * @brief Toggles forcing triggering the requestNextFrame() event.
      *
      * When enabled, requestNextFrame() will be called even if the view
-     * is occluded or not mapped.
+     * is occluded, not mapped or outside the outputs of the scene.
      * 
      * Disabled by default.
      */
     void enableForceRequestNextFrame(bool enabled) noexcept
     {
+        if (enabled == forceRequestNextFrameEnabled())
+            return;
+
         m_state.setFlag(ForceRequestNextFrame, enabled);
+        invalidateSubtreeBounds();
     }
 
     /**
@@ -1065,7 +1219,8 @@ public:
      * This method is used by the closest parent LSceneView to request the view to paint a specified region
      * on the current framebuffer. Painting can be performed using the provided LPainter object.
      *
-     * @note Using LPainter is optional.
+     * @note Using LPainter is optional. If sorted draw passes are enabled (`LOUVRE_SORTED_DRAW_PASSES=1`), LPainter defers its draws
+     *       until the end of the pass, and views issuing their own OpenGL commands must call LPainter::bindProgram() before them.
      */
     virtual void paintEvent(const PaintEventParams &params) noexcept = 0;
 
@@ -1263,11 +1418,21 @@ public:
         CustomInputRegion       = static_cast<UInt64>(1) << 45,
         CustomTranslucentRegion = static_cast<UInt64>(1) << 46,
         AlwaysMapped            = static_cast<UInt64>(1) << 47,
+
+        // LSceneView culling
+        SubtreeChanged          = static_cast<UInt64>(1) << 48,
+        SubtreeNoCulling        = static_cast<UInt64>(1) << 49,
+
+        // LScene input index
+        InputBoundsChanged      = static_cast<UInt64>(1) << 50,
     };
 
     // This is used for detecting changes on a view since the last time it was drawn on a specific output
     struct ViewThreadData
     {
+        // Clipped opaque and translucent regions, reused while the view doesn't change
+        LRegion opaque;
+        LRegion translucent;
         LRegion prevClipping;
         LRGBAF prevColorFactor;
         LRect prevRect;
@@ -1275,9 +1440,39 @@ public:
         LOutput *o { nullptr };
         Float32 prevOpacity { 1.f };
         UInt32 lastRenderedDamageId { 0 };
+        UInt32 changeSerial { 0 };
         bool prevColorFactorEnabled { false };
         bool changedOrder { true };
         bool prevMapped { false };
+
+        // If m_subtreeBounds intersected the framebuffer the last time the view was calculated
+        bool boundsVisible { false };
+
+        // Results of the last time the view was calculated, restored if its subtree is skipped, see LSceneView::restoreSkipped()
+        LRegion opaqueOverlay;
+        bool occluded { false };
+        bool culled { false };
+
+        // m_subtreeSerial and opaque sums before and after the subtree the last time it was calculated
+        UInt32 subtreeSerial { 0 };
+        LRegion opaqueAbove;
+        LRegion opaqueBelow;
+
+        // Automatic layer of the subtree, created and destroyed by LSceneView, see LScene::enableAutoLayers()
+        LSceneLayer *layer { nullptr };
+
+        // Views of the subtree in stacking order, changes when they are added, removed or restacked
+        UInt64 subtreeHash { 0 };
+
+        // Consecutive frames the subtree didn't change
+        UInt16 stableFrames { 0 };
+        UInt8 layerDemotions { 0 };
+
+        // If the subtree could be cached in the last frame
+        bool layerEligible { false };
+
+        // Last LSceneView::forEachChild() call of the thread that visited the view
+        UInt32 childrenPass { 0 };
     };
 
     // This is used to prevent invoking heavy methods
@@ -1287,23 +1482,32 @@ public:
         LRect rect;
         LRect localRect;
         LRegion damage;
-        LRegion translucent;
-        LRegion opaque;
-        LRegion opaqueOverlay;
         Float32 opacity;
         LSizeF scalingVector;
         bool mapped { false };
         bool occluded { false };
         bool scalingEnabled;
+
+        // Skipped along with its children in the current frame
+        bool culled { false };
+
+        // Unchanged subtree, its children keep the results of the last frame of the thread
+        bool skipped { false };
     };
 
 protected:
     friend class LScene;
     friend class LSceneView;
     friend class LCompositor;
-    mutable LBitset<LViewState> m_state { Visible | ParentOffset | ParentOpacity | BlockPointer | AutoBlendFunc };
+    friend class LSurface;
+    mutable LBitset<LViewState> m_state { Visible | ParentOffset | ParentOpacity | BlockPointer | AutoBlendFunc | SubtreeChanged };
     LScene *m_scene { nullptr };
     LView *m_parent { nullptr };
+
+    // Links within the children list of the parent
+    LView *m_prevSibling { nullptr };
+    LView *m_nextSibling { nullptr };
+    ChildrenList m_childrenList;
     std::list<LView*> m_children;
     std::list<LView*>::iterator m_parentLink;
     UInt32 m_type;
@@ -1320,22 +1524,80 @@ protected:
     mutable LSize m_tmpSize;
     mutable LSizeF m_tmpSizeF;
     ViewCache m_cache;
-    std::map<std::thread::id,ViewThreadData> m_threadsMap;
+
+    // Indexed by the slot of the rendering thread, see threadData()
+    std::vector<ViewThreadData> m_threadsData;
+
+    // Incremented by repaint(), views not changed since the last frame of a thread reuse their regions
+    mutable UInt32 m_changeSerial { 1 };
+
+    // Incremented by invalidateSubtreeBounds() for the view and its parents, unchanged subtrees are skipped by LSceneView
+    mutable UInt32 m_subtreeSerial { 1 };
+
+    /* Bounding box of the visible rects of the view and its children, valid while SubtreeChanged is unset.
+     * LSceneView skips unchanged subtrees outside its framebuffer */
+    LBox m_subtreeBounds { 0, 0, 0, 0 };
+
+    // Visible rect and serials of the last intersected outputs update, see LSceneView::calcNewDamage()
+    LRect m_outputsRect;
+    UInt32 m_outputsSerial { 0 };
+    UInt32 m_outputsChangeSerial { 0 };
+
+    // Marks the view and its parents as changed, must be called when the visible rect may change without repaint()
+    void invalidateSubtreeBounds() const noexcept
+    {
+        for (const LView *view = this; view; view = view->parent())
+        {
+            view->m_state.add(SubtreeChanged);
+            view->m_subtreeSerial++;
+        }
+    }
+
+    // Queues the view and its children for an update of the LScene input index, see LScene::LScenePrivate::updateInputIndex()
+    void invalidateInputBounds() const noexcept;
 
     bool repaintCalled() const noexcept
     {
         return m_state.check(RepaintCalled);
     }
 
+    // Contiguous copy of children(), invalidated when the list changes, must not be iterated while modifying it
+    const std::vector<LView*> &childrenArray() const noexcept
+    {
+        return m_childrenList.array();
+    }
+
+    // Changes when children are added, removed or restacked, used to detect changes made by callbacks during a traversal
+    UInt32 childrenSerial() const noexcept
+    {
+        return m_childrenList.m_serial;
+    }
+
     static void removeFlagWithChildren(LView *view, UInt64 flag)
     {
         view->m_state.remove(flag);
 
-        for (LView *child : view->children())
+        for (LView *child : view->childrenArray())
             removeFlagWithChildren(child, flag);
     }
 
-    void removeThread(std::thread::id thread);
+    // Grows the array to fit all the current thread slots, so the data of other threads is not moved while rendering
+    ViewThreadData &threadData(UInt32 slot) noexcept
+    {
+        if (slot >= m_threadsData.size())
+            growThreadsData(slot);
+
+        return m_threadsData[slot];
+    }
+
+    // Returns nullptr if the thread never rendered the view
+    const ViewThreadData *findThreadData(UInt32 slot) const noexcept
+    {
+        return slot < m_threadsData.size() ? &m_threadsData[slot] : nullptr;
+    }
+
+    void growThreadsData(UInt32 slot) noexcept;
+    void removeThread(UInt32 slot);
     void markAsChangedOrder(bool includeChildren = true);
     void damageScene(LSceneView *scene, bool includeChildren);
     void sceneChanged(LScene *newScene);
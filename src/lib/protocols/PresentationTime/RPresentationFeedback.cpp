@@ -24,6 +24,7 @@ RPresentationFeedback::RPresentationFeedback
     m_surface(surface)
 {
     surface->imp()->presentationFeedbackResources.push_back(this);
+    surface->imp()->queuePresentationFeedback();
 }
 
 RPresentationFeedback::~RPresentationFeedback() noexcept
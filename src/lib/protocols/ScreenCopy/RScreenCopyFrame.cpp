@@ -124,7 +124,10 @@ RScreenCopyFrame::~RScreenCopyFrame() noexcept
         wl_list_remove(&m_bufferContainer.onDestroy.link);
 
     if (output())
+    {
         LVectorRemoveOneUnordered(output()->imp()->screenshotRequests, &m_frame);
+        output()->imp()->screenshotReadback.cancel(&m_frame);
+    }
 }
 
 void RScreenCopyFrame::copyCommon(wl_resource *resource, wl_resource *buffer, bool waitForDamage) noexcept
@@ -1,8 +1,10 @@
 #include <protocols/Wayland/RDataOffer.h>
 #include <protocols/Wayland/RDataDevice.h>
 #include <protocols/Wayland/GSeat.h>
+#include <private/LClipboardTransfer.h>
 #include <LClient.h>
 #include <LDNDSession.h>
+#include <sys/stat.h>
 
 using namespace Louvre;
 using namespace Louvre::Protocols::Wayland;
@@ -101,48 +103,15 @@ void RDataOffer::receive(wl_client */*client*/, wl_resource *resource, const cha
                 }
                 else if (mimeType.tmp)
                 {
-                    fseek(mimeType.tmp, 0L, SEEK_END);
+                    struct stat st;
 
-                    Int64 total { ftell(mimeType.tmp) };
-
-                    // If pointer is at the beggining means the source client has not written any data
-                    if (total == 0)
+                    // Empty if the source client has not written any data
+                    if (fstat(fileno(mimeType.tmp), &st) != 0 || st.st_size == 0)
                         break;
 
-                    rewind(mimeType.tmp);
-
-                    Int64 written = 0, readN = 0, toRead = 0, offset = 0;
-                    UChar8 buffer[1024];
-
-                    while (total > 0)
-                    {
-                        if (total < 1024)
-                            toRead = total;
-                        else
-                            toRead = 1024;
-
-                        readN = fread(buffer, sizeof(UChar8), toRead, mimeType.tmp);
-
-                        if (readN != toRead)
-                            break;
-
-                        offset = 0;
-
-                    retryWrite:
-                        written = write(fd, &buffer[offset], readN);
-
-                        if (written > 0)
-                            offset += written;
-                        else if (written == -1)
-                            break;
-                        else if (written == 0)
-                            goto retryWrite;
-
-                        if (offset != readN)
-                            goto retryWrite;
-
-                        total -= readN;
-                    }
+                    // Written asynchronously, the transfer closes the fd
+                    LClipboardTransfer::start(fileno(mimeType.tmp), st.st_size, fd);
+                    return;
                 }
 
                 break;
@@ -2,9 +2,14 @@
 #include <protocols/Wayland/RDataDevice.h>
 #include <protocols/Wayland/RDataOffer.h>
 #include <private/LCompositorPrivate.h>
+#include <private/LClipboardTransfer.h>
 #include <LDNDSession.h>
 #include <LClipboard.h>
 #include <LSeat.h>
+#include <LLog.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace Louvre::Protocols::Wayland;
 
@@ -38,10 +43,24 @@ RDataSource::~RDataSource() noexcept
     {
         seat()->clipboard()->clear();
 
+        struct stat st;
+
         // Save persistent MIME types
         for (auto &mimeType : m_mimeTypes)
-            if (mimeType.tmp != NULL)
-                seat()->clipboard()->m_persistentMimeTypes.push_back(mimeType);
+        {
+            if (mimeType.tmp == NULL)
+                continue;
+
+            // Never written or discarded by LClipboardTransfer::receive() for exceeding LOUVRE_CLIPBOARD_MAX_SIZE
+            if (!LClipboardTransfer::receiving(fileno(mimeType.tmp)) && fstat(fileno(mimeType.tmp), &st) == 0 && st.st_size == 0)
+            {
+                LLog::debug("[RDataSource::~RDataSource] Persistent MIME type %s discarded, no data stored.", mimeType.mimeType.c_str());
+                fclose(mimeType.tmp);
+                continue;
+            }
+
+            seat()->clipboard()->m_persistentMimeTypes.push_back(mimeType);
+        }
 
         // Update current offer
         if (seat()->clipboard()->m_dataOffer && seat()->clipboard()->m_dataOffer->dataDeviceRes())
@@ -56,8 +75,23 @@ void RDataSource::requestPersistentMimeType(LClipboard::MimeTypeFile &mimeType)
 
     if (seat()->clipboard()->persistentMimeTypeFilter(mimeType.mimeType))
     {
-        mimeType.tmp = tmpfile();
-        send(mimeType.mimeType.c_str(), fileno(mimeType.tmp));
+        mimeType.tmp = LClipboardTransfer::createStorage();
+
+        if (!mimeType.tmp)
+            return;
+
+        // Read by the compositor, so LOUVRE_CLIPBOARD_MAX_SIZE is checked while the client writes it
+        Int32 fds[2];
+
+        if (pipe2(fds, O_CLOEXEC) != 0)
+        {
+            send(mimeType.mimeType.c_str(), fileno(mimeType.tmp));
+            return;
+        }
+
+        send(mimeType.mimeType.c_str(), fds[1]);
+        close(fds[1]);
+        LClipboardTransfer::receive(fds[0], fileno(mimeType.tmp));
     }
 }
 
@@ -24,6 +24,24 @@ RRegion::RRegion(
     )
 {}
 
+void RRegion::flush() const noexcept
+{
+    if (m_pending.empty())
+        return;
+
+    if (m_pendingSubtract)
+    {
+        LRegion subtract;
+        subtract.addBoxes(m_pending.data(), m_pending.size());
+        m_region.subtractRegion(subtract);
+        m_pendingSubtract = false;
+    }
+    else
+        m_region.addBoxes(m_pending.data(), m_pending.size());
+
+    m_pending.clear();
+}
+
 void RRegion::destroy(wl_client */*client*/, wl_resource *resource) noexcept
 {
     wl_resource_destroy(resource);
@@ -43,9 +61,10 @@ void RRegion::add(wl_client */*client*/, wl_resource *resource, Int32 x, Int32 y
 
     auto &regionRes { *static_cast<RRegion*>(wl_resource_get_user_data(resource)) };
 
-    pixman_region32_union_rect(&regionRes.m_region.m_region,
-                               &regionRes.m_region.m_region,
-                               x, y, width, height);
+    if (regionRes.m_pendingSubtract)
+        regionRes.flush();
+
+    regionRes.m_pending.push_back({ x, y, x + width, y + height });
 }
 
 void RRegion::subtract(wl_client */*client*/, wl_resource *resource, Int32 x, Int32 y, Int32 width, Int32 height) noexcept
@@ -62,7 +81,11 @@ void RRegion::subtract(wl_client */*client*/, wl_resource *resource, Int32 x, In
 
     auto &regionRes { *static_cast<RRegion*>(wl_resource_get_user_data(resource)) };
 
-    pixman_region32_union_rect(&regionRes.m_subtract.m_region,
-                               &regionRes.m_subtract.m_region,
-                               x, y, width, height);
+    if (!regionRes.m_pendingSubtract)
+    {
+        regionRes.flush();
+        regionRes.m_pendingSubtract = true;
+    }
+
+    regionRes.m_pending.push_back({ x, y, x + width, y + height });
 }
@@ -3,18 +3,14 @@
 
 #include <LResource.h>
 #include <LRegion.h>
+#include <vector>
 
 class Louvre::Protocols::Wayland::RRegion final : public LResource
 {
 public:
     const LRegion &region() const noexcept
     {
-        if (!m_subtract.empty())
-        {
-            pixman_region32_subtract(&m_region.m_region, &m_region.m_region, &m_subtract.m_region);
-            m_subtract.clear();
-        }
-
+        flush();
         return m_region;
     };
 
@@ -29,7 +25,11 @@ private:
     RRegion(GCompositor *compositorRes, UInt32 id) noexcept;
     ~RRegion() noexcept = default;
     mutable LRegion m_region;
-    mutable LRegion m_subtract;
+
+    // Consecutive add or subtract requests, applied at once with LRegion::addBoxes()
+    mutable std::vector<LBox> m_pending;
+    mutable bool m_pendingSubtract { false };
+    void flush() const noexcept;
 };
 
 #endif // RREGION_H
@@ -6,10 +6,12 @@
 #include <protocols/Wayland/RCallback.h>
 #include <protocols/Wayland/GCompositor.h>
 #include <protocols/Wayland/RSurface.h>
+#include <private/LCompositorPrivate.h>
 #include <private/LSurfacePrivate.h>
 #include <private/LOutputPrivate.h>
 #include <private/LSeatPrivate.h>
 #include <private/LFactory.h>
+#include <LSurfaceView.h>
 #include <LCursorRole.h>
 #include <LDNDIconRole.h>
 #include <LLog.h>
@@ -91,6 +93,7 @@ RSurface::~RSurface()
 {
     LSurface *lSurface { this->surface() };
 
+    lSurface->imp()->finishTextureUpload(false);
     lSurface->imp()->setKeyboardGrabToParent();
 
     // Notify from client
@@ -137,6 +140,12 @@ RSurface::~RSurface()
     compositor()->imp()->surfaces.erase(lSurface->imp()->compositorLink);
     compositor()->imp()->layers[lSurface->imp()->layer].erase(lSurface->imp()->layerLink);
 
+    if (lSurface->imp()->stateFlags.check(LSurface::LSurfacePrivate::PendingConfiguration))
+        LVectorRemoveOne(compositor()->imp()->surfacesPendingConfiguration, lSurface);
+
+    if (lSurface->imp()->stateFlags.check(LSurface::LSurfacePrivate::PendingPresentationFeedback))
+        LVectorRemoveOneUnordered(compositor()->imp()->surfacesPendingPresentationFeedback, lSurface);
+
     compositor()->imp()->surfacesListChanged = true;
     lSurface->imp()->stateFlags.add(LSurface::LSurfacePrivate::Destroyed);
 }
@@ -306,6 +315,7 @@ void RSurface::apply_commit(LSurface *surface, LBaseSurfaceRole::CommitOrigin or
         for (RCallback *callback : imp.frameCallbacks)
             callback->m_commited = true;
 
+        imp.invalidateViewsContent();
         surface->requestedRepaint();
     }
 
@@ -340,9 +350,8 @@ void RSurface::apply_commit(LSurface *surface, LBaseSurfaceRole::CommitOrigin or
         }
         else if (changes.check(Changes::SizeChanged | Changes::InputRegionChanged))
         {
-            pixman_region32_intersect_rect(&imp.currentInputRegion.m_region,
-                                           &imp.pendingInputRegion.m_region,
-                                           0, 0, surface->size().w(), surface->size().h());
+            imp.currentInputRegion = imp.pendingInputRegion;
+            imp.currentInputRegion.clip(0, 0, surface->size().w(), surface->size().h());
             changes.add(Changes::InputRegionChanged);
         }
     }
@@ -391,15 +400,27 @@ void RSurface::apply_commit(LSurface *surface, LBaseSurfaceRole::CommitOrigin or
             imp.pendingOpaqueRegion.addRect(0, 0, surface->size());
         }*/
 
-        pixman_region32_intersect_rect(&imp.currentOpaqueRegion.m_region,
-                                       &imp.pendingOpaqueRegion.m_region,
-                                       0, 0, surface->size().w(), surface->size().h());
+        // Single pixel buffers with max alpha are opaque even if the client doesn't set an opaque region
+        if (surface->solidColor() && surface->solidColor()->a >= 1.f)
+        {
+            imp.currentOpaqueRegion.clear();
+            imp.currentOpaqueRegion.addRect(0, 0, surface->size());
+        }
+        else
+        {
+            imp.currentOpaqueRegion = imp.pendingOpaqueRegion;
+            imp.currentOpaqueRegion.clip(0, 0, surface->size().w(), surface->size().h());
+        }
 
         /*****************************************
          ********** TRANSLUCENT REGION ***********
          *****************************************/
-        pixman_box32_t box {0, 0, surface->size().w(), surface->size().h()};
-        pixman_region32_inverse(&imp.currentTranslucentRegion.m_region, &imp.currentOpaqueRegion.m_region, &box);
+        imp.currentTranslucentRegion = imp.currentOpaqueRegion;
+        imp.currentTranslucentRegion.inverse(LRect(0, 0, surface->size().w(), surface->size().h()));
+
+        // Views cache the regions while they don't change
+        for (LSurfaceView *view : imp.views)
+            view->repaint();
     }
 
     /*******************************************
@@ -435,6 +456,13 @@ void RSurface::apply_commit(LSurface *surface, LBaseSurfaceRole::CommitOrigin or
     if (!ref)
         return;
 
+    // Roles may reposition the surface on commit (window geometry, subsurface and popup positions, etc)
+    if (changes.check(Changes::SizeChanged | Changes::InputRegionChanged) || imp.inputRolePos != surface->rolePos())
+    {
+        imp.inputRolePos = surface->rolePos();
+        imp.invalidateViewsBounds();
+    }
+
     if (changes.check(Changes::BufferSizeChanged))
         surface->bufferSizeChanged();
 
@@ -450,7 +478,8 @@ void RSurface::apply_commit(LSurface *surface, LBaseSurfaceRole::CommitOrigin or
     if (changes.check(Changes::BufferTransformChanged))
         surface->bufferTransformChanged();
 
-    if (changes.check(Changes::DamageRegionChanged))
+    // Notified by finishTextureUpload() if the SHM copy is still in progress
+    if (changes.check(Changes::DamageRegionChanged) && !imp.textureUpload)
         surface->damageChanged();
 
     if (changes.check(Changes::InputRegionChanged))
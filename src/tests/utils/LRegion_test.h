@@ -3,6 +3,9 @@
 
 #include <LTest.h>
 #include <LRegion.h>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
 
 using namespace Louvre;
 
@@ -61,10 +64,259 @@ void LRegion_test_02()
     LAssert("regionA should contain 1 box", n == 1);
 }
 
+// Compares the boxes of an LRegion with a Pixman region
+bool LRegion_equals(const LRegion &region, pixman_region32_t *ref)
+{
+    Int32 n, refN;
+    const LBox *boxes { region.boxes(&n) };
+    const pixman_box32_t *refBoxes { pixman_region32_rectangles(ref, &refN) };
+
+    if (n != refN)
+        return false;
+
+    for (Int32 i = 0; i < n; i++)
+        if (boxes[i].x1 != refBoxes[i].x1 || boxes[i].y1 != refBoxes[i].y1 ||
+            boxes[i].x2 != refBoxes[i].x2 || boxes[i].y2 != refBoxes[i].y2)
+            return false;
+
+    if (n == 0)
+        return region.empty();
+
+    const LBox &ext { region.extents() };
+    const pixman_box32_t *refExt { pixman_region32_extents(ref) };
+    return !region.empty() && ext.x1 == refExt->x1 && ext.y1 == refExt->y1 && ext.x2 == refExt->x2 && ext.y2 == refExt->y2;
+}
+
+LRect LRegion_randomRect()
+{
+    return LRect(rand() % 64, rand() % 64, 1 + rand() % 48, 1 + rand() % 48);
+}
+
+// Pixman reference region
+struct LRegion_Ref
+{
+    LRegion_Ref() { pixman_region32_init(&region); }
+    ~LRegion_Ref() { pixman_region32_fini(&region); }
+    pixman_region32_t region;
+};
+
+// Comparison with Pixman, false once any iteration differs
+struct LRegion_Check
+{
+    const char *desc;
+    bool equal { true };
+};
+
+/* Runs iterations of a randomized comparison between LRegion and Pixman with a fixed seed,
+ * each iteration updates the checks, which are asserted once at the end */
+template<class Func>
+void LRegion_compareWithPixman(const char *testName, UInt32 seed, Int32 iterations, std::vector<LRegion_Check> checks, Func iteration)
+{
+    LSetTestName(testName);
+    srand(seed);
+
+    for (Int32 i = 0; i < iterations; i++)
+        iteration(checks);
+
+    for (const LRegion_Check &check : checks)
+        LAssert(check.desc, check.equal);
+}
+
+void LRegion_test_03()
+{
+    enum { Add, Subtract, Clip, Offset, Inverse };
+
+    // Rect operations, inline and Pixman storage must produce the same boxes
+    LRegion_compareWithPixman("LRegion_test_03", 1, 2000, {
+        { "addRect() should match pixman_region32_union_rect()" },
+        { "subtractRect() should match pixman_region32_subtract()" },
+        { "clip() should match pixman_region32_intersect_rect()" },
+        { "offset() should match pixman_region32_translate()" },
+        { "inverse() should match pixman_region32_inverse()" }
+    }, [](std::vector<LRegion_Check> &checks)
+    {
+        LRegion region;
+        LRegion_Ref ref;
+
+        for (Int32 j = 0, ops = 1 + rand() % 6; j < ops; j++)
+        {
+            const LRect r { LRegion_randomRect() };
+
+            if (rand() % 3 == 0)
+            {
+                region.subtractRect(r);
+                LRegion_Ref tmp;
+                pixman_region32_union_rect(&tmp.region, &tmp.region, r.x(), r.y(), r.w(), r.h());
+                pixman_region32_subtract(&ref.region, &ref.region, &tmp.region);
+                checks[Subtract].equal &= LRegion_equals(region, &ref.region);
+            }
+            else
+            {
+                region.addRect(r);
+                pixman_region32_union_rect(&ref.region, &ref.region, r.x(), r.y(), r.w(), r.h());
+                checks[Add].equal &= LRegion_equals(region, &ref.region);
+            }
+        }
+
+        const LRect clip { LRegion_randomRect() };
+        LRegion clipped { region };
+        clipped.clip(clip);
+        LRegion_Ref refClipped;
+        pixman_region32_intersect_rect(&refClipped.region, &ref.region, clip.x(), clip.y(), clip.w(), clip.h());
+        checks[Clip].equal &= LRegion_equals(clipped, &refClipped.region);
+
+        clipped.offset(-7, 13);
+        pixman_region32_translate(&refClipped.region, -7, 13);
+        checks[Offset].equal &= LRegion_equals(clipped, &refClipped.region);
+
+        const LRect inv { 0, 0, 128, 128 };
+        LRegion inverted { region };
+        inverted.inverse(inv);
+        pixman_box32_t invBox { inv.x(), inv.y(), inv.x() + inv.w(), inv.y() + inv.h() };
+        LRegion_Ref refInverted;
+        pixman_region32_inverse(&refInverted.region, &ref.region, &invBox);
+        checks[Inverse].equal &= LRegion_equals(inverted, &refInverted.region);
+    });
+}
+
+void LRegion_test_04()
+{
+    enum { Union, Intersect, Subtract, Point };
+
+    // Region operations, some operands exceed the inline storage
+    LRegion_compareWithPixman("LRegion_test_04", 2, 2000, {
+        { "addRegion() should match pixman_region32_union()" },
+        { "LRegion::intersect() should match pixman_region32_intersect()" },
+        { "LRegion::subtract() should match pixman_region32_subtract()" },
+        { "containsPoint() should match pixman_region32_contains_point()" }
+    }, [](std::vector<LRegion_Check> &checks)
+    {
+        LRegion a, b;
+
+        for (Int32 j = 0, n = 1 + rand() % 12; j < n; j++)
+            a.addRect(LRegion_randomRect());
+
+        for (Int32 j = 0, n = 1 + rand() % 4; j < n; j++)
+            b.addRect(LRegion_randomRect());
+
+        LRegion_Ref refA, refB, ref;
+        pixman_region32_copy(&refA.region, LRegion(a).pixmanRegion());
+        pixman_region32_copy(&refB.region, LRegion(b).pixmanRegion());
+
+        LRegion result { a };
+        result.addRegion(b);
+        pixman_region32_union(&ref.region, &refA.region, &refB.region);
+        checks[Union].equal &= LRegion_equals(result, &ref.region);
+
+        LRegion::intersect(&result, &a, &b);
+        pixman_region32_intersect(&ref.region, &refA.region, &refB.region);
+        checks[Intersect].equal &= LRegion_equals(result, &ref.region);
+
+        LRegion::subtract(&result, &a, &b);
+        pixman_region32_subtract(&ref.region, &refA.region, &refB.region);
+        checks[Subtract].equal &= LRegion_equals(result, &ref.region);
+
+        const LPoint p { rand() % 128, rand() % 128 };
+        checks[Point].equal &= a.containsPoint(p) == (bool)pixman_region32_contains_point(&refA.region, p.x(), p.y(), NULL);
+    });
+}
+
+void LRegion_test_05()
+{
+    LSetTestName("LRegion_test_05");
+
+    // Copies and moves of regions stored in Pixman
+    LRegion region;
+
+    for (Int32 i = 0; i < LREGION_INLINE_BOXES + 4; i++)
+        region.addRect(i * 20, i * 20, 10, 10);
+
+    Int32 n;
+    region.boxes(&n);
+    LAssert("region should contain LREGION_INLINE_BOXES + 4 boxes", n == LREGION_INLINE_BOXES + 4);
+
+    LRegion copy { region };
+    copy.boxes(&n);
+    LAssert("copy should contain LREGION_INLINE_BOXES + 4 boxes", n == LREGION_INLINE_BOXES + 4);
+
+    LRegion moved { std::move(region) };
+    moved.boxes(&n);
+    LAssert("moved should contain LREGION_INLINE_BOXES + 4 boxes", n == LREGION_INLINE_BOXES + 4);
+
+    region.boxes(&n);
+    LAssert("region should contain 0 boxes", n == 0 && region.empty());
+
+    // Back to inline storage once small enough
+    moved.clip(0, 0, 35, 35);
+    moved.boxes(&n);
+    LAssert("moved should contain 2 boxes", n == 2 && moved.extents().x2 == 30 && moved.extents().y2 == 30);
+}
+
+void LRegion_test_06()
+{
+    enum { Add, Transform, Multiply };
+
+    // Bulk and mapped operations, compared with the same result built one box at a time
+    LRegion_compareWithPixman("LRegion_test_06", 3, 500, {
+        { "addBoxes() should match addRect()" },
+        { "transform() should match transforming each box" },
+        { "multiply() should match scaling each box" }
+    }, [](std::vector<LRegion_Check> &checks)
+    {
+        LRegion region, bulk;
+        LBox boxes[40];
+        const Int32 n { rand() % 40 };
+
+        for (Int32 j = 0; j < 3; j++)
+            region.addRect(LRegion_randomRect());
+
+        bulk = region;
+
+        // Unsorted, overlapping and sometimes empty
+        for (Int32 j = 0; j < n; j++)
+        {
+            const LRect r { LRegion_randomRect() };
+            boxes[j] = { r.x(), r.y(), r.x() + (rand() % 8 == 0 ? 0 : r.w()), r.y() + r.h() };
+            region.addRect(boxes[j].x1, boxes[j].y1, boxes[j].x2 - boxes[j].x1, boxes[j].y2 - boxes[j].y1);
+        }
+
+        bulk.addBoxes(boxes, n);
+        checks[Add].equal &= LRegion_equals(bulk, region.pixmanRegion());
+
+        const LSize size { 100, 80 };
+        LRegion transformed { region };
+        transformed.transform(size, LTransform::Rotated90);
+        LRegion clipped { region };
+        clipped.clip(LRect(0, size));
+        Int32 count;
+        const LBox *b { clipped.boxes(&count) };
+        LRegion ref;
+
+        for (Int32 j = 0; j < count; j++)
+            ref.addRect(b[j].y1, size.w() - b[j].x2, b[j].y2 - b[j].y1, b[j].x2 - b[j].x1);
+
+        checks[Transform].equal &= LRegion_equals(transformed, ref.pixmanRegion());
+
+        LRegion multiplied;
+        LRegion::multiply(&multiplied, &region, 1.5f);
+        b = region.boxes(&count);
+        ref.clear();
+
+        for (Int32 j = 0; j < count; j++)
+            ref.addRect(floorf(b[j].x1 * 1.5f), floorf(b[j].y1 * 1.5f), ceilf((b[j].x2 - b[j].x1) * 1.5f), ceilf((b[j].y2 - b[j].y1) * 1.5f));
+
+        checks[Multiply].equal &= LRegion_equals(multiplied, ref.pixmanRegion());
+    });
+}
+
 void LRegion_run_tests()
 {
     LRegion_test_01();
     LRegion_test_02();
+    LRegion_test_03();
+    LRegion_test_04();
+    LRegion_test_05();
+    LRegion_test_06();
 }
 
 #endif // LREGION_TEST_H